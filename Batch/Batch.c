@@ -0,0 +1,338 @@
+#include "Batch.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "Batch"
+#include "dbg/dbg.h"
+
+/*
+ * Description     : Allocate a new Batch structure.
+ * int machinesCount : Number of headless machines to run
+ * char *romFilename : ROM loaded into each machine
+ * Return        : A pointer to an allocated Batch.
+ */
+Batch *
+Batch_new (
+    int machinesCount,
+    char *romFilename
+) {
+    Batch *this;
+
+    if ((this = calloc (1, sizeof(Batch))) == NULL)
+        return NULL;
+
+    if (!Batch_init (this, machinesCount, romFilename)) {
+        Batch_free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+
+/*
+ * Description : Initialize an allocated Batch structure.
+ * Batch *this : An allocated Batch to initialize.
+ * int machinesCount : Number of headless machines to run
+ * char *romFilename : ROM loaded into each machine
+ * Return : true on success, false on failure.
+ */
+bool
+Batch_init (
+    Batch *this,
+    int machinesCount,
+    char *romFilename
+) {
+    if (machinesCount <= 0 || machinesCount > BATCH_MAX_MACHINES) {
+        dbg ("Error : Invalid machines count %d (max : %d).", machinesCount, BATCH_MAX_MACHINES);
+        return false;
+    }
+
+    if ((this->machines = calloc (machinesCount, sizeof(Cpu *))) == NULL
+    ||  (this->rewards  = calloc (machinesCount, sizeof(int32_t))) == NULL
+    ||  (this->isDone   = calloc (machinesCount, sizeof(bool))) == NULL
+    ||  (this->cycles   = calloc (machinesCount, sizeof(CycleDetector))) == NULL
+    ||  (this->loopingSince = calloc (machinesCount, sizeof(uint32_t))) == NULL) {
+        return false;
+    }
+
+    this->machinesCount = machinesCount;
+    this->frame = 0;
+
+    for (int id = 0; id < machinesCount; id++) {
+        if (!(this->machines[id] = Batch_newMachine (romFilename))) {
+            dbg ("Cannot instantiate the machine %d.", id);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*
+ * Description : Allocate a window-free machine and load a ROM into it
+ * char *romFilename : ROM to load
+ * Return : Cpu * an allocated Cpu with a headless Screen, NULL on failure
+ */
+Cpu *
+Batch_newMachine (
+    char *romFilename
+) {
+    Cpu *cpu;
+
+    if ((cpu = Cpu_new ()) == NULL) {
+        return NULL;
+    }
+
+    if ((cpu->screen = Screen_new (NULL)) == NULL
+    ||  !Cpu_loadRom (cpu, romFilename)) {
+        Cpu_free (cpu);
+        return NULL;
+    }
+
+    return cpu;
+}
+
+
+/*
+ * Description : Set the watch expressions evaluated on each machine after each frame
+ * Batch *this : An allocated Batch
+ * WatchExpr *rewardExpr : Reward of a machine (can be NULL)
+ * WatchExpr *doneExpr : Stops a machine when not zero (can be NULL)
+ * Return : void
+ */
+void
+Batch_setWatches (
+    Batch *this,
+    WatchExpr *rewardExpr,
+    WatchExpr *doneExpr
+) {
+    this->rewardExpr = rewardExpr;
+    this->doneExpr = doneExpr;
+}
+
+
+/*
+ * Description : Enable the cycle detection. A machine found repeating its states with the same keys
+ *               isn't emulated anymore (BATCH_STATUS_LOOPING) until its keys change : it is then
+ *               fast-forwarded to the state it would have reached. Its framebuffer and reward stay
+ *               the ones of the frame where the cycle has been found meanwhile.
+ * Batch *this : An allocated Batch
+ * bool enabled : true to enable the cycle detection
+ * Return : void
+ */
+void
+Batch_setCycleDetection (
+    Batch *this,
+    bool enabled
+) {
+    this->detectCycles = enabled;
+
+    for (int id = 0; id < this->machinesCount; id++) {
+        CycleDetector_reset (&this->cycles[id], Cpu_hashState (this->machines[id]));
+    }
+}
+
+
+/*
+ * Description : Capture the buzzer output of every machine, synthesized from their sound timer
+ * Batch *this : An allocated Batch
+ * unsigned int sampleRate : Samples per second
+ * Return : true on success, false on failure.
+ */
+bool
+Batch_setAudioCapture (
+    Batch *this,
+    unsigned int sampleRate
+) {
+    if (this->captures == NULL
+    && (this->captures = calloc (this->machinesCount, sizeof(AudioCapture *))) == NULL) {
+        return false;
+    }
+
+    for (int id = 0; id < this->machinesCount; id++) {
+        AudioCapture_free (this->captures[id]);
+
+        if ((this->captures[id] = AudioCapture_new (sampleRate)) == NULL) {
+            dbg ("Cannot capture the audio of the machine %d.", id);
+            this->machines[id]->capture = NULL;
+            return false;
+        }
+
+        this->machines[id]->capture = this->captures[id];
+    }
+
+    return true;
+}
+
+
+/*
+ * Description : Take the buzzer output of a machine since the previous call. A machine not
+ *               emulated meanwhile (stopped, done or looping) is silent.
+ * Batch *this : An allocated Batch with the audio capture enabled
+ * int id : Index of the machine
+ * int16_t *samples : (out) The mono samples
+ * int count : Number of samples to write : the latest ones, or silence before them when missing
+ * Return : void
+ */
+void
+Batch_getAudio (
+    Batch *this,
+    int id,
+    int16_t *samples,
+    int count
+) {
+    AudioCapture *capture = this->captures[id];
+    int captured = (capture->samplesCount < (size_t) count) ? (int) capture->samplesCount : count;
+
+    // The frames fast-forwarded when leaving a cycle come first, only the last frame is kept
+    memset (samples, 0, (count - captured) * sizeof(int16_t));
+    memcpy (&samples[count - captured], &capture->samples[capture->samplesCount - captured], captured * sizeof(int16_t));
+
+    AudioCapture_clear (capture);
+}
+
+
+/*
+ * Description : Set the keys pressed on a machine
+ * Batch *this : An allocated Batch
+ * int id : Index of the machine
+ * uint16_t keysMask : Bit N set when the key N is pressed
+ * Return : void
+ */
+void
+Batch_setKeys (
+    Batch *this,
+    int id,
+    uint16_t keysMask
+) {
+    Cpu *cpu = this->machines[id];
+    CycleDetector *cycle = &this->cycles[id];
+
+    if (!this->detectCycles || Cpu_getKeys (cpu) == keysMask) {
+        Cpu_setKeys (cpu, keysMask);
+        return;
+    }
+
+    // The states repeat every "length" frames : only the position in the cycle is missing
+    if (cycle->length != 0) {
+        uint32_t frames = (this->frame - this->loopingSince[id]) % cycle->length;
+        while (frames--) {
+            Cpu_emulateFrame (cpu);
+        }
+        if (this->rewardExpr) {
+            this->rewards[id] = WatchExpr_evaluate (this->rewardExpr, cpu);
+        }
+    }
+
+    Cpu_setKeys (cpu, keysMask);
+    CycleDetector_reset (cycle, Cpu_hashState (cpu));
+}
+
+
+/*
+ * Description : Get the keys pressed on a machine
+ * Batch *this : An allocated Batch
+ * int id : Index of the machine
+ * Return : uint16_t Bit N set when the key N is pressed
+ */
+uint16_t
+Batch_getKeys (
+    Batch *this,
+    int id
+) {
+    return Cpu_getKeys (this->machines[id]);
+}
+
+
+/*
+ * Description : Get the status word of a machine (BATCH_STATUS_* flags)
+ * Batch *this : An allocated Batch
+ * int id : Index of the machine
+ * Return : uint16_t the status word
+ */
+uint16_t
+Batch_getStatus (
+    Batch *this,
+    int id
+) {
+    Cpu *cpu = this->machines[id];
+
+    return ((cpu->isRunning)                ? BATCH_STATUS_RUNNING : 0)
+         | ((cpu->soundTimer > 0)           ? BATCH_STATUS_SOUND   : 0)
+         | ((this->isDone[id])              ? BATCH_STATUS_DONE    : 0)
+         | ((this->cycles[id].length != 0)  ? BATCH_STATUS_LOOPING : 0)
+         | BATCH_STATUS_FAULT (cpu->fault);
+}
+
+
+/*
+ * Description : Emulate one frame on every machine still running, then evaluate the watch expressions
+ * Batch *this : An allocated Batch
+ * Return : void
+ */
+void
+Batch_emulateFrame (
+    Batch *this
+) {
+    for (int id = 0; id < this->machinesCount; id++) {
+        Cpu *cpu = this->machines[id];
+
+        if (!cpu->isRunning || this->isDone[id] || this->cycles[id].length != 0) {
+            continue;
+        }
+
+        Cpu_emulateFrame (cpu);
+
+        if (this->rewardExpr) {
+            this->rewards[id] = WatchExpr_evaluate (this->rewardExpr, cpu);
+        }
+
+        if (this->doneExpr && WatchExpr_evaluate (this->doneExpr, cpu)) {
+            this->isDone[id] = true;
+        }
+
+        if (this->detectCycles
+        &&  CycleDetector_isDue (&this->cycles[id])
+        &&  CycleDetector_update (&this->cycles[id], Cpu_hashState (cpu))) {
+            this->loopingSince[id] = this->frame + 1;
+        }
+    }
+
+    this->frame++;
+}
+
+
+/*
+ * Description : Free an allocated Batch structure.
+ * Batch *this : An allocated Batch to free.
+ */
+void
+Batch_free (
+    Batch *this
+) {
+    if (this != NULL)
+    {
+        if (this->machines) {
+            for (int id = 0; id < this->machinesCount; id++) {
+                Cpu_free (this->machines[id]);
+            }
+            free (this->machines);
+        }
+
+        if (this->captures) {
+            for (int id = 0; id < this->machinesCount; id++) {
+                AudioCapture_free (this->captures[id]);
+            }
+            free (this->captures);
+        }
+
+        free (this->rewards);
+        free (this->isDone);
+        free (this->cycles);
+        free (this->loopingSince);
+
+        free (this);
+    }
+}
@@ -0,0 +1,211 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Chip8/CPU.h"
+#include "Chip8/CycleDetector.h"
+#include "Chip8/AudioCapture.h"
+#include "WatchExpr.h"
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define BATCH_MAX_MACHINES 4096
+
+// Status word flags of a machine
+#define BATCH_STATUS_RUNNING  0x0001
+#define BATCH_STATUS_SOUND    0x0002
+#define BATCH_STATUS_DONE     0x0004
+#define BATCH_STATUS_LOOPING  0x0008
+#define BATCH_STATUS_FAULT(fault) (((fault) & 0xFF) << 8)
+
+
+// ------ Structure declaration -------
+typedef struct _Batch
+{
+    // Window-free machines, all running the same ROM
+    Cpu **machines;
+    int machinesCount;
+
+    // Frames emulated since the start of the batch
+    uint32_t frame;
+
+    // Watch expressions evaluated after each frame (optional)
+    WatchExpr *rewardExpr;
+    WatchExpr *doneExpr;
+
+    // Last reward of each machine, and machines stopped by the done expression
+    int32_t *rewards;
+    bool *isDone;
+
+    // Machines repeating the same states while their keys don't change are frozen
+    // until the keys change (optional) : cycle found and frame of the detection
+    bool detectCycles;
+    CycleDetector *cycles;
+    uint32_t *loopingSince;
+
+    // Buzzer output of each machine since its last Batch_getAudio (optional)
+    AudioCapture **captures;
+
+}    Batch;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Allocate a new Batch structure.
+ * int machinesCount : Number of headless machines to run
+ * char *romFilename : ROM loaded into each machine
+ * Return        : A pointer to an allocated Batch.
+ */
+Batch *
+Batch_new (
+    int machinesCount,
+    char *romFilename
+);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Initialize an allocated Batch structure.
+ * Batch *this : An allocated Batch to initialize.
+ * int machinesCount : Number of headless machines to run
+ * char *romFilename : ROM loaded into each machine
+ * Return : true on success, false on failure.
+ */
+bool
+Batch_init (
+    Batch *this,
+    int machinesCount,
+    char *romFilename
+);
+
+/*
+ * Description : Allocate a window-free machine and load a ROM into it
+ * char *romFilename : ROM to load
+ * Return : Cpu * an allocated Cpu with a headless Screen, NULL on failure
+ */
+Cpu *
+Batch_newMachine (
+    char *romFilename
+);
+
+/*
+ * Description : Set the watch expressions evaluated on each machine after each frame
+ * Batch *this : An allocated Batch
+ * WatchExpr *rewardExpr : Reward of a machine (can be NULL)
+ * WatchExpr *doneExpr : Stops a machine when not zero (can be NULL)
+ * Return : void
+ */
+void
+Batch_setWatches (
+    Batch *this,
+    WatchExpr *rewardExpr,
+    WatchExpr *doneExpr
+);
+
+/*
+ * Description : Enable the cycle detection. A machine found repeating its states with the same keys
+ *               isn't emulated anymore (BATCH_STATUS_LOOPING) until its keys change : it is then
+ *               fast-forwarded to the state it would have reached. Its framebuffer and reward stay
+ *               the ones of the frame where the cycle has been found meanwhile.
+ * Batch *this : An allocated Batch
+ * bool enabled : true to enable the cycle detection
+ * Return : void
+ */
+void
+Batch_setCycleDetection (
+    Batch *this,
+    bool enabled
+);
+
+/*
+ * Description : Capture the buzzer output of every machine, synthesized from their sound timer
+ * Batch *this : An allocated Batch
+ * unsigned int sampleRate : Samples per second
+ * Return : true on success, false on failure.
+ */
+bool
+Batch_setAudioCapture (
+    Batch *this,
+    unsigned int sampleRate
+);
+
+/*
+ * Description : Take the buzzer output of a machine since the previous call. A machine not
+ *               emulated meanwhile (stopped, done or looping) is silent.
+ * Batch *this : An allocated Batch with the audio capture enabled
+ * int id : Index of the machine
+ * int16_t *samples : (out) The mono samples
+ * int count : Number of samples to write : the latest ones, or silence before them when missing
+ * Return : void
+ */
+void
+Batch_getAudio (
+    Batch *this,
+    int id,
+    int16_t *samples,
+    int count
+);
+
+/*
+ * Description : Set the keys pressed on a machine
+ * Batch *this : An allocated Batch
+ * int id : Index of the machine
+ * uint16_t keysMask : Bit N set when the key N is pressed
+ * Return : void
+ */
+void
+Batch_setKeys (
+    Batch *this,
+    int id,
+    uint16_t keysMask
+);
+
+/*
+ * Description : Get the keys pressed on a machine
+ * Batch *this : An allocated Batch
+ * int id : Index of the machine
+ * Return : uint16_t Bit N set when the key N is pressed
+ */
+uint16_t
+Batch_getKeys (
+    Batch *this,
+    int id
+);
+
+/*
+ * Description : Get the status word of a machine (BATCH_STATUS_* flags)
+ * Batch *this : An allocated Batch
+ * int id : Index of the machine
+ * Return : uint16_t the status word
+ */
+uint16_t
+Batch_getStatus (
+    Batch *this,
+    int id
+);
+
+/*
+ * Description : Emulate one frame on every machine still running, then evaluate the watch expressions
+ * Batch *this : An allocated Batch
+ * Return : void
+ */
+void
+Batch_emulateFrame (
+    Batch *this
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated Batch structure.
+ * Batch *this : An allocated Batch to free.
+ */
+void
+Batch_free (
+    Batch *this
+);
+
+
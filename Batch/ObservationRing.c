@@ -0,0 +1,459 @@
+#include "ObservationRing.h"
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "ObservationRing"
+#include "dbg/dbg.h"
+
+// Waits are bounded so a side leaving without notifying is eventually noticed
+#define FUTEX_WAIT_TIMEOUT_NS 100000000
+
+#define align_up(value, alignment) (((value) + (alignment) - 1) & ~((alignment) - 1))
+
+
+/*
+ * Description : Sleep while a shared futex word still holds a given value
+ * uint32_t *word : The futex word
+ * uint32_t value : The value observed by the caller
+ * Return : void
+ */
+static void
+ObservationRing_futexWait (
+    uint32_t *word,
+    uint32_t value
+) {
+    struct timespec timeout = {.tv_sec = 0, .tv_nsec = FUTEX_WAIT_TIMEOUT_NS};
+    syscall (SYS_futex, word, FUTEX_WAIT, value, &timeout, NULL, 0);
+}
+
+
+/*
+ * Description : Wake up every process sleeping on a shared futex word
+ * uint32_t *word : The futex word
+ * Return : void
+ */
+static void
+ObservationRing_futexWake (
+    uint32_t *word
+) {
+    syscall (SYS_futex, word, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+}
+
+
+/*
+ * Description : Map the shared memory object and set the pointers to the shared structures
+ * ObservationRing *this : An allocated ObservationRing
+ * size_t size : Size of the shared memory object
+ * Return : true on success, false on failure.
+ */
+static bool
+ObservationRing_map (
+    ObservationRing *this,
+    size_t size
+) {
+    void *memory = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+
+    if (memory == MAP_FAILED) {
+        dbg ("Error : Cannot map the shared memory \"%s\".", this->name);
+        return false;
+    }
+
+    this->header = memory;
+    this->size = size;
+
+    return true;
+}
+
+
+/*
+ * Description : Check that the layout described by a header fits in the shared memory mapped
+ * ObservationRingHeader *header : The header of the ring
+ * size_t size : Size of the shared memory object
+ * Return : true when every region of the ring is in bounds, false otherwise
+ */
+static bool
+ObservationRing_isValid (
+    ObservationRingHeader *header,
+    size_t size
+) {
+    // 64 bits products : the counts come from another process and may be anything
+    uint64_t frameSlots = (uint64_t) header->slotsCount * header->machinesCount;
+    uint64_t actionsEnd = header->actionsOffset + (uint64_t) header->machinesCount * sizeof(uint16_t);
+    uint64_t slotsEnd   = header->slotsOffset + frameSlots * header->slotSize;
+    uint64_t audioEnd   = header->audioOffset + frameSlots * header->audioSamples * sizeof(int16_t);
+
+    return header->machinesCount > 0
+        && header->slotsCount > 0
+        && header->totalSize <= size
+        && header->actionsOffset >= sizeof(ObservationRingHeader)
+        && header->actionsOffset % OBSERVATION_RING_CACHE_LINE == 0
+        && header->slotsOffset   % OBSERVATION_RING_CACHE_LINE == 0
+        && header->audioOffset   % OBSERVATION_RING_CACHE_LINE == 0
+        && actionsEnd <= header->totalSize
+        && slotsEnd   <= header->totalSize
+        && (header->audioSamples == 0 || audioEnd <= header->totalSize);
+}
+
+
+/*
+ * Description     : Create a new shared memory ring, emulator side.
+ * char *name : Name of the POSIX shared memory object (e.g. "/chip8")
+ * int machinesCount : Number of machines observed in each frame
+ * int slotsCount : Number of frames the ring can hold
+ * uint32_t flags : OBSERVATION_RING_* flags
+ * Return        : A pointer to an allocated ObservationRing.
+ */
+ObservationRing *
+ObservationRing_new (
+    char *name,
+    int machinesCount,
+    int slotsCount,
+    uint32_t flags
+) {
+    ObservationRing *this;
+
+    if ((this = calloc (1, sizeof(ObservationRing))) == NULL)
+        return NULL;
+
+    this->fd = -1;
+
+    if (!ObservationRing_init (this, name, machinesCount, slotsCount, flags)) {
+        ObservationRing_free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+
+/*
+ * Description : Initialize an allocated ObservationRing structure.
+ * ObservationRing *this : An allocated ObservationRing to initialize.
+ * char *name : Name of the POSIX shared memory object
+ * int machinesCount : Number of machines observed in each frame
+ * int slotsCount : Number of frames the ring can hold
+ * uint32_t flags : OBSERVATION_RING_* flags
+ * Return : true on success, false on failure.
+ */
+bool
+ObservationRing_init (
+    ObservationRing *this,
+    char *name,
+    int machinesCount,
+    int slotsCount,
+    uint32_t flags
+) {
+    if (machinesCount <= 0 || slotsCount <= 0) {
+        dbg ("Error : Invalid ring of %d machines and %d slots.", machinesCount, slotsCount);
+        return false;
+    }
+
+    size_t actionsOffset = align_up (sizeof(ObservationRingHeader), OBSERVATION_RING_CACHE_LINE);
+    size_t slotsOffset   = align_up (actionsOffset + machinesCount * sizeof(uint16_t), OBSERVATION_RING_CACHE_LINE);
+    size_t audioSamples  = (flags & OBSERVATION_RING_AUDIO) ? OBSERVATION_RING_AUDIO_SAMPLES : 0;
+    size_t audioOffset   = align_up (slotsOffset + (size_t) slotsCount * machinesCount * sizeof(ObservationSlot), OBSERVATION_RING_CACHE_LINE);
+    size_t totalSize     = audioOffset + (size_t) slotsCount * machinesCount * audioSamples * sizeof(int16_t);
+
+    // The offsets and the size are stored on 32 bits in the header
+    if (totalSize > UINT32_MAX) {
+        dbg ("Error : A ring of %d machines and %d slots doesn't fit in 4 GB.", machinesCount, slotsCount);
+        return false;
+    }
+
+    this->name = strdup (name);
+
+    // Create the shared memory object : a ring of the same name may be used by another emulator
+    if (flags & OBSERVATION_RING_REPLACE) {
+        shm_unlink (name);
+    }
+    if ((this->fd = shm_open (name, O_CREAT | O_EXCL | O_RDWR, 0600)) < 0) {
+        if (errno == EEXIST) {
+            dbg ("Error : The shared memory \"%s\" already exists : another emulator uses it, or it has been left behind.", name);
+        } else {
+            dbg ("Error : Cannot create the shared memory \"%s\".", name);
+        }
+        return false;
+    }
+
+    // Unlinked by this side only once it is created by it
+    this->isOwner = true;
+
+    if (ftruncate (this->fd, totalSize) != 0
+    ||  !ObservationRing_map (this, totalSize)) {
+        return false;
+    }
+
+    // Fill the header, the magic is written last so a trainer never sees a partial header
+    ObservationRingHeader *header = this->header;
+    header->version       = OBSERVATION_RING_VERSION;
+    header->flags         = flags & ~OBSERVATION_RING_REPLACE;
+    header->machinesCount = machinesCount;
+    header->slotsCount    = slotsCount;
+    header->slotSize      = sizeof(ObservationSlot);
+    header->actionsOffset = actionsOffset;
+    header->slotsOffset   = slotsOffset;
+    header->audioRate     = (audioSamples) ? OBSERVATION_RING_AUDIO_RATE : 0;
+    header->audioSamples  = audioSamples;
+    header->audioOffset   = audioOffset;
+    header->totalSize     = totalSize;
+    __atomic_store_n (&header->magic, OBSERVATION_RING_MAGIC, __ATOMIC_RELEASE);
+
+    this->actions = (uint16_t *) ((uint8_t *) header + actionsOffset);
+    this->slots   = (ObservationSlot *) ((uint8_t *) header + slotsOffset);
+    this->audio   = (audioSamples) ? (int16_t *) ((uint8_t *) header + audioOffset) : NULL;
+
+    return true;
+}
+
+
+/*
+ * Description     : Attach to an existing shared memory ring, trainer side.
+ * char *name : Name of the POSIX shared memory object
+ * Return        : A pointer to an allocated ObservationRing.
+ */
+ObservationRing *
+ObservationRing_open (
+    char *name
+) {
+    ObservationRing *this;
+    struct stat info;
+
+    if ((this = calloc (1, sizeof(ObservationRing))) == NULL)
+        return NULL;
+
+    this->name = strdup (name);
+    this->isOwner = false;
+
+    if ((this->fd = shm_open (name, O_RDWR, 0600)) < 0
+    ||  fstat (this->fd, &info) != 0
+    ||  info.st_size < (off_t) sizeof(ObservationRingHeader)
+    ||  !ObservationRing_map (this, info.st_size)) {
+        dbg ("Error : Cannot open the shared memory \"%s\".", name);
+        ObservationRing_free (this);
+        return NULL;
+    }
+
+    ObservationRingHeader *header = this->header;
+    if (__atomic_load_n (&header->magic, __ATOMIC_ACQUIRE) != OBSERVATION_RING_MAGIC
+    ||  header->version != OBSERVATION_RING_VERSION
+    ||  header->slotSize != sizeof(ObservationSlot)) {
+        dbg ("Error : \"%s\" is not a compatible observation ring.", name);
+        ObservationRing_free (this);
+        return NULL;
+    }
+
+    if (!ObservationRing_isValid (header, info.st_size)) {
+        dbg ("Error : \"%s\" is a corrupted or truncated observation ring.", name);
+        ObservationRing_free (this);
+        return NULL;
+    }
+
+    this->actions = (uint16_t *) ((uint8_t *) header + header->actionsOffset);
+    this->slots   = (ObservationSlot *) ((uint8_t *) header + header->slotsOffset);
+    this->audio   = (header->audioSamples) ? (int16_t *) ((uint8_t *) header + header->audioOffset) : NULL;
+
+    return this;
+}
+
+
+/*
+ * Description : (Emulator) Wait for the next actions set pushed by the trainer
+ * ObservationRing *this : An allocated ObservationRing
+ * Return : uint16_t * the keys of each machine, NULL if the ring has been closed
+ */
+uint16_t *
+ObservationRing_waitActions (
+    ObservationRing *this
+) {
+    ObservationRingHeader *header = this->header;
+
+    // Free running emulator : use the latest actions pushed
+    if (!(header->flags & OBSERVATION_RING_LOCKSTEP)) {
+        return (__atomic_load_n (&header->closed, __ATOMIC_ACQUIRE)) ? NULL : this->actions;
+    }
+
+    uint32_t seq;
+    while ((seq = __atomic_load_n (&header->actionsSeq, __ATOMIC_ACQUIRE)) == this->actionsConsumed) {
+        if (__atomic_load_n (&header->closed, __ATOMIC_ACQUIRE)) {
+            return NULL;
+        }
+        ObservationRing_futexWait (&header->actionsSeq, seq);
+    }
+
+    this->actionsConsumed++;
+
+    return this->actions;
+}
+
+
+/*
+ * Description : (Emulator) Wait for a free slot in the ring
+ * ObservationRing *this : An allocated ObservationRing
+ * Return : ObservationSlot * the slots of each machine to fill, NULL if the ring has been closed
+ */
+ObservationSlot *
+ObservationRing_acquireFrame (
+    ObservationRing *this
+) {
+    ObservationRingHeader *header = this->header;
+    uint32_t head = header->head;
+    uint32_t tail;
+
+    // Wait for the trainer to release the oldest frame when the ring is full
+    while (head - (tail = __atomic_load_n (&header->tail, __ATOMIC_ACQUIRE)) >= header->slotsCount) {
+        if (__atomic_load_n (&header->closed, __ATOMIC_ACQUIRE)) {
+            return NULL;
+        }
+        ObservationRing_futexWait (&header->tail, tail);
+    }
+
+    return &this->slots [(head % header->slotsCount) * header->machinesCount];
+}
+
+
+/*
+ * Description : (Emulator) Publish the frame filled after ObservationRing_acquireFrame
+ * ObservationRing *this : An allocated ObservationRing
+ * Return : void
+ */
+void
+ObservationRing_publishFrame (
+    ObservationRing *this
+) {
+    __atomic_add_fetch (&this->header->head, 1, __ATOMIC_RELEASE);
+    ObservationRing_futexWake (&this->header->head);
+}
+
+
+/*
+ * Description : (Trainer) Wait for the oldest frame not released yet
+ * ObservationRing *this : An allocated ObservationRing
+ * Return : ObservationSlot * the slots of each machine, NULL if the ring has been closed
+ */
+ObservationSlot *
+ObservationRing_waitFrame (
+    ObservationRing *this
+) {
+    ObservationRingHeader *header = this->header;
+    uint32_t tail = header->tail;
+    uint32_t head;
+
+    while ((head = __atomic_load_n (&header->head, __ATOMIC_ACQUIRE)) == tail) {
+        if (__atomic_load_n (&header->closed, __ATOMIC_ACQUIRE)) {
+            return NULL;
+        }
+        ObservationRing_futexWait (&header->head, head);
+    }
+
+    return &this->slots [(tail % header->slotsCount) * header->machinesCount];
+}
+
+
+/*
+ * Description : (Trainer) Give back the frame returned by ObservationRing_waitFrame
+ * ObservationRing *this : An allocated ObservationRing
+ * Return : void
+ */
+void
+ObservationRing_releaseFrame (
+    ObservationRing *this
+) {
+    __atomic_add_fetch (&this->header->tail, 1, __ATOMIC_RELEASE);
+    ObservationRing_futexWake (&this->header->tail);
+}
+
+
+/*
+ * Description : (Trainer) Push the keys of each machine for the next frame
+ * ObservationRing *this : An allocated ObservationRing
+ * uint16_t *keys : Keys of each machine (bit N = key N pressed)
+ * Return : void
+ */
+void
+ObservationRing_pushActions (
+    ObservationRing *this,
+    uint16_t *keys
+) {
+    memcpy (this->actions, keys, this->header->machinesCount * sizeof(uint16_t));
+
+    __atomic_add_fetch (&this->header->actionsSeq, 1, __ATOMIC_RELEASE);
+    ObservationRing_futexWake (&this->header->actionsSeq);
+}
+
+
+/*
+ * Description : Get the buzzer output of a machine during a frame, mono 16 bits samples
+ *               at header->audioRate, header->audioSamples per frame
+ * ObservationRing *this : An allocated ObservationRing
+ * ObservationSlot *slots : The slots of a frame, as returned by acquireFrame or waitFrame
+ * int id : Index of the machine
+ * Return : int16_t * the samples of the machine, NULL without OBSERVATION_RING_AUDIO
+ */
+int16_t *
+ObservationRing_getAudio (
+    ObservationRing *this,
+    ObservationSlot *slots,
+    int id
+) {
+    if (this->audio == NULL) {
+        return NULL;
+    }
+
+    // The audio of a frame is at the same index as its slots
+    size_t index = (slots - this->slots) + id;
+
+    return &this->audio [index * this->header->audioSamples];
+}
+
+
+/*
+ * Description : Notify the other side that the ring is closed
+ * ObservationRing *this : An allocated ObservationRing
+ * Return : void
+ */
+void
+ObservationRing_close (
+    ObservationRing *this
+) {
+    ObservationRingHeader *header = this->header;
+
+    __atomic_store_n (&header->closed, 1, __ATOMIC_RELEASE);
+    ObservationRing_futexWake (&header->head);
+    ObservationRing_futexWake (&header->tail);
+    ObservationRing_futexWake (&header->actionsSeq);
+}
+
+
+/*
+ * Description : Free an allocated ObservationRing structure. The owner unlinks the shared memory.
+ * ObservationRing *this : An allocated ObservationRing to free.
+ */
+void
+ObservationRing_free (
+    ObservationRing *this
+) {
+    if (this != NULL)
+    {
+        if (this->header) {
+            munmap (this->header, this->size);
+        }
+
+        if (this->fd >= 0) {
+            close (this->fd);
+        }
+
+        if (this->isOwner && this->name) {
+            shm_unlink (this->name);
+        }
+
+        free (this->name);
+        free (this);
+    }
+}
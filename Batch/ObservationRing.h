@@ -0,0 +1,250 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Chip8/Screen.h"
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define OBSERVATION_RING_MAGIC   0x42523843 // "C8RB"
+#define OBSERVATION_RING_VERSION 3
+#define OBSERVATION_RING_CACHE_LINE 64
+
+// Header flags
+#define OBSERVATION_RING_LOCKSTEP 0x0001 // The emulator waits for a new actions set before each frame
+#define OBSERVATION_RING_AUDIO    0x0002 // The buzzer output of each frame is published too
+
+// Creation flags, not stored in the header
+#define OBSERVATION_RING_REPLACE  0x0100 // Replace a ring left with the same name, instead of failing
+
+// Buzzer output : a multiple of 60 Hz, so every frame has the same number of samples
+#define OBSERVATION_RING_AUDIO_RATE 44100
+#define OBSERVATION_RING_AUDIO_SAMPLES (OBSERVATION_RING_AUDIO_RATE / 60)
+
+/*
+ *    Shared memory layout (POSIX shm, Linux futexes) :
+ *        ObservationRingHeader
+ *        uint16_t actions [machinesCount]                      at header->actionsOffset
+ *        ObservationSlot slots [slotsCount][machinesCount]     at header->slotsOffset
+ *        int16_t audio [slotsCount][machinesCount][audioSamples] at header->audioOffset (OBSERVATION_RING_AUDIO only)
+ *
+ *    The emulator publishes frame N in the slot N % slotsCount and increments "head".
+ *    The trainer reads it in place and increments "tail" once done with it.
+ *    The trainer writes the keys of each machine in "actions" and increments "actionsSeq".
+ *    "head", "tail" and "actionsSeq" are futex words.
+ */
+
+// ------ Structure declaration -------
+typedef struct _ObservationSlot
+{
+    // Frame number
+    uint32_t frame;
+
+    // Keys state which produced this frame (bit N = key N pressed)
+    uint16_t keys;
+
+    // Status word of the machine (BATCH_STATUS_* flags)
+    uint16_t status;
+
+    // Value of the reward watch expression
+    int32_t reward;
+
+    // One PixelValue per pixel
+    uint8_t framebuffer [RESOLUTION_W * RESOLUTION_H];
+
+}   ObservationSlot;
+
+typedef struct _ObservationRingHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t flags;
+    uint32_t machinesCount;
+    uint32_t slotsCount;
+    uint32_t slotSize;
+    uint32_t actionsOffset;
+    uint32_t slotsOffset;
+    uint32_t audioRate;
+    uint32_t audioSamples;
+    uint32_t audioOffset;
+    uint32_t totalSize;
+
+    // Set by any side before leaving
+    uint32_t closed;
+
+    // Futex words, each one on its own cache line
+    uint32_t head       __attribute__ ((aligned (OBSERVATION_RING_CACHE_LINE)));
+    uint32_t tail       __attribute__ ((aligned (OBSERVATION_RING_CACHE_LINE)));
+    uint32_t actionsSeq __attribute__ ((aligned (OBSERVATION_RING_CACHE_LINE)));
+
+}   ObservationRingHeader;
+
+typedef struct _ObservationRing
+{
+    // Mapped shared memory
+    ObservationRingHeader *header;
+    size_t size;
+    uint16_t *actions;
+    ObservationSlot *slots;
+    int16_t *audio;
+
+    // Shared memory object
+    char *name;
+    int fd;
+    bool isOwner;
+
+    // Actions sets already consumed by the emulator
+    uint32_t actionsConsumed;
+
+}   ObservationRing;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Create a new shared memory ring, emulator side.
+ * char *name : Name of the POSIX shared memory object (e.g. "/chip8")
+ * int machinesCount : Number of machines observed in each frame
+ * int slotsCount : Number of frames the ring can hold
+ * uint32_t flags : OBSERVATION_RING_* flags
+ * Return        : A pointer to an allocated ObservationRing.
+ */
+ObservationRing *
+ObservationRing_new (
+    char *name,
+    int machinesCount,
+    int slotsCount,
+    uint32_t flags
+);
+
+/*
+ * Description     : Attach to an existing shared memory ring, trainer side.
+ * char *name : Name of the POSIX shared memory object
+ * Return        : A pointer to an allocated ObservationRing.
+ */
+ObservationRing *
+ObservationRing_open (
+    char *name
+);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Initialize an allocated ObservationRing structure.
+ * ObservationRing *this : An allocated ObservationRing to initialize.
+ * char *name : Name of the POSIX shared memory object
+ * int machinesCount : Number of machines observed in each frame
+ * int slotsCount : Number of frames the ring can hold
+ * uint32_t flags : OBSERVATION_RING_* flags
+ * Return : true on success, false on failure.
+ */
+bool
+ObservationRing_init (
+    ObservationRing *this,
+    char *name,
+    int machinesCount,
+    int slotsCount,
+    uint32_t flags
+);
+
+/*
+ * Description : (Emulator) Wait for the next actions set pushed by the trainer
+ * ObservationRing *this : An allocated ObservationRing
+ * Return : uint16_t * the keys of each machine, NULL if the ring has been closed
+ */
+uint16_t *
+ObservationRing_waitActions (
+    ObservationRing *this
+);
+
+/*
+ * Description : (Emulator) Wait for a free slot in the ring
+ * ObservationRing *this : An allocated ObservationRing
+ * Return : ObservationSlot * the slots of each machine to fill, NULL if the ring has been closed
+ */
+ObservationSlot *
+ObservationRing_acquireFrame (
+    ObservationRing *this
+);
+
+/*
+ * Description : (Emulator) Publish the frame filled after ObservationRing_acquireFrame
+ * ObservationRing *this : An allocated ObservationRing
+ * Return : void
+ */
+void
+ObservationRing_publishFrame (
+    ObservationRing *this
+);
+
+/*
+ * Description : (Trainer) Wait for the oldest frame not released yet
+ * ObservationRing *this : An allocated ObservationRing
+ * Return : ObservationSlot * the slots of each machine, NULL if the ring has been closed
+ */
+ObservationSlot *
+ObservationRing_waitFrame (
+    ObservationRing *this
+);
+
+/*
+ * Description : (Trainer) Give back the frame returned by ObservationRing_waitFrame
+ * ObservationRing *this : An allocated ObservationRing
+ * Return : void
+ */
+void
+ObservationRing_releaseFrame (
+    ObservationRing *this
+);
+
+/*
+ * Description : (Trainer) Push the keys of each machine for the next frame
+ * ObservationRing *this : An allocated ObservationRing
+ * uint16_t *keys : Keys of each machine (bit N = key N pressed)
+ * Return : void
+ */
+void
+ObservationRing_pushActions (
+    ObservationRing *this,
+    uint16_t *keys
+);
+
+/*
+ * Description : Get the buzzer output of a machine during a frame, mono 16 bits samples
+ *               at header->audioRate, header->audioSamples per frame
+ * ObservationRing *this : An allocated ObservationRing
+ * ObservationSlot *slots : The slots of a frame, as returned by acquireFrame or waitFrame
+ * int id : Index of the machine
+ * Return : int16_t * the samples of the machine, NULL without OBSERVATION_RING_AUDIO
+ */
+int16_t *
+ObservationRing_getAudio (
+    ObservationRing *this,
+    ObservationSlot *slots,
+    int id
+);
+
+/*
+ * Description : Notify the other side that the ring is closed
+ * ObservationRing *this : An allocated ObservationRing
+ * Return : void
+ */
+void
+ObservationRing_close (
+    ObservationRing *this
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated ObservationRing structure. The owner unlinks the shared memory.
+ * ObservationRing *this : An allocated ObservationRing to free.
+ */
+void
+ObservationRing_free (
+    ObservationRing *this
+);
+
+
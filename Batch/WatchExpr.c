@@ -0,0 +1,494 @@
+#include "WatchExpr.h"
+#include <stdlib.h>
+#include <ctype.h>
+#include <strings.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "WatchExpr"
+#include "dbg/dbg.h"
+
+// Binary operators, the longest ones first so "||" is never read as "|"
+static struct {
+    char *text;
+    int level;
+    WatchOp op;
+} binaryOperators [] = {
+    {"||", 1, WATCH_OP_OR},     {"&&", 2, WATCH_OP_AND},
+    {"==", 6, WATCH_OP_EQ},     {"!=", 6, WATCH_OP_NE},
+    {"<=", 7, WATCH_OP_LE},     {">=", 7, WATCH_OP_GE},
+    {"<<", 8, WATCH_OP_SHL},    {">>", 8, WATCH_OP_SHR},
+    {"|",  3, WATCH_OP_BITOR},  {"^",  4, WATCH_OP_BITXOR},
+    {"&",  5, WATCH_OP_BITAND}, {"<",  7, WATCH_OP_LT},
+    {">",  7, WATCH_OP_GT},     {"+",  9, WATCH_OP_ADD},
+    {"-",  9, WATCH_OP_SUB},    {"*", 10, WATCH_OP_MUL},
+    {"/", 10, WATCH_OP_DIV},    {"%", 10, WATCH_OP_MOD},
+};
+
+static char *opNames [] = {
+    [WATCH_OP_CONST] = "CONST",   [WATCH_OP_MEM_CONST] = "MEMC", [WATCH_OP_V_CONST] = "VC",
+    [WATCH_OP_MEM] = "MEM",       [WATCH_OP_V] = "V",            [WATCH_OP_I] = "I",
+    [WATCH_OP_IP] = "IP",         [WATCH_OP_SP] = "SP",          [WATCH_OP_DT] = "DT",
+    [WATCH_OP_ST] = "ST",         [WATCH_OP_NEG] = "NEG",        [WATCH_OP_NOT] = "NOT",
+    [WATCH_OP_BITNOT] = "BITNOT", [WATCH_OP_MUL] = "MUL",        [WATCH_OP_DIV] = "DIV",
+    [WATCH_OP_MOD] = "MOD",       [WATCH_OP_ADD] = "ADD",        [WATCH_OP_SUB] = "SUB",
+    [WATCH_OP_SHL] = "SHL",       [WATCH_OP_SHR] = "SHR",        [WATCH_OP_LT] = "LT",
+    [WATCH_OP_LE] = "LE",         [WATCH_OP_GT] = "GT",          [WATCH_OP_GE] = "GE",
+    [WATCH_OP_EQ] = "EQ",         [WATCH_OP_NE] = "NE",          [WATCH_OP_BITAND] = "BITAND",
+    [WATCH_OP_BITXOR] = "BITXOR", [WATCH_OP_BITOR] = "BITOR",    [WATCH_OP_AND] = "AND",
+    [WATCH_OP_OR] = "OR",
+};
+
+
+// ---------- Compiler -------------
+
+static void WatchExpr_parseBinary (WatchExpr *this, int minLevel);
+
+
+/*
+ * Description : Report a syntax error at the cursor position
+ * WatchExpr *this : An allocated WatchExpr
+ * char *message : What was expected
+ * Return : void
+ */
+static void
+WatchExpr_error (
+    WatchExpr *this,
+    char *message
+) {
+    if (!this->hasError) {
+        dbg ("Syntax error in \"%s\" at column %d : %s",
+            this->source, (int) (this->cursor - this->source) + 1, message);
+        this->hasError = true;
+    }
+}
+
+
+/*
+ * Description : Skip the blanks under the cursor
+ * WatchExpr *this : An allocated WatchExpr
+ * Return : void
+ */
+static void
+WatchExpr_skipSpaces (
+    WatchExpr *this
+) {
+    while (isspace ((unsigned char) *this->cursor)) {
+        this->cursor++;
+    }
+}
+
+
+/*
+ * Description : Consume a character if it is under the cursor
+ * WatchExpr *this : An allocated WatchExpr
+ * char c : The expected character
+ * Return : bool, true if it has been consumed
+ */
+static bool
+WatchExpr_accept (
+    WatchExpr *this,
+    char c
+) {
+    WatchExpr_skipSpaces (this);
+
+    if (*this->cursor == c) {
+        this->cursor++;
+        return true;
+    }
+
+    return false;
+}
+
+
+/*
+ * Description : Append an instruction to the bytecode, folding constants on the fly
+ * WatchExpr *this : An allocated WatchExpr
+ * WatchOp op : The operation
+ * int32_t operand : Its operand (only used by constant loads)
+ * Return : void
+ */
+static void
+WatchExpr_emit (
+    WatchExpr *this,
+    WatchOp op,
+    int32_t operand
+) {
+    WatchInsn *last = (this->codeSize > 0) ? &this->code[this->codeSize - 1] : NULL;
+    bool lastIsConst = (last && last->op == WATCH_OP_CONST);
+
+    // Loads with a constant index become direct loads
+    if (lastIsConst && (op == WATCH_OP_MEM || op == WATCH_OP_V)) {
+        last->op = (op == WATCH_OP_MEM) ? WATCH_OP_MEM_CONST : WATCH_OP_V_CONST;
+        last->operand &= (op == WATCH_OP_MEM) ? (MEMORY_SIZE - 1) : (REGISTERS_COUNT - 1);
+        return;
+    }
+
+    // Operations on constants are computed once, at compile time
+    bool isUnary  = (op == WATCH_OP_NEG || op == WATCH_OP_NOT || op == WATCH_OP_BITNOT);
+    bool isBinary = (op >= WATCH_OP_MUL);
+    bool foldable = (isUnary && lastIsConst)
+                 || (isBinary && lastIsConst && this->codeSize >= 2 && last[-1].op == WATCH_OP_CONST);
+
+    if (foldable) {
+        WatchExpr folder = {.codeSize = 0};
+        int operands = (isUnary) ? 1 : 2;
+
+        memcpy (folder.code, last - operands + 1, operands * sizeof(WatchInsn));
+        folder.code[operands] = (WatchInsn) {.op = op};
+        folder.codeSize = operands + 1;
+
+        int32_t value = WatchExpr_evaluate (&folder, NULL);
+        this->codeSize -= operands;
+        this->stackDepth -= operands;
+        op = WATCH_OP_CONST;
+        operand = value;
+        isUnary = isBinary = false;
+    }
+
+    if (this->codeSize >= WATCH_EXPR_MAX_CODE) {
+        WatchExpr_error (this, "expression too long");
+        return;
+    }
+
+    this->code[this->codeSize++] = (WatchInsn) {.op = op, .operand = operand};
+
+    // Track the stack depth needed to evaluate the expression
+    if (isBinary) {
+        this->stackDepth--;
+    }
+    else if (!isUnary && op != WATCH_OP_MEM && op != WATCH_OP_V) {
+        this->stackDepth++;
+    }
+
+    if (this->stackDepth > this->maxStackDepth) {
+        this->maxStackDepth = this->stackDepth;
+    }
+}
+
+
+/*
+ * Description : Parse "[ expression ]" and emit a load from an array
+ * WatchExpr *this : An allocated WatchExpr
+ * WatchOp op : WATCH_OP_MEM or WATCH_OP_V
+ * Return : void
+ */
+static void
+WatchExpr_parseIndex (
+    WatchExpr *this,
+    WatchOp op
+) {
+    if (!WatchExpr_accept (this, '[')) {
+        WatchExpr_error (this, "'[' expected");
+        return;
+    }
+
+    WatchExpr_parseBinary (this, 1);
+
+    if (!WatchExpr_accept (this, ']')) {
+        WatchExpr_error (this, "']' expected");
+        return;
+    }
+
+    WatchExpr_emit (this, op, 0);
+}
+
+
+/*
+ * Description : Parse a number, a guest variable or a parenthesized expression
+ * WatchExpr *this : An allocated WatchExpr
+ * Return : void
+ */
+static void
+WatchExpr_parsePrimary (
+    WatchExpr *this
+) {
+    WatchExpr_skipSpaces (this);
+    char *start = this->cursor;
+
+    if (WatchExpr_accept (this, '(')) {
+        WatchExpr_parseBinary (this, 1);
+        if (!WatchExpr_accept (this, ')')) {
+            WatchExpr_error (this, "')' expected");
+        }
+        return;
+    }
+
+    if (isdigit ((unsigned char) *start)) {
+        // Decimal, or hexadecimal with the 0x prefix (no octal)
+        bool isHex = (start[0] == '0' && (start[1] == 'x' || start[1] == 'X'));
+        WatchExpr_emit (this, WATCH_OP_CONST, strtol (start, &this->cursor, (isHex) ? 16 : 10));
+        return;
+    }
+
+    // Identifiers
+    int length = 0;
+    while (isalnum ((unsigned char) start[length]) || start[length] == '_') {
+        length++;
+    }
+    this->cursor += length;
+
+    struct {
+        char *name;
+        WatchOp op;
+    } variables [] = {
+        {"I", WATCH_OP_I}, {"ip", WATCH_OP_IP}, {"sp", WATCH_OP_SP},
+        {"DT", WATCH_OP_DT}, {"ST", WATCH_OP_ST},
+    };
+
+    for (int i = 0; i < sizeof_array (variables); i++) {
+        if (length == strlen (variables[i].name) && strncasecmp (start, variables[i].name, length) == 0) {
+            WatchExpr_emit (this, variables[i].op, 0);
+            return;
+        }
+    }
+
+    if (length == 3 && strncasecmp (start, "mem", 3) == 0) {
+        WatchExpr_parseIndex (this, WATCH_OP_MEM);
+        return;
+    }
+
+    if (length >= 1 && toupper ((unsigned char) start[0]) == 'V') {
+        // V[x] or V0..VF
+        if (length == 1) {
+            WatchExpr_parseIndex (this, WATCH_OP_V);
+            return;
+        }
+        if (length == 2 && isxdigit ((unsigned char) start[1])) {
+            WatchExpr_emit (this, WATCH_OP_V_CONST, strtol (&start[1], NULL, 16));
+            return;
+        }
+    }
+
+    this->cursor = start;
+    WatchExpr_error (this, "number, variable or '(' expected");
+}
+
+
+/*
+ * Description : Parse an unary operation
+ * WatchExpr *this : An allocated WatchExpr
+ * Return : void
+ */
+static void
+WatchExpr_parseUnary (
+    WatchExpr *this
+) {
+    if (WatchExpr_accept (this, '-')) {
+        WatchExpr_parseUnary (this);
+        WatchExpr_emit (this, WATCH_OP_NEG, 0);
+    }
+    else if (WatchExpr_accept (this, '!')) {
+        WatchExpr_parseUnary (this);
+        WatchExpr_emit (this, WATCH_OP_NOT, 0);
+    }
+    else if (WatchExpr_accept (this, '~')) {
+        WatchExpr_parseUnary (this);
+        WatchExpr_emit (this, WATCH_OP_BITNOT, 0);
+    }
+    else {
+        WatchExpr_parsePrimary (this);
+    }
+}
+
+
+/*
+ * Description : Parse binary operations by precedence climbing
+ * WatchExpr *this : An allocated WatchExpr
+ * int minLevel : Lowest precedence level accepted
+ * Return : void
+ */
+static void
+WatchExpr_parseBinary (
+    WatchExpr *this,
+    int minLevel
+) {
+    WatchExpr_parseUnary (this);
+
+    while (!this->hasError)
+    {
+        WatchExpr_skipSpaces (this);
+
+        int found = -1;
+        for (int i = 0; i < sizeof_array (binaryOperators) && found < 0; i++) {
+            if (strncmp (this->cursor, binaryOperators[i].text, strlen (binaryOperators[i].text)) == 0) {
+                found = i;
+            }
+        }
+
+        if (found < 0 || binaryOperators[found].level < minLevel) {
+            break;
+        }
+
+        this->cursor += strlen (binaryOperators[found].text);
+        WatchExpr_parseBinary (this, binaryOperators[found].level + 1);
+        WatchExpr_emit (this, binaryOperators[found].op, 0);
+    }
+}
+
+
+// ---------- WatchExpr -------------
+
+/*
+ * Description     : Parse and compile a new watch expression.
+ * char *source : The text of the expression
+ * Return        : A pointer to an allocated WatchExpr, NULL on a syntax error.
+ */
+WatchExpr *
+WatchExpr_new (
+    char *source
+) {
+    WatchExpr *this;
+
+    if ((this = calloc (1, sizeof(WatchExpr))) == NULL)
+        return NULL;
+
+    if (!WatchExpr_init (this, source)) {
+        WatchExpr_free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+
+/*
+ * Description : Initialize an allocated WatchExpr structure.
+ * WatchExpr *this : An allocated WatchExpr to initialize.
+ * char *source : The text of the expression
+ * Return : true on success, false on a syntax error.
+ */
+bool
+WatchExpr_init (
+    WatchExpr *this,
+    char *source
+) {
+    this->source = strdup (source);
+    this->cursor = this->source;
+    this->codeSize = 0;
+    this->stackDepth = 0;
+    this->maxStackDepth = 0;
+    this->hasError = false;
+
+    WatchExpr_parseBinary (this, 1);
+
+    WatchExpr_skipSpaces (this);
+    if (*this->cursor != '\0') {
+        WatchExpr_error (this, "end of expression expected");
+    }
+
+    if (this->maxStackDepth > WATCH_EXPR_MAX_STACK) {
+        WatchExpr_error (this, "expression too deep");
+    }
+
+    return !this->hasError;
+}
+
+
+/*
+ * Description : Evaluate the expression over the current state of a Cpu
+ * WatchExpr *this : An allocated WatchExpr
+ * Cpu *cpu : The machine observed
+ * Return : int32_t the value of the expression
+ */
+int32_t
+WatchExpr_evaluate (
+    WatchExpr *this,
+    Cpu *cpu
+) {
+    // Unsigned arithmetic so overflows wrap instead of being undefined
+    uint32_t stack [WATCH_EXPR_MAX_STACK];
+    uint32_t *top = stack - 1;
+
+    #define BINARY(expression) top--; top[0] = (expression)
+    #define A top[0]
+    #define B top[1]
+
+    for (WatchInsn *insn = this->code, *end = this->code + this->codeSize; insn < end; insn++)
+    {
+        switch (insn->op)
+        {
+            case WATCH_OP_CONST:     *++top = insn->operand; break;
+            case WATCH_OP_MEM_CONST: *++top = cpu->memory[insn->operand]; break;
+            case WATCH_OP_V_CONST:   *++top = cpu->V[insn->operand]; break;
+            case WATCH_OP_MEM:       top[0] = cpu->memory[top[0] & (MEMORY_SIZE - 1)]; break;
+            case WATCH_OP_V:         top[0] = cpu->V[top[0] & (REGISTERS_COUNT - 1)]; break;
+            case WATCH_OP_I:         *++top = cpu->I; break;
+            case WATCH_OP_IP:        *++top = cpu->ip; break;
+            case WATCH_OP_SP:        *++top = cpu->sp; break;
+            case WATCH_OP_DT:        *++top = cpu->delayTimer; break;
+            case WATCH_OP_ST:        *++top = cpu->soundTimer; break;
+            case WATCH_OP_NEG:       top[0] = -top[0]; break;
+            case WATCH_OP_NOT:       top[0] = !top[0]; break;
+            case WATCH_OP_BITNOT:    top[0] = ~top[0]; break;
+            case WATCH_OP_MUL:       BINARY (A * B); break;
+            // Computed on 64 bits : INT32_MIN / -1 overflows (SIGFPE) on 32 bits, and wraps here
+            case WATCH_OP_DIV:       BINARY ((B != 0) ? (uint32_t) ((int64_t) (int32_t) A / (int32_t) B) : 0); break;
+            case WATCH_OP_MOD:       BINARY ((B != 0) ? (uint32_t) ((int64_t) (int32_t) A % (int32_t) B) : 0); break;
+            case WATCH_OP_ADD:       BINARY (A + B); break;
+            case WATCH_OP_SUB:       BINARY (A - B); break;
+            case WATCH_OP_SHL:       BINARY (A << (B & 31)); break;
+            case WATCH_OP_SHR:       BINARY ((uint32_t) ((int32_t) A >> (B & 31))); break;
+            case WATCH_OP_LT:        BINARY ((int32_t) A <  (int32_t) B); break;
+            case WATCH_OP_LE:        BINARY ((int32_t) A <= (int32_t) B); break;
+            case WATCH_OP_GT:        BINARY ((int32_t) A >  (int32_t) B); break;
+            case WATCH_OP_GE:        BINARY ((int32_t) A >= (int32_t) B); break;
+            case WATCH_OP_EQ:        BINARY (A == B); break;
+            case WATCH_OP_NE:        BINARY (A != B); break;
+            case WATCH_OP_BITAND:    BINARY (A & B); break;
+            case WATCH_OP_BITXOR:    BINARY (A ^ B); break;
+            case WATCH_OP_BITOR:     BINARY (A | B); break;
+            case WATCH_OP_AND:       BINARY (A && B); break;
+            case WATCH_OP_OR:        BINARY (A || B); break;
+        }
+    }
+
+    #undef BINARY
+    #undef A
+    #undef B
+
+    return (int32_t) top[0];
+}
+
+
+/*
+ * Description : Print the compiled bytecode in the console
+ * WatchExpr *this : An allocated WatchExpr
+ * Return : void
+ */
+void
+WatchExpr_debug (
+    WatchExpr *this
+) {
+    printf ("%s (stack depth = %d)\n", this->source, this->maxStackDepth);
+
+    for (int i = 0; i < this->codeSize; i++) {
+        WatchInsn *insn = &this->code[i];
+        switch (insn->op) {
+            case WATCH_OP_CONST:
+            case WATCH_OP_MEM_CONST:
+            case WATCH_OP_V_CONST:
+                printf ("  %-6s 0x%X\n", opNames[insn->op], insn->operand);
+            break;
+
+            default:
+                printf ("  %s\n", opNames[insn->op]);
+            break;
+        }
+    }
+}
+
+
+/*
+ * Description : Free an allocated WatchExpr structure.
+ * WatchExpr *this : An allocated WatchExpr to free.
+ */
+void
+WatchExpr_free (
+    WatchExpr *this
+) {
+    if (this != NULL)
+    {
+        free (this->source);
+        free (this);
+    }
+}
@@ -0,0 +1,142 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Chip8/CPU.h"
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define WATCH_EXPR_MAX_CODE  256
+#define WATCH_EXPR_MAX_STACK 32
+
+/*
+ *    Watch expressions are evaluated over the guest state after each frame :
+ *        mem[addr]  V[x]  V0..VF  I  ip  sp  DT  ST  decimal and 0x hexadecimal numbers
+ *        unary  : - ! ~
+ *        binary : * / %  + -  << >>  < <= > >=  == !=  &  ^  |  &&  ||
+ *    They are parsed once and compiled into a bytecode for a small stack machine.
+ */
+
+// ------ Structure declaration -------
+typedef enum {
+    WATCH_OP_CONST,
+    WATCH_OP_MEM_CONST,   // mem[constant address]
+    WATCH_OP_V_CONST,     // V[constant register]
+    WATCH_OP_MEM,
+    WATCH_OP_V,
+    WATCH_OP_I,
+    WATCH_OP_IP,
+    WATCH_OP_SP,
+    WATCH_OP_DT,
+    WATCH_OP_ST,
+    WATCH_OP_NEG,
+    WATCH_OP_NOT,
+    WATCH_OP_BITNOT,
+    WATCH_OP_MUL,
+    WATCH_OP_DIV,
+    WATCH_OP_MOD,
+    WATCH_OP_ADD,
+    WATCH_OP_SUB,
+    WATCH_OP_SHL,
+    WATCH_OP_SHR,
+    WATCH_OP_LT,
+    WATCH_OP_LE,
+    WATCH_OP_GT,
+    WATCH_OP_GE,
+    WATCH_OP_EQ,
+    WATCH_OP_NE,
+    WATCH_OP_BITAND,
+    WATCH_OP_BITXOR,
+    WATCH_OP_BITOR,
+    WATCH_OP_AND,
+    WATCH_OP_OR,
+
+}   WatchOp;
+
+typedef struct _WatchInsn
+{
+    uint8_t op;
+    int32_t operand;
+
+}   WatchInsn;
+
+typedef struct _WatchExpr
+{
+    // Compiled bytecode
+    WatchInsn code [WATCH_EXPR_MAX_CODE];
+    int codeSize;
+
+    // Source text, used for error messages
+    char *source;
+
+    // Parser state
+    char *cursor;
+    int stackDepth;
+    int maxStackDepth;
+    bool hasError;
+
+}   WatchExpr;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Parse and compile a new watch expression.
+ * char *source : The text of the expression
+ * Return        : A pointer to an allocated WatchExpr, NULL on a syntax error.
+ */
+WatchExpr *
+WatchExpr_new (
+    char *source
+);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Initialize an allocated WatchExpr structure.
+ * WatchExpr *this : An allocated WatchExpr to initialize.
+ * char *source : The text of the expression
+ * Return : true on success, false on a syntax error.
+ */
+bool
+WatchExpr_init (
+    WatchExpr *this,
+    char *source
+);
+
+/*
+ * Description : Evaluate the expression over the current state of a Cpu
+ * WatchExpr *this : An allocated WatchExpr
+ * Cpu *cpu : The machine observed
+ * Return : int32_t the value of the expression
+ */
+int32_t
+WatchExpr_evaluate (
+    WatchExpr *this,
+    Cpu *cpu
+);
+
+/*
+ * Description : Print the compiled bytecode in the console
+ * WatchExpr *this : An allocated WatchExpr
+ * Return : void
+ */
+void
+WatchExpr_debug (
+    WatchExpr *this
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated WatchExpr structure.
+ * WatchExpr *this : An allocated WatchExpr to free.
+ */
+void
+WatchExpr_free (
+    WatchExpr *this
+);
+
+
@@ -0,0 +1,210 @@
+#include "Audio.h"
+#include "Profiler/ProfilerClock.h"
+#include "Profiler/ProfilerFactory.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "Audio"
+#include "dbg/dbg.h"
+
+/*
+ * Audio thread : synthesize the next buffer, applying the tone changes due in it
+ */
+static sfBool
+Audio_getData (
+    sfSoundStreamChunk *chunk,
+    void *userData
+) {
+    Audio *this = userData;
+    uint64_t now = ProfilerClock_microseconds ();
+    uint32_t tail = this->tail;
+    uint32_t head = __atomic_load_n (&this->head, __ATOMIC_ACQUIRE);
+    int filled = 0;
+
+    while (filled < this->samplesCount)
+    {
+        int count = this->samplesCount - filled;
+
+        if (tail != head)
+        {
+            AudioEvent *event = &this->events[tail & (AUDIO_QUEUE_SIZE - 1)];
+
+            // The first change of a tone sequence starts in this buffer
+            if (!this->isAligned) {
+                this->originTime = event->time;
+                this->originSample = this->samplesPlayed + filled;
+                this->isAligned = true;
+            }
+
+            uint64_t eventSample = this->originSample
+                + (event->time - this->originTime) * AUDIO_SAMPLE_RATE / 1000000;
+            uint64_t currentSample = this->samplesPlayed + filled;
+
+            if (eventSample <= currentSample) {
+                this->isOn = event->isOn;
+                ProfilerHistogram_record (this->latencies, now - event->time);
+                tail++;
+
+                // Silent and nothing pending : the next tone starts as soon as possible
+                if (!this->isOn && tail == head) {
+                    this->isAligned = false;
+                }
+                continue;
+            }
+
+            if (eventSample - currentSample < (uint64_t) count) {
+                count = eventSample - currentSample;
+            }
+        }
+
+        Buzzer_render (&this->buzzer, this->isOn, &this->samples[filled], count);
+        filled += count;
+    }
+
+    // Release the events applied
+    __atomic_store_n (&this->tail, tail, __ATOMIC_RELEASE);
+    this->samplesPlayed += this->samplesCount;
+
+    chunk->samples = this->samples;
+    chunk->sampleCount = this->samplesCount;
+
+    return sfTrue;
+}
+
+
+/*
+ * A synthesized stream can't be seeked
+ */
+static void
+Audio_seek (
+    sfTime offset,
+    void *userData
+) {
+}
+
+
+/*
+ * Description     : Allocate a new Audio structure, and start its stream.
+ * int samplesCount : Samples per buffer, between AUDIO_MIN_BUFFER and AUDIO_MAX_BUFFER
+ * Return        : A pointer to an allocated Audio, NULL when no sound can be played.
+ */
+Audio *
+Audio_new (
+    int samplesCount
+) {
+    Audio *this;
+
+    if ((this = calloc (1, sizeof(Audio))) == NULL)
+        return NULL;
+
+    if (!Audio_init (this, samplesCount)) {
+        Audio_free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+
+/*
+ * Description : Initialize an allocated Audio structure.
+ * Audio *this : An allocated Audio to initialize.
+ * int samplesCount : Samples per buffer, between AUDIO_MIN_BUFFER and AUDIO_MAX_BUFFER
+ * Return : true on success, false on failure.
+ */
+bool
+Audio_init (
+    Audio *this,
+    int samplesCount
+) {
+    if (samplesCount < AUDIO_MIN_BUFFER || samplesCount > AUDIO_MAX_BUFFER) {
+        dbg ("Error : The audio buffers hold between %d and %d samples.", AUDIO_MIN_BUFFER, AUDIO_MAX_BUFFER);
+        return false;
+    }
+
+    this->samplesCount = samplesCount;
+    if ((this->samples = calloc (samplesCount, sizeof(int16_t))) == NULL) {
+        return false;
+    }
+
+    Buzzer_init (&this->buzzer, AUDIO_SAMPLE_RATE);
+
+    if (!(this->latencies = ProfilerFactory_getHistogram ("Tone to audio"))) {
+        return false;
+    }
+
+    // Mono stream, synthesized in the audio thread of SFML
+    if ((this->stream = sfSoundStream_create (Audio_getData, Audio_seek, 1, AUDIO_SAMPLE_RATE, this)) == NULL) {
+        dbg ("Error : Cannot open an audio stream.");
+        return false;
+    }
+    sfSoundStream_play (this->stream);
+
+    return true;
+}
+
+
+/*
+ * Description : CPU thread : set the tone of the buzzer
+ * Audio *this : An allocated Audio
+ * bool isOn : true while the sound timer is above zero
+ * Return : void
+ */
+void
+Audio_setTone (
+    Audio *this,
+    bool isOn
+) {
+    if (isOn == this->isSounding) {
+        return;
+    }
+
+    uint32_t head = this->head;
+
+    if (head - __atomic_load_n (&this->tail, __ATOMIC_ACQUIRE) == AUDIO_QUEUE_SIZE) {
+        dbg ("Warning : The audio queue is full, the stream doesn't consume it.");
+        return;
+    }
+
+    this->events[head & (AUDIO_QUEUE_SIZE - 1)] = (AudioEvent) {
+        .time = ProfilerClock_microseconds (),
+        .isOn = isOn
+    };
+    __atomic_store_n (&this->head, head + 1, __ATOMIC_RELEASE);
+
+    this->isSounding = isOn;
+}
+
+
+/*
+ * Description : Get the time between the synthesis of a buffer and the sound card playing it
+ * Audio *this : An allocated Audio
+ * Return : double the latency of the buffers queued, in milliseconds
+ */
+double
+Audio_getBufferLatency (
+    Audio *this
+) {
+    return (double) this->samplesCount * AUDIO_STREAM_BUFFERS * 1000.0 / AUDIO_SAMPLE_RATE;
+}
+
+
+/*
+ * Description : Stop and free an allocated Audio structure.
+ * Audio *this : An allocated Audio to free.
+ */
+void
+Audio_free (
+    Audio *this
+) {
+    if (this != NULL)
+    {
+        // Stop the audio thread before its buffer is freed
+        if (this->stream) {
+            sfSoundStream_stop (this->stream);
+            sfSoundStream_destroy (this->stream);
+        }
+        free (this->samples);
+        free (this);
+    }
+}
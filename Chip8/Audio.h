@@ -0,0 +1,123 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include "Buzzer.h"
+#include "Profiler/ProfilerHistogram.h"
+#include <SFML/Audio.h>
+#include <SFML/Audio/SoundStream.h>
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define AUDIO_SAMPLE_RATE        44100
+#define AUDIO_DEFAULT_BUFFER     512  // Samples per buffer : 11.6 ms
+#define AUDIO_MIN_BUFFER         (AUDIO_SAMPLE_RATE / 100) // 10 ms : shorter buffers underrun between two callbacks
+#define AUDIO_MAX_BUFFER         8192
+#define AUDIO_STREAM_BUFFERS     3    // Buffers queued by sfSoundStream before they are played
+#define AUDIO_QUEUE_SIZE         64   // Tone changes pending, a power of 2
+
+// ------ Structure declaration -------
+
+// The buzzer starting or stopping
+typedef struct _AudioEvent
+{
+    uint64_t time; // Microseconds of the monotonic clock, when the CPU changed the tone
+    bool isOn;
+
+}   AudioEvent;
+
+/*
+ *    Output of the buzzer to the sound card through a sfSoundStream of small buffers.
+ *    The CPU thread sends the tone changes through a single producer, single consumer ring,
+ *    and the audio thread of SFML synthesizes each buffer when it is requested : the changes
+ *    are placed in the buffer at their distance from the first change of the tone, so the
+ *    tones keep their duration, while each tone starts in the next buffer synthesized.
+ */
+typedef struct _Audio
+{
+    sfSoundStream *stream;
+
+    // Tone changes : head written by the CPU thread, tail by the audio thread
+    AudioEvent events [AUDIO_QUEUE_SIZE];
+    uint32_t head;
+    uint32_t tail;
+
+    // CPU thread : tone sent last
+    bool isSounding;
+
+    // Audio thread : samples synthesized, and the sample of the first tone change (when aligned)
+    Buzzer buzzer;
+    bool isOn;
+    int16_t *samples;
+    int samplesCount;
+    uint64_t samplesPlayed;
+    bool isAligned;
+    uint64_t originTime;
+    uint64_t originSample;
+
+    // Delay between a tone change and its synthesis
+    ProfilerHistogram *latencies;
+
+}   Audio;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Allocate a new Audio structure, and start its stream.
+ * int samplesCount : Samples per buffer, between AUDIO_MIN_BUFFER and AUDIO_MAX_BUFFER
+ * Return        : A pointer to an allocated Audio, NULL when no sound can be played.
+ */
+Audio *
+Audio_new (
+    int samplesCount
+);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Initialize an allocated Audio structure.
+ * Audio *this : An allocated Audio to initialize.
+ * int samplesCount : Samples per buffer, between AUDIO_MIN_BUFFER and AUDIO_MAX_BUFFER
+ * Return : true on success, false on failure.
+ */
+bool
+Audio_init (
+    Audio *this,
+    int samplesCount
+);
+
+/*
+ * Description : CPU thread : set the tone of the buzzer
+ * Audio *this : An allocated Audio
+ * bool isOn : true while the sound timer is above zero
+ * Return : void
+ */
+void
+Audio_setTone (
+    Audio *this,
+    bool isOn
+);
+
+/*
+ * Description : Get the time between the synthesis of a buffer and the sound card playing it
+ * Audio *this : An allocated Audio
+ * Return : double the latency of the buffers queued, in milliseconds
+ */
+double
+Audio_getBufferLatency (
+    Audio *this
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Stop and free an allocated Audio structure.
+ * Audio *this : An allocated Audio to free.
+ */
+void
+Audio_free (
+    Audio *this
+);
@@ -0,0 +1,182 @@
+#include "AudioCapture.h"
+#include "LittleEndian.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "AudioCapture"
+#include "dbg/dbg.h"
+
+/*
+ * Description     : Allocate a new AudioCapture structure.
+ * unsigned int sampleRate : Samples per second
+ * Return        : A pointer to an allocated AudioCapture.
+ */
+AudioCapture *
+AudioCapture_new (
+    unsigned int sampleRate
+) {
+    AudioCapture *this;
+
+    if ((this = calloc (1, sizeof(AudioCapture))) == NULL)
+        return NULL;
+
+    if (!AudioCapture_init (this, sampleRate)) {
+        AudioCapture_free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+
+/*
+ * Description : Initialize an allocated AudioCapture structure.
+ * AudioCapture *this : An allocated AudioCapture to initialize.
+ * unsigned int sampleRate : Samples per second
+ * Return : true on success, false on failure.
+ */
+bool
+AudioCapture_init (
+    AudioCapture *this,
+    unsigned int sampleRate
+) {
+    if (sampleRate == 0) {
+        dbg ("Error : Invalid sample rate.");
+        return false;
+    }
+
+    Buzzer_init (&this->buzzer, sampleRate);
+    this->sampleRate = sampleRate;
+    this->slicesCount = 0;
+    this->samplesCount = 0;
+    this->samplesCapacity = AUDIO_CAPTURE_MIN_CAPACITY;
+
+    if ((this->samples = malloc (this->samplesCapacity * sizeof(int16_t))) == NULL) {
+        dbg ("Error : Cannot allocate the samples.");
+        return false;
+    }
+
+    return true;
+}
+
+
+/*
+ * Description : Synthesize the samples of the next 60 Hz tick
+ * AudioCapture *this : An allocated AudioCapture
+ * bool isOn : true when the sound timer is above zero during the tick
+ * Return : bool, false when the samples cannot be stored
+ */
+bool
+AudioCapture_addSlice (
+    AudioCapture *this,
+    bool isOn
+) {
+    // Bounds of the slice in samples since the start : the remainders aren't lost between slices
+    uint64_t start = this->slicesCount * this->sampleRate / AUDIO_CAPTURE_SLICES_PER_SECOND;
+    uint64_t end = (this->slicesCount + 1) * this->sampleRate / AUDIO_CAPTURE_SLICES_PER_SECOND;
+    size_t count = end - start;
+
+    if (this->samplesCount + count > this->samplesCapacity) {
+        size_t capacity = this->samplesCapacity * 2;
+        int16_t *samples;
+
+        while (this->samplesCount + count > capacity) {
+            capacity *= 2;
+        }
+
+        if ((samples = realloc (this->samples, capacity * sizeof(int16_t))) == NULL) {
+            dbg ("Error : Cannot store more than %zu samples.", this->samplesCount);
+            return false;
+        }
+
+        this->samples = samples;
+        this->samplesCapacity = capacity;
+    }
+
+    Buzzer_render (&this->buzzer, isOn, &this->samples[this->samplesCount], count);
+    this->samplesCount += count;
+    this->slicesCount++;
+
+    return true;
+}
+
+
+/*
+ * Description : Drop the samples captured, the next slices keep their position
+ * AudioCapture *this : An allocated AudioCapture
+ * Return : void
+ */
+void
+AudioCapture_clear (
+    AudioCapture *this
+) {
+    this->samplesCount = 0;
+}
+
+
+/*
+ * Description : Write the samples captured as a 16 bits mono PCM WAV file
+ * AudioCapture *this : An allocated AudioCapture
+ * char *filename : The WAV file written
+ * Return : bool, false when the file cannot be written
+ */
+bool
+AudioCapture_saveWav (
+    AudioCapture *this,
+    char *filename
+) {
+    FILE *file;
+    uint32_t dataSize = this->samplesCount * sizeof(int16_t);
+
+    if ((file = fopen (filename, "wb")) == NULL) {
+        dbg ("Error : Cannot write \"%s\".", filename);
+        return false;
+    }
+
+    // RIFF header
+    fwrite ("RIFF", 1, 4, file);
+    LittleEndian_write (file, 36 + dataSize, 4);
+    fwrite ("WAVE", 1, 4, file);
+
+    // Format chunk : PCM, mono, 16 bits
+    fwrite ("fmt ", 1, 4, file);
+    LittleEndian_write (file, 16, 4);
+    LittleEndian_write (file, 1, 2);
+    LittleEndian_write (file, 1, 2);
+    LittleEndian_write (file, this->sampleRate, 4);
+    LittleEndian_write (file, this->sampleRate * sizeof(int16_t), 4);
+    LittleEndian_write (file, sizeof(int16_t), 2);
+    LittleEndian_write (file, 16, 2);
+
+    // Data chunk
+    fwrite ("data", 1, 4, file);
+    LittleEndian_write (file, dataSize, 4);
+    for (size_t sample = 0; sample < this->samplesCount; sample++) {
+        LittleEndian_write (file, (uint16_t) this->samples[sample], 2);
+    }
+
+    bool isWritten = !ferror (file);
+
+    if (fclose (file) != 0 || !isWritten) {
+        dbg ("Error : Cannot write \"%s\".", filename);
+        return false;
+    }
+
+    return true;
+}
+
+
+/*
+ * Description : Free an allocated AudioCapture structure.
+ * AudioCapture *this : An allocated AudioCapture to free.
+ */
+void
+AudioCapture_free (
+    AudioCapture *this
+) {
+    if (this != NULL)
+    {
+        free (this->samples);
+        free (this);
+    }
+}
@@ -0,0 +1,108 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include "Buzzer.h"
+#include <stdint.h>
+#include <stdio.h>
+
+// ---------- Defines -------------
+#define AUDIO_CAPTURE_SLICES_PER_SECOND 60 // Ticks of the sound timer
+#define AUDIO_CAPTURE_MIN_CAPACITY 4096
+
+// ------ Structure declaration -------
+
+/*
+ *    Buzzer output synthesized from the sound timer alone, without any audio device.
+ *    Each 60 Hz tick of the timers adds the samples of its slice : the slice N covers the samples
+ *    N * sampleRate / 60 up to (N + 1) * sampleRate / 60, so the slices keep the exact sample rate
+ *    even when it isn't a multiple of 60, and the same timers always give the same samples.
+ */
+typedef struct _AudioCapture
+{
+    Buzzer buzzer;
+    unsigned int sampleRate;
+
+    // Ticks captured since the start, giving the position of the next slice
+    uint64_t slicesCount;
+
+    // Mono samples captured and not cleared yet
+    int16_t *samples;
+    size_t samplesCount;
+    size_t samplesCapacity;
+
+}   AudioCapture;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Allocate a new AudioCapture structure.
+ * unsigned int sampleRate : Samples per second
+ * Return        : A pointer to an allocated AudioCapture.
+ */
+AudioCapture *
+AudioCapture_new (
+    unsigned int sampleRate
+);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Initialize an allocated AudioCapture structure.
+ * AudioCapture *this : An allocated AudioCapture to initialize.
+ * unsigned int sampleRate : Samples per second
+ * Return : true on success, false on failure.
+ */
+bool
+AudioCapture_init (
+    AudioCapture *this,
+    unsigned int sampleRate
+);
+
+/*
+ * Description : Synthesize the samples of the next 60 Hz tick
+ * AudioCapture *this : An allocated AudioCapture
+ * bool isOn : true when the sound timer is above zero during the tick
+ * Return : bool, false when the samples cannot be stored
+ */
+bool
+AudioCapture_addSlice (
+    AudioCapture *this,
+    bool isOn
+);
+
+/*
+ * Description : Drop the samples captured, the next slices keep their position
+ * AudioCapture *this : An allocated AudioCapture
+ * Return : void
+ */
+void
+AudioCapture_clear (
+    AudioCapture *this
+);
+
+/*
+ * Description : Write the samples captured as a 16 bits mono PCM WAV file
+ * AudioCapture *this : An allocated AudioCapture
+ * char *filename : The WAV file written
+ * Return : bool, false when the file cannot be written
+ */
+bool
+AudioCapture_saveWav (
+    AudioCapture *this,
+    char *filename
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated AudioCapture structure.
+ * AudioCapture *this : An allocated AudioCapture to free.
+ */
+void
+AudioCapture_free (
+    AudioCapture *this
+);
@@ -0,0 +1,52 @@
+#include "Buzzer.h"
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "Buzzer"
+#include "dbg/dbg.h"
+
+/*
+ * Description : Initialize a Buzzer structure.
+ * Buzzer *this : A Buzzer to initialize.
+ * unsigned int sampleRate : Samples per second
+ * Return : void
+ */
+void
+Buzzer_init (
+    Buzzer *this,
+    unsigned int sampleRate
+) {
+    this->sampleRate = sampleRate;
+    this->phase = 0;
+}
+
+
+/*
+ * Description : Synthesize the next samples
+ * Buzzer *this : An initialized Buzzer
+ * bool isOn : true when the buzzer sounds, silence otherwise
+ * int16_t *samples : (out) The mono samples
+ * int count : Number of samples to write
+ * Return : void
+ */
+void
+Buzzer_render (
+    Buzzer *this,
+    bool isOn,
+    int16_t *samples,
+    int count
+) {
+    if (!isOn) {
+        // The next tone starts at the beginning of a period
+        memset (samples, 0, count * sizeof(int16_t));
+        this->phase = 0;
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        samples[i] = (this->phase < this->sampleRate / 2) ? BUZZER_AMPLITUDE : -BUZZER_AMPLITUDE;
+
+        if ((this->phase += BUZZER_FREQUENCY) >= this->sampleRate) {
+            this->phase -= this->sampleRate;
+        }
+    }
+}
@@ -0,0 +1,58 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define BUZZER_FREQUENCY 440  // Hz
+#define BUZZER_AMPLITUDE 6000 // Of the 16 bits samples
+
+// ------ Structure declaration -------
+
+/*
+ *    Square wave of the CHIP-8 buzzer, sounding while the sound timer is above zero.
+ *    The phase is counted in samples, so the frequency is exact for any sample rate, and
+ *    each tone starts at the same phase : the samples only depend on the timer state.
+ */
+typedef struct _Buzzer
+{
+    unsigned int sampleRate;
+
+    // Position in the period of the wave, in BUZZER_FREQUENCY / sampleRate units
+    unsigned int phase;
+
+}   Buzzer;
+
+
+
+// ----------- Functions ------------
+
+/*
+ * Description : Initialize a Buzzer structure.
+ * Buzzer *this : A Buzzer to initialize.
+ * unsigned int sampleRate : Samples per second
+ * Return : void
+ */
+void
+Buzzer_init (
+    Buzzer *this,
+    unsigned int sampleRate
+);
+
+/*
+ * Description : Synthesize the next samples
+ * Buzzer *this : An initialized Buzzer
+ * bool isOn : true when the buzzer sounds, silence otherwise
+ * int16_t *samples : (out) The mono samples
+ * int count : Number of samples to write
+ * Return : void
+ */
+void
+Buzzer_render (
+    Buzzer *this,
+    bool isOn,
+    int16_t *samples,
+    int count
+);
@@ -1,4 +1,6 @@
 #include "Cpu.h"
+#include "FastCpu.h"
+#include "Disassembler.h"
 #include <stdlib.h>
 
 // ---------- Debugging -------------
@@ -34,11 +36,12 @@ bool
 Cpu_init (
     Cpu *this
 ) {
-    srand (time(NULL));
-
     // Reset entirely the CPU state
     memset (this, 0, sizeof(Cpu));
 
+    // Runs are not reproducible unless the caller seeds the CPU again
+    Cpu_seed (this, time (NULL));
+
     // Load built-in font set into emulator memory
     uint8_t chip8_fontset [80] = {
         0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
@@ -59,15 +62,13 @@ Cpu_init (
         0xF0, 0x80, 0xF0, 0x80, 0x80  // F
     };
     memcpy (&this->memory[FONT_START_ADDRESS], chip8_fontset, sizeof(chip8_fontset));
+    Cpu_rehashMemory (this);
 
     // Instruction pointer start at the start of the program
     this->ip = USER_SPACE_START_ADDRESS;
 
-    // Get a profiler
-    if (!(this->profiler = ProfilerFactory_getProfiler ("CPU"))) {
-        dbg ("Cannot allocate a new Profiler.");
-        return false;
-    }
+    // No key pressed
+    memset (this->keys, KEY_RELEASED, sizeof(this->keys));
 
     // Default speed
     this->speed = DEFAULT_CPU_SPEED;
@@ -109,6 +110,7 @@ Cpu_loadRom (
 
     // ROM successfully loaded, copy it into the emulator memory
     memcpy (&this->memory[USER_SPACE_START_ADDRESS], romFile, romSize);
+    Cpu_rehashMemory (this);
 
     // Clean memory
     free (romFile);
@@ -126,8 +128,61 @@ inline void
 Cpu_emulateCycle (
     Cpu *this
 ) {
+    if (this->ip > MEMORY_SIZE - INSN_SIZE) {
+        Cpu_raiseFault (this, CPU_FAULT_MEMORY_ACCESS);
+        return;
+    }
+
+    if (this->coverageMap) {
+        uint16_t location = CPU_COVERAGE_LOCATION (this->ip);
+        this->coverageMap[location ^ this->coveragePrevious]++;
+        this->coveragePrevious = location >> 1;
+    }
+
+    if (this->guestProfiler) {
+        GuestProfiler_record (this->guestProfiler, this->ip);
+    }
+
     this->opcode = Cpu_fetchOpcode (this, this->ip);
+
+    if (this->trace) {
+        CpuTrace_record (this->trace, this->ip, this->opcode, this->I,
+            this->V[(this->opcode & 0x0F00) >> 8], this->V[(this->opcode & 0x00F0) >> 4]);
+    }
+
+    #ifdef CPU_OPCODE_STATS
+    uint64_t startClock = OpcodeStats_readClock ();
+    #endif
+
     Cpu_executeOpcode (this);
+
+    #ifdef CPU_OPCODE_STATS
+    OpcodeStats_record (this->opcode, startClock);
+    #endif
+}
+
+
+/*
+ * Description : Emulate a frame : "speed" CPU cycles followed by a timers update.
+ *               It is the unit of time used by headless machines.
+ * Cpu *this : An allocated Cpu
+ * Return : void
+ */
+void
+Cpu_emulateFrame (
+    Cpu *this
+) {
+    // The coverage and the guest profile are only recorded by the reference engine
+    if (this->engine == CPU_ENGINE_FAST && !this->coverageMap && !this->guestProfiler) {
+        FastCpu_emulateFrame (this);
+        return;
+    }
+
+    for (int cycle = 0; cycle < this->speed && this->isRunning; cycle++) {
+        Cpu_emulateCycle (this);
+    }
+
+    Cpu_updateTimers (this);
 }
 
 
@@ -170,9 +225,6 @@ Cpu_executeOpcode (
     uint16_t opcode = this->opcode;
     uint8_t *V      = this->V;
 
-    // Cpu_disass (this);
-    // Cpu_debug (this);
-
     // Set IP to the next opcode
     this->ip += INSN_SIZE;
 
@@ -187,6 +239,9 @@ Cpu_executeOpcode (
                         case 0x00E0:
                         /*   0x00E0     Clears the screen. */
                             Screen_clear (this->screen);
+                            if (this->latency) {
+                                InputLatency_publish (this->latency);
+                            }
                         break;
 
                         case 0x00EE:
@@ -201,8 +256,7 @@ Cpu_executeOpcode (
 
                 default :
                 //   0x0NNN     Calls RCA 1802 program at address NNN.
-                    dbg ("Unhandled 0x0NNN : Calls RCA 1802 program.");
-                    exit (0);
+                    Cpu_raiseFault (this, CPU_FAULT_RCA_CALL);
                 break;
             }
         break;
@@ -329,7 +383,7 @@ Cpu_executeOpcode (
 
         case 0xC000:
         /*  CXNN     Sets VX to a random number and NN. */
-            VX = (rand() >> 7) & __NN;
+            VX = (Cpu_random (this) >> 7) & __NN;
         break;
 
         case 0xD000:
@@ -338,8 +392,15 @@ Cpu_executeOpcode (
                         If when drawn, clears a pixel, register VF is set to 1 otherwise it is zero.
                         All drawing is XOR drawing (e.g. it toggles the screen pixels)
         */
+            if (!Cpu_checkMemoryAccess (this, this->I, (___N) ? ___N : 16)) {
+                break;
+            }
+
             // Set VF to 1 if a pixel changed from 1 to 0
             VF = Screen_drawSprite (this->screen, VX, VY, ___N, this->memory, this->I);
+            if (this->latency) {
+                InputLatency_publish (this->latency);
+            }
         break;
 
         case 0xE000:
@@ -347,16 +408,22 @@ Cpu_executeOpcode (
             {
                 case 0x009E:
                 /*   0xEX9E     Skips the next instruction if the key stored in VX is pressed. */
-                    if (Window_getKeyState (VX) == KEY_PRESSED) {
+                    if (this->keys[VX & 0xF] == KEY_PRESSED) {
                     	this->ip += 2;
+                        if (this->latency) {
+                            InputLatency_observe (this->latency, VX & 0xF);
+                        }
                     }
                 break;
 
                 case 0x00A1:
                 /*   0xEXA1     Skips the next instruction if the key stored in VX isn't pressed. */
-                    if (Window_getKeyState (VX) == KEY_RELEASED) {
+                    if (this->keys[VX & 0xF] == KEY_RELEASED) {
                     	this->ip += 2;
                     }
+                    else if (this->latency) {
+                        InputLatency_observe (this->latency, VX & 0xF);
+                    }
                 break;
 
                 default :
@@ -377,14 +444,17 @@ Cpu_executeOpcode (
                 /*   0xFX0A     A key press is awaited, and then stored in VX. */
                     bool keyPressed = false;
                     for (C8KeyCode code = 0; !keyPressed && code < keyCodeCount; code++) {
-                        if (Window_getKeyState (code) == KEY_PRESSED) {
+                        if (this->keys[code] == KEY_PRESSED) {
                             VX = code;
                             keyPressed = true;
                             // The CPU loop is way faster than the I/O handler one.
                             // Thus, the CPU has the right to notify than the key
                             // has been handled as pressed and shouldn't be
                             // handled twice.
-                            Window_setKeyState (code, KEY_PUSHED);
+                            this->keys[code] = KEY_PUSHED;
+                            if (this->latency) {
+                                InputLatency_observe (this->latency, code);
+                            }
                         }
                     }
 
@@ -421,21 +491,30 @@ Cpu_executeOpcode (
                                 the middle digit at I plus 1, and the least significant digit at I plus 2.
                                 (In other words, take the decimal representation of VX, place the hundreds digit in memory at location in I,
                                 the tens digit at location I+1, and the ones digit at location I+2.) */
-                    this->memory[this->I]     =  VX / 100;
-                    this->memory[this->I + 1] = (VX / 10)  % 10;
-                    this->memory[this->I + 2] = VX % 10;
+                    if (!Cpu_checkMemoryAccess (this, this->I, 3)) {
+                        break;
+                    }
+                    Cpu_writeMemory (this, this->I,      VX / 100);
+                    Cpu_writeMemory (this, this->I + 1, (VX / 10)  % 10);
+                    Cpu_writeMemory (this, this->I + 2,  VX % 10);
                 break;
 
                 case 0x0055:
                 /*   0xFX55     Stores V0 to VX in memory starting at address I. */
+                    if (!Cpu_checkMemoryAccess (this, this->I, _X__ + 1)) {
+                        break;
+                    }
                     for (int pos = 0; pos <= _X__; pos++) {
-                        this->memory [this->I + pos] = V[pos];
+                        Cpu_writeMemory (this, this->I + pos, V[pos]);
                     }
                 break;
 
                 case 0x0065:
 
                 /*   0xFX65     Fills V0 to VX with values from memory starting at address I. */
+                    if (!Cpu_checkMemoryAccess (this, this->I, _X__ + 1)) {
+                        break;
+                    }
                     for (int pos = 0; pos <= _X__; pos++) {
                         V[pos] = this->memory [this->I + pos];
                     }
@@ -472,93 +551,13 @@ Cpu_disass (
 	Cpu *this
 ) {
     uint16_t opcode = this->opcode;
+    char text [DISASSEMBLER_TEXT_SIZE];
 
-    char v1[3] = "Vx";
-    char v2[3] = "Vx";
-    sprintf(v1, "V%X", ((opcode & 0x0F00) >> 8));
-    sprintf(v2, "V%X", ((opcode & 0x00F0) >> 4));
+    Disassembler_format (opcode, text);
 
-    printf ("IP = %04X| %04X - ", this->ip, opcode);
-
-    switch (opcode>>12)
-    {
-		case 0:
-		switch (opcode&0xfff)
-		{
-			case 0xe0:	printf ("CLS          ; Clear screen");												break;
-			case 0xee:	printf ("RET          ; Return from subroutine call");								break;
-			case 0xfb:	printf("SCR           ; Scroll right");												break;
-			case 0xfc:	printf("SCL           ; Scroll left");												break;
-			case 0xfd:	printf("EXIT          ; Terminate the interpreter");								break;
-			case 0xfe:	printf("LOW           ; Disable extended screen mode");								break;
-			case 0xff:	printf("HIGH          ; Enable extended screen mode");								break;
-			default:	printf ("SYS  %03X     ; Unknown system call",opcode&0xff);							break;
-		}
-		break;
-
-		case 1:	printf ("JP   %03X     ; Jump to address",opcode&0xfff);									break;
-		case 2:	printf ("CALL %03X     ; Call subroutine",opcode&0xfff);									break;
-		case 3:	printf ("SE   %s,%02X   ; Skip if register == constant",v1,opcode&0xff);					break;
-		case 4:	printf ("SNE  %s,%02X   ; Skip if register <> constant",v1,opcode&0xff);					break;
-		case 5:	printf ("SE   %s,%s   ; Skip if register == register",v1,v2);								break;
-		case 6:	printf ("LD   %s,%02X   ; Set VX = Byte",v1,opcode&0xff);									break;
-		case 7:	printf ("ADD  %s,%02X   ; Set VX = VX + Byte",v1,opcode&0xff);								break;
-
-		case 8:
-		switch (opcode & 0x0f)
-		{
-			case 0:	printf ("LD   %s,%s   ; Set VX = VY, VF updates",v1,v2);								break;
-			case 1:	printf ("OR   %s,%s   ; Set VX = VX | VY, VF updates",v1,v2);							break;
-			case 2:	printf ("AND  %s,%s   ; Set VX = VX & VY, VF updates",v1,v2);							break;
-			case 3:	printf ("XOR  %s,%s   ; Set VX = VX ^ VY, VF updates",v1,v2);							break;
-			case 4:	printf ("ADD  %s,%s   ; Set VX = VX + VY, VF = carry",v1,v2);							break;
-			case 5:	printf ("SUB  %s,%s   ; Set VX = VX - VY, VF = !borrow",v1,v2);							break;
-			case 6:	printf ("SHR  %s,%s   ; Set VX = VX >> 1, VF = carry",v1,v2);							break;
-			case 7:	printf ("SUBN %s,%s   ; Set VX = VY - VX, VF = !borrow",v1,v2);							break;
-			case 14:	printf ("SHL  %s,%s   ; Set VX = VX << 1, VF = carry",v1,v2);						break;
-			default:	printf ("Illegal opcode");															break;
-		}
-		break;
-
-		case 9:	printf ("SNE  %s,%s   ; Skip next instruction iv VX!=VY",v1,v2);							break;
-		case 10:	printf ("LD   I,%03X   ; Set I = Addr",opcode&0xfff);									break;
-		case 11:	printf ("JP   V0,%03X  ; Jump to Addr + V0",opcode&0xfff);								break;
-		case 12:	printf ("RND  %s,%02X   ; Set VX = random & Byte",v1,opcode&0xff);						break;
-		case 13:	printf ("DRW  %s,%s,%X ; Draw n byte sprite stored at [i] at VX,VY.",v1,v2,opcode & 0x0f); break;
-
-		case 14:
-		switch (opcode & 0xff)
-		{
-			case 0x9e:	printf ("SKP  %s      ; Skip next instruction if key VX down",v1);					break;
-			case 0xa1:	printf ("SKNP %s      ; Skip next instruction if key VX up",v1);					break;
-			default:	printf ("%04X        ; Illegal opcode", opcode);									break;
-		}
-		break;
-
-		case 15:
-		switch (opcode & 0xff)
-		{
-			case 0x07:	printf ("LD   %s,DT   ; Set VX = delaytimer",v1);									break;
-			case 0x0a:	printf ("LD   %s,K    ; Set VX = key, wait for keypress",v1);						break;
-			case 0x15:	printf ("LD   DT,%s   ; Set delaytimer = VX",v1);									break;
-			case 0x18:	printf ("LD   ST,%s   ; Set soundtimer = VX",v1);									break;
-			case 0x1e:	printf ("ADD  I,%s    ; Set I = I + VX",v1);										break;
-			case 0x29:	printf ("LD  LF,%s    ; Point I to 5 byte numeric sprite for value in VX",v1);		break;
-			case 0x30:	printf ("LD  HF,%s    ; Point I to 10 byte numeric sprite for value in VX",v1);		break;
-			case 0x33:	printf ("LD   B,%s    ; Store BCD of VX in [I], [I+1], [I+2]",v1);					break;
-			case 0x55:	printf ("LD   [I],%s  ; Store V0..VX in [I]..[I+X]",v1);							break;
-			case 0x65:	printf ("LD   %s,[I]  ; Read V0..VX from [I]..[I+X]",v1);							break;
-			case 0x75:	printf ("LD   R,%s    ; Store V0..VX in RPL user flags (X<=7)",v1);					break;
-			case 0x85:	printf ("LD   %s,R    ; Read V0..VX from RPL user flags (X<=7)",v1);				break;
-			default:	printf ("%04X        ; Illegal opcode", opcode);									break;
-		}
-		break;
-    }
-
-    printf(" (%s = %x |", v1, this->V[((opcode & 0x0F00) >> 8)]);
-    printf("  %s = %x)",  v2, this->V[((opcode & 0x00F0) >> 4)]);
-
-    printf("\n");
+    printf ("IP = %04X| %04X - %s (V%X = %x |  V%X = %x)\n", this->ip, opcode, text,
+        (opcode & 0x0F00) >> 8, this->V[(opcode & 0x0F00) >> 8],
+        (opcode & 0x00F0) >> 4, this->V[(opcode & 0x00F0) >> 4]);
 }
 
 
@@ -574,11 +573,15 @@ Cpu_stackPush (
     uint16_t value
 ) {
     if (this->sp >= STACK_SIZE) {
-        dbg ("Error : Stack overflow");
-        exit (0);
+        Cpu_raiseFault (this, CPU_FAULT_STACK_OVERFLOW);
+        return;
     }
 
     this->stack[this->sp++] = value;
+
+    if (this->guestProfiler) {
+        GuestProfiler_call (this->guestProfiler);
+    }
 }
 
 /*
@@ -591,8 +594,12 @@ Cpu_stackPop (
     Cpu *this
 ) {
     if (this->sp <= 0) {
-        dbg ("Error : nothing on the stack.");
-        exit (0);
+        Cpu_raiseFault (this, CPU_FAULT_STACK_UNDERFLOW);
+        return this->ip;
+    }
+
+    if (this->guestProfiler) {
+        GuestProfiler_return (this->guestProfiler);
     }
 
     return this->stack[--this->sp];
@@ -608,8 +615,399 @@ void
 Cpu_unknownOpcode (
     Cpu *this
 ) {
-    dbg ("Error : Unsupported instruction %04X", this->opcode);
-    exit (0);
+    Cpu_raiseFault (this, CPU_FAULT_UNKNOWN_OPCODE);
+}
+
+
+/*
+ * Description : Check that a memory access stays inside the memory, raise a fault otherwise
+ * Cpu *this : An allocated Cpu
+ * uint16_t address : Start of the access
+ * int size : Number of bytes accessed
+ * Return : bool, true if the access is valid
+ */
+inline bool
+Cpu_checkMemoryAccess (
+    Cpu *this,
+    uint16_t address,
+    int size
+) {
+    if (address + size > MEMORY_SIZE) {
+        Cpu_raiseFault (this, CPU_FAULT_MEMORY_ACCESS);
+        return false;
+    }
+
+    return true;
+}
+
+
+/*
+ * Description : Stop the CPU because of a fault
+ * Cpu *this : An allocated Cpu
+ * CpuFault fault : The fault raised
+ * Return : void
+ */
+void
+Cpu_raiseFault (
+    Cpu *this,
+    CpuFault fault
+) {
+    dbg ("Error : %s (IP = %04X, opcode = %04X)", Cpu_getFaultName (fault), this->ip, this->opcode);
+
+    this->fault = fault;
+    this->isRunning = false;
+}
+
+
+/*
+ * Description : Get a printable name of a fault
+ * CpuFault fault : A fault raised by the CPU
+ * Return : char * the name of the fault
+ */
+char *
+Cpu_getFaultName (
+    CpuFault fault
+) {
+    char *names [] = {
+        [CPU_FAULT_NONE]            = "No fault",
+        [CPU_FAULT_STACK_OVERFLOW]  = "Stack overflow",
+        [CPU_FAULT_STACK_UNDERFLOW] = "Nothing on the stack",
+        [CPU_FAULT_UNKNOWN_OPCODE]  = "Unsupported instruction",
+        [CPU_FAULT_RCA_CALL]        = "Unhandled 0x0NNN : Calls RCA 1802 program",
+        [CPU_FAULT_MEMORY_ACCESS]   = "Out of memory",
+    };
+
+    return (fault < cpuFaultCount) ? names[fault] : "Unknown fault";
+}
+
+
+/*
+ * Description : Select the interpreter used by Cpu_emulateFrame
+ * Cpu *this : An allocated Cpu
+ * CpuEngine engine : The interpreter
+ * Return : bool, true on success, false otherwise
+ */
+bool
+Cpu_setEngine (
+    Cpu *this,
+    CpuEngine engine
+) {
+    if (engine == CPU_ENGINE_FAST && !this->decoded) {
+        if ((this->decoded = calloc (MEMORY_SIZE, sizeof(CpuDecodedInsn))) == NULL) {
+            return false;
+        }
+    }
+
+    this->engine = engine;
+
+    return true;
+}
+
+
+/*
+ * Description : Get a printable name of an engine
+ * CpuEngine engine : An interpreter
+ * Return : char * the name of the engine
+ */
+char *
+Cpu_getEngineName (
+    CpuEngine engine
+) {
+    char *names [] = {
+        [CPU_ENGINE_REFERENCE] = "reference",
+        [CPU_ENGINE_FAST]      = "fast",
+    };
+
+    return (engine < cpuEngineCount) ? names[engine] : "unknown";
+}
+
+
+/*
+ * Description : Seed the random generator used by CXNN, so runs can be reproduced
+ * Cpu *this : An allocated Cpu
+ * uint32_t seed : The seed
+ * Return : void
+ */
+void
+Cpu_seed (
+    Cpu *this,
+    uint32_t seed
+) {
+    // xorshift32 never leaves the zero state
+    this->rngState = (seed != 0) ? seed : 0x9E3779B9;
+}
+
+
+/*
+ * Description : Get the next number of the random generator used by CXNN
+ * Cpu *this : An allocated Cpu
+ * Return : uint32_t a pseudo random number
+ */
+inline uint32_t
+Cpu_random (
+    Cpu *this
+) {
+    uint32_t x = this->rngState;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    return (this->rngState = x);
+}
+
+
+/*
+ * Description : Set the keys pressed from a mask. A key held down keeps its state.
+ * Cpu *this : An allocated Cpu
+ * uint16_t keysMask : Bit N set when the key N is pressed
+ * Return : void
+ */
+void
+Cpu_setKeys (
+    Cpu *this,
+    uint16_t keysMask
+) {
+    for (C8KeyCode code = 0; code < keyCodeCount; code++) {
+        if (!(keysMask & (1 << code))) {
+            this->keys[code] = KEY_RELEASED;
+        }
+        else if (this->keys[code] == KEY_RELEASED) {
+            // A key held down stays KEY_PUSHED once the CPU consumed it
+            this->keys[code] = KEY_PRESSED;
+        }
+    }
+}
+
+
+/*
+ * Description : Get the keys pressed as a mask
+ * Cpu *this : An allocated Cpu
+ * Return : uint16_t Bit N set when the key N is pressed
+ */
+uint16_t
+Cpu_getKeys (
+    Cpu *this
+) {
+    uint16_t keysMask = 0;
+
+    for (C8KeyCode code = 0; code < keyCodeCount; code++) {
+        if (this->keys[code] != KEY_RELEASED) {
+            keysMask |= 1 << code;
+        }
+    }
+
+    return keysMask;
+}
+
+
+/*
+ * Description : Copy the whole machine state (CPU, memory, keys and framebuffer)
+ * Cpu *this : An allocated Cpu
+ * CpuState *state : (out) The state saved
+ * Return : void
+ */
+void
+Cpu_saveState (
+    Cpu *this,
+    CpuState *state
+) {
+    state->opcode     = this->opcode;
+    state->I          = this->I;
+    state->ip         = this->ip;
+    state->sp         = this->sp;
+    state->delayTimer = this->delayTimer;
+    state->soundTimer = this->soundTimer;
+    state->fault      = this->fault;
+    state->isRunning  = this->isRunning;
+    state->rngState   = this->rngState;
+    state->memoryHash      = this->memoryHash;
+    state->framebufferHash = this->screen->framebufferHash;
+    memcpy (state->V,           this->V,                   sizeof(state->V));
+    memcpy (state->stack,       this->stack,               sizeof(state->stack));
+    memcpy (state->keys,        this->keys,                sizeof(state->keys));
+    memcpy (state->memory,      this->memory,              sizeof(state->memory));
+    memcpy (state->framebuffer, this->screen->framebuffer, sizeof(state->framebuffer));
+}
+
+
+/*
+ * Description : Restore a whole machine state saved by Cpu_saveState
+ * Cpu *this : An allocated Cpu
+ * CpuState *state : The state to restore
+ * Return : void
+ */
+void
+Cpu_loadState (
+    Cpu *this,
+    CpuState *state
+) {
+    this->opcode     = state->opcode;
+    this->I          = state->I;
+    this->ip         = state->ip;
+    this->sp         = state->sp;
+    this->delayTimer = state->delayTimer;
+    this->soundTimer = state->soundTimer;
+    this->fault      = state->fault;
+    this->isRunning  = state->isRunning;
+    this->rngState   = state->rngState;
+    this->memoryHash              = state->memoryHash;
+    this->screen->framebufferHash = state->framebufferHash;
+    memcpy (this->V,                   state->V,           sizeof(state->V));
+    memcpy (this->stack,               state->stack,       sizeof(state->stack));
+    memcpy (this->keys,                state->keys,        sizeof(state->keys));
+    memcpy (this->memory,              state->memory,      sizeof(state->memory));
+    Screen_beginUpdate (this->screen);
+    memcpy (this->screen->framebuffer, state->framebuffer, sizeof(state->framebuffer));
+    Screen_endUpdate (this->screen);
+}
+
+
+/*
+ * Description : Mix a buffer into a 64 bits hash, 8 bytes at a time
+ * uint64_t hash : The current hash
+ * void *data : The buffer to hash
+ * size_t size : Size of the buffer
+ * Return : uint64_t the new hash
+ */
+static uint64_t
+Cpu_hashBytes (
+    uint64_t hash,
+    void *data,
+    size_t size
+) {
+    uint8_t *bytes = data;
+
+    for (; size >= 8; size -= 8, bytes += 8) {
+        uint64_t word;
+        memcpy (&word, bytes, 8);
+        hash = (hash ^ word) * 0x100000001B3ULL;
+        hash ^= hash >> 29;
+    }
+
+    for (; size > 0; size--, bytes++) {
+        hash = (hash ^ *bytes) * 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+
+/*
+ * Description : Hash the whole machine state
+ * Cpu *this : An allocated Cpu
+ * Return : uint64_t the hash of the state
+ */
+uint64_t
+Cpu_hashState (
+    Cpu *this
+) {
+    uint8_t registers [] = {
+        this->I >> 8, this->I, this->ip >> 8, this->ip, this->sp,
+        this->delayTimer, this->soundTimer, this->fault,
+        this->rngState >> 24, this->rngState >> 16, this->rngState >> 8, this->rngState
+    };
+
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    hash = Cpu_hashBytes (hash, registers, sizeof(registers));
+    hash = Cpu_hashBytes (hash, this->V, sizeof(this->V));
+    hash = Cpu_hashBytes (hash, this->stack, this->sp * sizeof(this->stack[0]));
+    hash = Cpu_hashBytes (hash, this->keys, KEYS_COUNT);
+    hash = StateHash_mix (hash ^ this->memoryHash);
+    hash = StateHash_mix (hash ^ this->screen->framebufferHash);
+
+    return hash;
+}
+
+
+/*
+ * Description : Compute again the memory hash from the whole memory.
+ *               Needed after the memory has been written without Cpu_writeMemory.
+ * Cpu *this : An allocated Cpu
+ * Return : void
+ */
+void
+Cpu_rehashMemory (
+    Cpu *this
+) {
+    this->memoryHash = 0;
+
+    for (int address = 0; address < MEMORY_SIZE; address++) {
+        this->memoryHash ^= STATE_HASH_BYTE (address, this->memory[address]);
+    }
+}
+
+
+/*
+ * Description : Write the whole machine state in a save state file
+ * Cpu *this : An allocated Cpu
+ * char *filename : The save state file
+ * Return : bool, true on success, false otherwise
+ */
+bool
+Cpu_saveStateFile (
+    Cpu *this,
+    char *filename
+) {
+    uint32_t header [] = {CPU_STATE_MAGIC, CPU_STATE_VERSION, sizeof(CpuState)};
+    CpuState state;
+    FILE *file;
+
+    if ((file = fopen (filename, "wb")) == NULL) {
+        dbg ("The save state \"%s\" cannot be written.", filename);
+        return false;
+    }
+
+    Cpu_saveState (this, &state);
+    bool result = fwrite (header, sizeof(header), 1, file) == 1
+               && fwrite (&state, sizeof(state), 1, file) == 1;
+
+    fclose (file);
+
+    return result;
+}
+
+
+/*
+ * Description : Restore the whole machine state from a save state file
+ * Cpu *this : An allocated Cpu
+ * char *filename : The save state file
+ * Return : bool, true on success, false otherwise
+ */
+bool
+Cpu_loadStateFile (
+    Cpu *this,
+    char *filename
+) {
+    uint32_t header [3];
+    CpuState state;
+    FILE *file;
+
+    if ((file = fopen (filename, "rb")) == NULL) {
+        dbg ("The save state \"%s\" cannot be loaded.", filename);
+        return false;
+    }
+
+    bool result = fread (header, sizeof(header), 1, file) == 1
+               && header[0] == CPU_STATE_MAGIC
+               && header[1] == CPU_STATE_VERSION
+               && header[2] == sizeof(CpuState)
+               && fread (&state, sizeof(state), 1, file) == 1;
+
+    fclose (file);
+
+    if (!result) {
+        dbg ("\"%s\" is not a compatible save state.", filename);
+        return false;
+    }
+
+    Cpu_loadState (this, &state);
+
+    // Don't trust the hashes stored in the file
+    Cpu_rehashMemory (this);
+    Screen_rehash (this->screen);
+
+    return true;
 }
 
 
@@ -626,15 +1024,94 @@ Cpu_updateTimers (
         this->delayTimer--;
     }
 
+    // The buzzer sounds during the next tick while the sound timer is above zero
+    if (this->audio && !this->isRunningAhead) {
+        Audio_setTone (this->audio, this->soundTimer > 0);
+    }
+
+    if (this->capture && !this->isRunningAhead) {
+        AudioCapture_addSlice (this->capture, this->soundTimer > 0);
+    }
+
     if (this->soundTimer > 0) {
         this->soundTimer--;
 
-        if (this->soundTimer == 0) {
+        // Without audio stream nor capture, a beep is emitted at the end of the sound
+        if (this->soundTimer == 0 && !this->audio && !this->capture && !this->isRunningAhead) {
             Window_requestBeep ();
         }
     }
 }
 
+/*
+ * Description : Register the profilers of the CPU, for the frontend
+ * Cpu *this : An allocated Cpu
+ * Return : true on success, false on failure.
+ */
+bool
+Cpu_initProfilers (
+    Cpu *this
+) {
+    if (!(this->profiler = ProfilerFactory_getProfiler ("CPU"))
+    ||  !(this->sliceTimes = ProfilerFactory_getHistogram ("CPU slice"))
+    ||  !(this->sliceClock = sfClock_create ())) {
+        dbg ("Cannot allocate a new Profiler.");
+        return false;
+    }
+
+    return true;
+}
+
+
+/*
+ * Description : Run a slice of the frontend : apply the key events, emulate "speed" cycles then update the timers
+ * Cpu *this : An allocated Cpu, with its profilers
+ * Return : void
+ */
+void
+Cpu_runSlice (
+    Cpu *this
+) {
+    PROFILER_ZONE_BEGIN ("CPU slice");
+    sfClock_restart (this->sliceClock);
+
+    // Keys pressed during this slice
+    if (this->keyQueue) {
+        Cpu_setKeys (this, KeyQueue_getKeys (this->keyQueue, Cpu_getKeys (this)));
+    }
+
+    // Emulate "speed" CPU cycles
+    for (int cycle = 0; cycle < this->speed && this->isRunning; cycle++) {
+        Profiler_tick (this->profiler);
+        Cpu_emulateCycle (this);
+    }
+
+    // Update CPU timers
+    Cpu_updateTimers (this);
+
+    ProfilerHistogram_record (this->sliceTimes, sfTime_asMicroseconds (sfClock_getElapsedTime (this->sliceClock)));
+    PROFILER_ZONE_END ();
+}
+
+
+/*
+ * Description : Terminate the emulator if the CPU faulted. The last instructions are kept for tools/trace.
+ * Cpu *this : An allocated Cpu
+ * Return : void
+ */
+void
+Cpu_exitOnFault (
+    Cpu *this
+) {
+    if (this->fault != CPU_FAULT_NONE) {
+        if (this->trace && CpuTrace_save (this->trace, CPU_TRACE_FILENAME, this->fault)) {
+            printf ("The last instructions executed are saved in \"%s\".\n", CPU_TRACE_FILENAME);
+        }
+        exit (0);
+    }
+}
+
+
 /*
  * Description : Main loop of the CPU.
  * Cpu *this : An allocated Cpu
@@ -644,21 +1121,17 @@ void
 Cpu_loop (
     Cpu *this
 ) {
+    PROFILER_THREAD_NAME ("CPU");
+
     while (this->isRunning)
     {
-        Profiler_tick (this->profiler);
-
-        // Emulate one CPU cycle
-        Cpu_emulateCycle (this);
+        Cpu_runSlice (this);
 
         // Sleep a bit so the CPU doesn't burn
-        if (this->profiler->ticksCount % this->speed == 0) {
-			// Update CPU timers
-			Cpu_updateTimers (this);
-
-            sfSleep (sfSeconds(0.01));
-        }
+        sfSleep (sfSeconds(0.01));
     }
+
+    Cpu_exitOnFault (this);
 }
 
 
@@ -671,6 +1144,10 @@ sfThread *
 Cpu_startThread (
     Cpu *this
 ) {
+    if (!Cpu_initProfilers (this)) {
+        return NULL;
+    }
+
     this->thread = sfThread_create ((void (*)(void *)) Cpu_loop, this);
     sfThread_launch (this->thread);
 
@@ -774,9 +1251,15 @@ Cpu_free (
 ) {
     if (this != NULL)
     {
+        // The profiler and the histogram belong to the ProfilerFactory registry
         Screen_free (this->screen);
-        Profiler_free (this->profiler);
-        sfThread_destroy (this->thread);
+        if (this->sliceClock) {
+            sfClock_destroy (this->sliceClock);
+        }
+        free (this->decoded);
+        if (this->thread) {
+            sfThread_destroy (this->thread);
+        }
         free (this);
     }
 }
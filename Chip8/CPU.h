@@ -4,6 +4,14 @@
 // ---------- Includes ------------
 #include "Window.h"
 #include "Screen.h"
+#include "StateHash.h"
+#include "GuestProfiler.h"
+#include "CpuTrace.h"
+#include "Audio.h"
+#include "AudioCapture.h"
+#ifdef CPU_OPCODE_STATS
+#include "OpcodeStats.h"
+#endif
 #include "Profiler/ProfilerFactory.h"
 #include "Utils/Utils.h"
 #include "Ztring/Ztring.h"
@@ -16,14 +24,75 @@
 #define INSN_SIZE sizeof_struct_member(Cpu, opcode)
 #define DEFAULT_CPU_SPEED 5
 
+// Guest edge coverage (AFL style)
+#define CPU_COVERAGE_MAP_SIZE 0x10000
+#define CPU_COVERAGE_LOCATION(ip) ((uint16_t) ((ip) * 0x9E37))
+
 // Memory layout
 #define USER_SPACE_START_ADDRESS 0x200
 #define DISPLAY_REFRESH_START_ADDRESS 0xF00
 #define USER_PROGRAM_SPACE_SIZE (MEMORY_SIZE - USER_SPACE_START_ADDRESS)
 #define FONT_START_ADDRESS 0x000
 
+// Save states
+#define CPU_STATE_MAGIC   0x54533843 // "C8ST"
+#define CPU_STATE_VERSION 2
+
 
 // ------ Structure declaration -------
+
+/*
+ *    Faults raised by the CPU. Any fault stops the CPU.
+ */
+typedef enum {
+    CPU_FAULT_NONE = 0,
+    CPU_FAULT_STACK_OVERFLOW,
+    CPU_FAULT_STACK_UNDERFLOW,
+    CPU_FAULT_UNKNOWN_OPCODE,
+    CPU_FAULT_RCA_CALL,
+    CPU_FAULT_MEMORY_ACCESS,
+
+    cpuFaultCount // Always at the end
+} CpuFault;
+
+/*
+ *    Interpreters available to emulate the CPU. They must give exactly the same results :
+ *    tools/diff runs them side by side and reports the first divergence.
+ */
+typedef enum {
+    CPU_ENGINE_REFERENCE = 0, // Cpu_executeOpcode
+    CPU_ENGINE_FAST,          // FastCpu : instructions decoded once, dispatched through handlers
+
+    cpuEngineCount // Always at the end
+} CpuEngine;
+
+// Instruction decoded by the fast engine (see FastCpu.h)
+typedef struct _CpuDecodedInsn CpuDecodedInsn;
+
+/*
+ *    Whole machine state, copied by save states
+ */
+typedef struct _CpuState
+{
+    uint16_t opcode;
+    uint8_t V [REGISTERS_COUNT];
+    uint16_t I;
+    uint16_t ip;
+    uint16_t stack [STACK_SIZE];
+    uint8_t sp;
+    uint8_t delayTimer;
+    uint8_t soundTimer;
+    uint8_t fault;
+    bool isRunning;
+    uint32_t rngState;
+    uint8_t keys [KEYS_COUNT];
+    uint8_t memory [MEMORY_SIZE];
+    uint8_t framebuffer [RESOLUTION_W * RESOLUTION_H];
+    uint64_t memoryHash;
+    uint64_t framebufferHash;
+
+}   CpuState;
+
 typedef struct _Cpu
 {
     // All opcodes are coded on 16 bits
@@ -41,6 +110,9 @@ typedef struct _Cpu
     */
     uint8_t memory [MEMORY_SIZE];
 
+    // Hash of the memory, updated on each write (see StateHash.h)
+    uint64_t memoryHash;
+
     // Index register
     uint16_t I;
 
@@ -56,6 +128,12 @@ typedef struct _Cpu
     // Screen display
     Screen *screen;
 
+    // Keys state, only written by the CPU thread
+    uint8_t keys [KEYS_COUNT];
+
+    // Key events of the Window, applied at the start of each slice of Cpu_runSlice (NULL when headless)
+    KeyQueue *keyQueue;
+
     // Timers : when set above zero they will count down to zero.
     uint8_t delayTimer;
     uint8_t soundTimer; // The system’s buzzer sounds whenever the sound timer reaches zero.
@@ -63,12 +141,48 @@ typedef struct _Cpu
     // Profiler for the CPU
     Profiler * profiler;
 
+    // Durations of the slices of Cpu_runSlice
+    ProfilerHistogram *sliceTimes;
+    sfClock *sliceClock;
+
     // CPU virtual speed
     int speed;
 
+    // State of the random generator used by CXNN (xorshift32)
+    uint32_t rngState;
+
+    // Hit counts of the edges (previous ip -> ip), recorded only when a map is set
+    uint8_t *coverageMap;
+    uint16_t coveragePrevious;
+
+    // Instructions executed per address and per subroutine, recorded only when a profiler is set
+    GuestProfiler *guestProfiler;
+
+    // Last instructions executed, recorded only when a trace is set
+    CpuTrace *trace;
+
+    // Input to photon latency, measured only when it is set
+    InputLatency *latency;
+
+    // Buzzer output, played only when it is set
+    Audio *audio;
+
+    // Buzzer output synthesized without audio device, captured only when it is set
+    AudioCapture *capture;
+
+    // Interpreter used by Cpu_emulateFrame, and the instructions decoded by the fast one
+    CpuEngine engine;
+    CpuDecodedInsn *decoded;
+
     // Running state
     bool isRunning;
 
+    // Frames emulated ahead of the real machine are running (see RunAhead.h) : no sound
+    bool isRunningAhead;
+
+    // Fault which stopped the CPU, CPU_FAULT_NONE otherwise
+    CpuFault fault;
+
     // Thread object pointer
     sfThread *thread;
 
@@ -116,6 +230,17 @@ Cpu_emulateCycle (
     Cpu *this
 );
 
+/*
+ * Description : Emulate a frame : "speed" CPU cycles followed by a timers update.
+ *               It is the unit of time used by headless machines.
+ * Cpu *this : An allocated Cpu
+ * Return : void
+ */
+void
+Cpu_emulateFrame (
+    Cpu *this
+);
+
 /*
  * Description : Execute the current opcode
  * Cpu *this : An allocated Cpu
@@ -150,6 +275,160 @@ Cpu_fetchOpcode (
     uint16_t ip
 );
 
+/*
+ * Description : Seed the random generator used by CXNN, so runs can be reproduced
+ * Cpu *this : An allocated Cpu
+ * uint32_t seed : The seed
+ * Return : void
+ */
+void
+Cpu_seed (
+    Cpu *this,
+    uint32_t seed
+);
+
+/*
+ * Description : Get the next number of the random generator used by CXNN
+ * Cpu *this : An allocated Cpu
+ * Return : uint32_t a pseudo random number
+ */
+uint32_t
+Cpu_random (
+    Cpu *this
+);
+
+/*
+ * Description : Set the keys pressed from a mask. A key held down keeps its state.
+ * Cpu *this : An allocated Cpu
+ * uint16_t keysMask : Bit N set when the key N is pressed
+ * Return : void
+ */
+void
+Cpu_setKeys (
+    Cpu *this,
+    uint16_t keysMask
+);
+
+/*
+ * Description : Get the keys pressed as a mask
+ * Cpu *this : An allocated Cpu
+ * Return : uint16_t Bit N set when the key N is pressed
+ */
+uint16_t
+Cpu_getKeys (
+    Cpu *this
+);
+
+/*
+ * Description : Copy the whole machine state (CPU, memory, keys and framebuffer)
+ * Cpu *this : An allocated Cpu
+ * CpuState *state : (out) The state saved
+ * Return : void
+ */
+void
+Cpu_saveState (
+    Cpu *this,
+    CpuState *state
+);
+
+/*
+ * Description : Restore a whole machine state saved by Cpu_saveState
+ * Cpu *this : An allocated Cpu
+ * CpuState *state : The state to restore
+ * Return : void
+ */
+void
+Cpu_loadState (
+    Cpu *this,
+    CpuState *state
+);
+
+/*
+ * Description : Hash the whole machine state. Memory and framebuffer are hashed
+ *               incrementally, so it only costs a few dozens of bytes hashed.
+ * Cpu *this : An allocated Cpu
+ * Return : uint64_t the hash of the state
+ */
+uint64_t
+Cpu_hashState (
+    Cpu *this
+);
+
+/*
+ * Description : Compute again the memory hash from the whole memory.
+ *               Needed after the memory has been written without Cpu_writeMemory.
+ * Cpu *this : An allocated Cpu
+ * Return : void
+ */
+void
+Cpu_rehashMemory (
+    Cpu *this
+);
+
+/*
+ * Description : Select the interpreter used by Cpu_emulateFrame
+ * Cpu *this : An allocated Cpu
+ * CpuEngine engine : The interpreter
+ * Return : bool, true on success, false otherwise
+ */
+bool
+Cpu_setEngine (
+    Cpu *this,
+    CpuEngine engine
+);
+
+/*
+ * Description : Get a printable name of an engine
+ * CpuEngine engine : An interpreter
+ * Return : char * the name of the engine
+ */
+char *
+Cpu_getEngineName (
+    CpuEngine engine
+);
+
+/*
+ * Description : Write a byte in memory and update the memory hash
+ * Cpu *this : An allocated Cpu
+ * uint16_t address : The address written
+ * uint8_t value : The value written
+ * Return : void
+ */
+static inline void
+Cpu_writeMemory (
+    Cpu *this,
+    uint16_t address,
+    uint8_t value
+) {
+    this->memoryHash ^= STATE_HASH_BYTE (address, this->memory[address])
+                     ^  STATE_HASH_BYTE (address, value);
+    this->memory[address] = value;
+}
+
+/*
+ * Description : Write the whole machine state in a save state file
+ * Cpu *this : An allocated Cpu
+ * char *filename : The save state file
+ * Return : bool, true on success, false otherwise
+ */
+bool
+Cpu_saveStateFile (
+    Cpu *this,
+    char *filename
+);
+
+/*
+ * Description : Restore the whole machine state from a save state file
+ * Cpu *this : An allocated Cpu
+ * char *filename : The save state file
+ * Return : bool, true on success, false otherwise
+ */
+bool
+Cpu_loadStateFile (
+    Cpu *this,
+    char *filename
+);
+
 /*
  * Description : Update the cpu timers
  * Cpu *this : An allocated Cpu
@@ -170,6 +449,42 @@ Cpu_unknownOpcode (
     Cpu *this
 );
 
+/*
+ * Description : Check that a memory access stays inside the memory, raise a fault otherwise
+ * Cpu *this : An allocated Cpu
+ * uint16_t address : Start of the access
+ * int size : Number of bytes accessed
+ * Return : bool, true if the access is valid
+ */
+bool
+Cpu_checkMemoryAccess (
+    Cpu *this,
+    uint16_t address,
+    int size
+);
+
+/*
+ * Description : Stop the CPU because of a fault
+ * Cpu *this : An allocated Cpu
+ * CpuFault fault : The fault raised
+ * Return : void
+ */
+void
+Cpu_raiseFault (
+    Cpu *this,
+    CpuFault fault
+);
+
+/*
+ * Description : Get a printable name of a fault
+ * CpuFault fault : A fault raised by the CPU
+ * Return : char * the name of the fault
+ */
+char *
+Cpu_getFaultName (
+    CpuFault fault
+);
+
 /*
  * Description : Push an element on the stack
  * Cpu *this : An allocated Cpu
@@ -235,6 +550,36 @@ Cpu_disass (
 	Cpu *this
 );
 
+/*
+ * Description : Register the profilers of the CPU, for the frontend
+ * Cpu *this : An allocated Cpu
+ * Return : true on success, false on failure.
+ */
+bool
+Cpu_initProfilers (
+    Cpu *this
+);
+
+/*
+ * Description : Run a slice of the frontend : apply the key events, emulate "speed" cycles then update the timers
+ * Cpu *this : An allocated Cpu, with its profilers
+ * Return : void
+ */
+void
+Cpu_runSlice (
+    Cpu *this
+);
+
+/*
+ * Description : Terminate the emulator if the CPU faulted. The last instructions are kept for tools/trace.
+ * Cpu *this : An allocated Cpu
+ * Return : void
+ */
+void
+Cpu_exitOnFault (
+    Cpu *this
+);
+
 /*
  * Description : Start the main loop of the CPU in a separate thread.
  * Cpu *this : An allocated Cpu
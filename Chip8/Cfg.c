@@ -0,0 +1,319 @@
+#include "Cfg.h"
+#include "Disassembler.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "Cfg"
+#include "dbg/dbg.h"
+
+/*
+ * Description     : Build the control flow graph of a ROM loaded in memory
+ * uint8_t *memory : Memory of the guest, CFG_MEMORY_SIZE bytes
+ * uint16_t start : Address of the first byte of the ROM, its entry
+ * uint16_t size : Size of the ROM
+ * Return        : A pointer to an allocated Cfg, NULL on failure.
+ */
+Cfg *
+Cfg_new (
+    uint8_t *memory,
+    uint16_t start,
+    uint16_t size
+) {
+    Cfg *this;
+
+    if ((this = calloc (1, sizeof(Cfg))) == NULL)
+        return NULL;
+
+    if (!Cfg_init (this, memory, start, size)) {
+        Cfg_free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+
+/*
+ * Is there a whole instruction of the ROM at an address
+ */
+static inline bool
+Cfg_isInRom (
+    Cfg *this,
+    int address
+) {
+    return address >= this->start && address + 1 < this->end;
+}
+
+
+/*
+ * Get the addresses executed after an instruction, and the flags of these addresses.
+ * Return the number of successors ; *isLast is set when the instruction ends its basic block.
+ */
+static int
+Cfg_getSuccessors (
+    uint16_t address,
+    uint16_t opcode,
+    uint16_t successors [CFG_MAX_SUCCESSORS],
+    uint8_t flags [CFG_MAX_SUCCESSORS],
+    bool *isLast
+) {
+    uint16_t next = address + 2;
+    *isLast = true;
+
+    switch (Disassembler_getClass (opcode))
+    {
+        // The CPU stops, or returns to a caller unknown statically
+        case OPCODE_00EE:
+        case OPCODE_0NNN:
+        case OPCODE_UNKNOWN:
+            return 0;
+
+        case OPCODE_1NNN:
+            successors[0] = opcode & 0x0FFF; flags[0] = CFG_JUMP_TARGET;
+            return 1;
+
+        case OPCODE_BNNN:
+            successors[0] = opcode & 0x0FFF; flags[0] = CFG_JUMP_TARGET | CFG_INDIRECT;
+            return 1;
+
+        case OPCODE_2NNN:
+            successors[0] = opcode & 0x0FFF; flags[0] = CFG_SUBROUTINE;
+            successors[1] = next;            flags[1] = 0;
+            return 2;
+
+        case OPCODE_3XNN: case OPCODE_4XNN: case OPCODE_5XY0: case OPCODE_9XY0:
+        case OPCODE_EX9E: case OPCODE_EXA1:
+            successors[0] = next;     flags[0] = CFG_JUMP_TARGET;
+            successors[1] = next + 2; flags[1] = CFG_JUMP_TARGET;
+            return 2;
+
+        default:
+            successors[0] = next; flags[0] = 0;
+            *isLast = false;
+            return 1;
+    }
+}
+
+
+/*
+ * Follow every path from the entry, and mark the instructions found
+ */
+static void
+Cfg_explore (
+    Cfg *this,
+    uint8_t *memory
+) {
+    // Each instruction adds at most CFG_MAX_SUCCESSORS addresses
+    uint16_t pending [CFG_MAX_SUCCESSORS * CFG_MEMORY_SIZE + 1];
+    int pendingCount = 0;
+
+    pending[pendingCount++] = this->start;
+    this->flags[this->start] |= CFG_BLOCK;
+
+    while (pendingCount > 0)
+    {
+        uint16_t address = pending[--pendingCount];
+
+        while (Cfg_isInRom (this, address) && !(this->flags[address] & CFG_INSN))
+        {
+            uint16_t opcode = (memory[address] << 8) | memory[address + 1];
+            uint16_t successors [CFG_MAX_SUCCESSORS];
+            uint8_t flags [CFG_MAX_SUCCESSORS];
+            bool isLast;
+
+            this->flags[address]     |= CFG_CODE | CFG_INSN;
+            this->flags[address + 1] |= CFG_CODE;
+
+            if ((opcode & 0xF000) == 0xA000 && Cfg_isInRom (this, opcode & 0x0FFF)) {
+                this->flags[opcode & 0x0FFF] |= CFG_DATA_REF;
+            }
+
+            int successorsCount = Cfg_getSuccessors (address, opcode, successors, flags, &isLast);
+
+            if (!isLast) {
+                address = successors[0];
+                continue;
+            }
+
+            for (int id = 0; id < successorsCount; id++) {
+                if (Cfg_isInRom (this, successors[id])) {
+                    this->flags[successors[id]] |= CFG_BLOCK | flags[id];
+                    pending[pendingCount++] = successors[id];
+                }
+            }
+            break;
+        }
+    }
+}
+
+
+/*
+ * Split the instructions found in basic blocks
+ */
+static bool
+Cfg_buildBlocks (
+    Cfg *this,
+    uint8_t *memory
+) {
+    int capacity = 0;
+
+    for (int address = this->start; address < this->end; address++)
+    {
+        if ((this->flags[address] & (CFG_BLOCK | CFG_INSN)) != (CFG_BLOCK | CFG_INSN)) {
+            continue;
+        }
+
+        if (this->blocksCount == capacity) {
+            capacity = (capacity) ? capacity * 2 : 64;
+            CfgBlock *blocks = realloc (this->blocks, capacity * sizeof(CfgBlock));
+            if (blocks == NULL) {
+                return false;
+            }
+            this->blocks = blocks;
+        }
+
+        CfgBlock *block = &this->blocks[this->blocksCount++];
+        uint16_t current = address;
+        uint8_t flags [CFG_MAX_SUCCESSORS];
+        bool isLast;
+
+        block->start = address;
+
+        while (true)
+        {
+            uint16_t opcode = (memory[current] << 8) | memory[current + 1];
+            block->successorsCount = Cfg_getSuccessors (current, opcode, block->successors, flags, &isLast);
+            block->end = current + 2;
+
+            if (isLast) {
+                break;
+            }
+
+            // Falls through the end of the ROM, or into another block
+            if (!Cfg_isInRom (this, block->end) || !(this->flags[block->end] & CFG_INSN)) {
+                block->successorsCount = 0;
+                break;
+            }
+            if (this->flags[block->end] & CFG_BLOCK) {
+                break;
+            }
+
+            current = block->end;
+        }
+    }
+
+    return true;
+}
+
+
+/*
+ * Description : Initialize an allocated Cfg structure.
+ * Cfg *this : An allocated Cfg to initialize.
+ * uint8_t *memory : Memory of the guest, CFG_MEMORY_SIZE bytes
+ * uint16_t start : Address of the first byte of the ROM, its entry
+ * uint16_t size : Size of the ROM
+ * Return : true on success, false on failure.
+ */
+bool
+Cfg_init (
+    Cfg *this,
+    uint8_t *memory,
+    uint16_t start,
+    uint16_t size
+) {
+    if (start >= CFG_MEMORY_SIZE || size > CFG_MEMORY_SIZE - start) {
+        dbg ("Error : The ROM [%03X, %03X) is out of memory.", start, start + size);
+        return false;
+    }
+
+    this->start = start;
+    this->end = start + size;
+
+    Cfg_explore (this, memory);
+
+    return Cfg_buildBlocks (this, memory);
+}
+
+
+/*
+ * Description : Get the basic block containing an instruction
+ * Cfg *this : An allocated Cfg
+ * uint16_t address : Address of the instruction
+ * Return : CfgBlock * the block, NULL when the address isn't code
+ */
+CfgBlock *
+Cfg_getBlock (
+    Cfg *this,
+    uint16_t address
+) {
+    int low = 0, high = this->blocksCount - 1;
+
+    // Last block starting before the address
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        if (this->blocks[middle].start <= address) {
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    if (high >= 0 && address < this->blocks[high].end) {
+        return &this->blocks[high];
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Description : Write the label of an address, e.g. "sub_2A4", "loc_2B0" or "data_3F0"
+ * Cfg *this : An allocated Cfg
+ * uint16_t address : An address
+ * char *buffer : Where the label is written, at least 16 bytes
+ * Return : bool true when the address has a label
+ */
+bool
+Cfg_getLabel (
+    Cfg *this,
+    uint16_t address,
+    char *buffer
+) {
+    uint8_t flags = (address < CFG_MEMORY_SIZE) ? this->flags[address] : 0;
+    char *prefix;
+
+    if (address == this->start) {
+        strcpy (buffer, "main");
+        return true;
+    }
+
+    if (flags & CFG_SUBROUTINE) {
+        prefix = "sub";
+    } else if (flags & CFG_JUMP_TARGET) {
+        prefix = "loc";
+    } else if (flags & CFG_DATA_REF) {
+        prefix = "data";
+    } else {
+        return false;
+    }
+
+    sprintf (buffer, "%s_%03X", prefix, address);
+
+    return true;
+}
+
+
+/*
+ * Description : Free an allocated Cfg structure.
+ * Cfg *this : An allocated Cfg to free.
+ */
+void
+Cfg_free (
+    Cfg *this
+) {
+    if (this != NULL)
+    {
+        free (this->blocks);
+        free (this);
+    }
+}
@@ -0,0 +1,126 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define CFG_MEMORY_SIZE 0x1000
+#define CFG_MAX_SUCCESSORS 2
+
+// Flags of each byte of the memory
+#define CFG_CODE        0x01 // Part of an instruction reached from the entry
+#define CFG_INSN        0x02 // First byte of an instruction
+#define CFG_BLOCK       0x04 // First instruction of a basic block
+#define CFG_SUBROUTINE  0x08 // Called by a 2NNN
+#define CFG_JUMP_TARGET 0x10 // Reached by a jump or a skip
+#define CFG_DATA_REF    0x20 // Referenced by an ANNN
+#define CFG_INDIRECT    0x40 // Base of a BNNN jump table
+
+// ------ Structure declaration -------
+
+/*
+ *    Static control flow graph of a ROM, built by recursive descent from its entry :
+ *    every instruction reachable by the fall-throughs, skips, jumps and calls is code,
+ *    the rest of the ROM is data. The targets of BNNN depend on V0 : only its base is followed.
+ */
+typedef struct _CfgBlock
+{
+    // Instructions [start, end)
+    uint16_t start;
+    uint16_t end;
+
+    // Blocks reached after the last instruction (returns excluded)
+    uint16_t successors [CFG_MAX_SUCCESSORS];
+    int successorsCount;
+
+}   CfgBlock;
+
+typedef struct _Cfg
+{
+    // Flags of each byte of the memory
+    uint8_t flags [CFG_MEMORY_SIZE];
+
+    // ROM analyzed : [start, end)
+    uint16_t start;
+    uint16_t end;
+
+    // Basic blocks, sorted by address
+    CfgBlock *blocks;
+    int blocksCount;
+
+}   Cfg;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Build the control flow graph of a ROM loaded in memory
+ * uint8_t *memory : Memory of the guest, CFG_MEMORY_SIZE bytes
+ * uint16_t start : Address of the first byte of the ROM, its entry
+ * uint16_t size : Size of the ROM
+ * Return        : A pointer to an allocated Cfg, NULL on failure.
+ */
+Cfg *
+Cfg_new (
+    uint8_t *memory,
+    uint16_t start,
+    uint16_t size
+);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Initialize an allocated Cfg structure.
+ * Cfg *this : An allocated Cfg to initialize.
+ * uint8_t *memory : Memory of the guest, CFG_MEMORY_SIZE bytes
+ * uint16_t start : Address of the first byte of the ROM, its entry
+ * uint16_t size : Size of the ROM
+ * Return : true on success, false on failure.
+ */
+bool
+Cfg_init (
+    Cfg *this,
+    uint8_t *memory,
+    uint16_t start,
+    uint16_t size
+);
+
+/*
+ * Description : Get the basic block containing an instruction
+ * Cfg *this : An allocated Cfg
+ * uint16_t address : Address of the instruction
+ * Return : CfgBlock * the block, NULL when the address isn't code
+ */
+CfgBlock *
+Cfg_getBlock (
+    Cfg *this,
+    uint16_t address
+);
+
+/*
+ * Description : Write the label of an address, e.g. "sub_2A4", "loc_2B0" or "data_3F0"
+ * Cfg *this : An allocated Cfg
+ * uint16_t address : An address
+ * char *buffer : Where the label is written, at least 16 bytes
+ * Return : bool true when the address has a label
+ */
+bool
+Cfg_getLabel (
+    Cfg *this,
+    uint16_t address,
+    char *buffer
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated Cfg structure.
+ * Cfg *this : An allocated Cfg to free.
+ */
+void
+Cfg_free (
+    Cfg *this
+);
@@ -0,0 +1,155 @@
+#include "CpuTrace.h"
+#include "LittleEndian.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "CpuTrace"
+#include "dbg/dbg.h"
+
+/*
+ * Description     : Allocate a new empty CpuTrace structure.
+ * Return        : A pointer to an allocated CpuTrace.
+ */
+CpuTrace *
+CpuTrace_new (void)
+{
+    return calloc (1, sizeof(CpuTrace));
+}
+
+
+/*
+ * Description     : Load a CpuTrace saved by CpuTrace_save.
+ * char *filename : Path of the trace
+ * Return        : A pointer to an allocated CpuTrace, NULL on failure.
+ */
+CpuTrace *
+CpuTrace_load (
+    char *filename
+) {
+    uint32_t header [4];
+    CpuTrace *this;
+    FILE *file;
+
+    if ((file = fopen (filename, "rb")) == NULL) {
+        dbg ("The trace \"%s\" cannot be loaded.", filename);
+        return NULL;
+    }
+
+    if (!LittleEndian_readWords (file, header, sizeof_array (header))
+    ||  header[0] != CPU_TRACE_MAGIC
+    ||  header[1] != CPU_TRACE_VERSION
+    ||  header[2] > CPU_TRACE_SIZE) {
+        dbg ("\"%s\" is not a compatible trace.", filename);
+        fclose (file);
+        return NULL;
+    }
+
+    if ((this = CpuTrace_new ()) == NULL) {
+        fclose (file);
+        return NULL;
+    }
+
+    this->fault = header[3];
+
+    for (uint32_t index = 0; index < header[2]; index++) {
+        uint8_t bytes [8];
+        if (fread (bytes, sizeof(bytes), 1, file) != 1) {
+            dbg ("The trace \"%s\" is truncated at record %u.", filename, index);
+            break;
+        }
+        CpuTrace_record (this,
+            bytes[0] | (bytes[1] << 8), bytes[2] | (bytes[3] << 8), bytes[4] | (bytes[5] << 8),
+            bytes[6], bytes[7]);
+    }
+
+    fclose (file);
+
+    return this;
+}
+
+
+/*
+ * Description : Get the number of records kept by the trace
+ * CpuTrace *this : An allocated CpuTrace
+ * Return : int the number of records
+ */
+int
+CpuTrace_getRecordsCount (
+    CpuTrace *this
+) {
+    return (this->count < CPU_TRACE_SIZE) ? this->count : CPU_TRACE_SIZE;
+}
+
+
+/*
+ * Description : Get a record, from the oldest one kept
+ * CpuTrace *this : An allocated CpuTrace
+ * int index : Index of the record, 0 for the oldest one
+ * Return : CpuTraceRecord * the record
+ */
+CpuTraceRecord *
+CpuTrace_getRecord (
+    CpuTrace *this,
+    int index
+) {
+    uint64_t oldest = this->count - CpuTrace_getRecordsCount (this);
+
+    return &this->records[(oldest + index) & (CPU_TRACE_SIZE - 1)];
+}
+
+
+/*
+ * Description : Save the records of the trace in a file
+ * CpuTrace *this : An allocated CpuTrace
+ * char *filename : Path of the trace
+ * uint32_t fault : Fault which stopped the CPU
+ * Return : bool, true on success, false otherwise
+ */
+bool
+CpuTrace_save (
+    CpuTrace *this,
+    char *filename,
+    uint32_t fault
+) {
+    int recordsCount = CpuTrace_getRecordsCount (this);
+    uint32_t header [] = {CPU_TRACE_MAGIC, CPU_TRACE_VERSION, recordsCount, fault};
+    bool result = true;
+    FILE *file;
+
+    if ((file = fopen (filename, "wb")) == NULL) {
+        dbg ("The trace \"%s\" cannot be written.", filename);
+        return false;
+    }
+
+    result = LittleEndian_writeWords (file, header, sizeof_array (header));
+
+    for (int index = 0; result && index < recordsCount; index++) {
+        CpuTraceRecord *record = CpuTrace_getRecord (this, index);
+        uint8_t bytes [] = {
+            record->ip & 0xFF, record->ip >> 8,
+            record->opcode & 0xFF, record->opcode >> 8,
+            record->I & 0xFF, record->I >> 8,
+            record->vx, record->vy
+        };
+        result = fwrite (bytes, sizeof(bytes), 1, file) == 1;
+    }
+
+    fclose (file);
+
+    return result;
+}
+
+
+/*
+ * Description : Free an allocated CpuTrace structure.
+ * CpuTrace *this : An allocated CpuTrace to free.
+ */
+void
+CpuTrace_free (
+    CpuTrace *this
+) {
+    if (this != NULL)
+    {
+        free (this);
+    }
+}
@@ -0,0 +1,139 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define CPU_TRACE_SIZE     0x4000 // Records kept, a power of 2
+#define CPU_TRACE_MAGIC    0x52543843 // "C8TR"
+#define CPU_TRACE_VERSION  1
+#define CPU_TRACE_FILENAME "fault.c8t"
+
+/*
+ *    Trace file layout (little endian) :
+ *        uint32_t magic, version, recordsCount, fault
+ *        { uint16_t ip, opcode, I ; uint8_t vx, vy } records [recordsCount], the oldest first
+ */
+
+// ------ Structure declaration -------
+
+// An instruction executed, and the registers it reads before its execution
+typedef struct _CpuTraceRecord
+{
+    uint16_t ip;
+    uint16_t opcode;
+    uint16_t I;
+    uint8_t vx;
+    uint8_t vy;
+
+}   CpuTraceRecord;
+
+// The last CPU_TRACE_SIZE instructions executed
+typedef struct _CpuTrace
+{
+    CpuTraceRecord records [CPU_TRACE_SIZE];
+
+    // Instructions recorded since the trace was created
+    uint64_t count;
+
+    // Fault which stopped the CPU, for a loaded trace
+    uint32_t fault;
+
+}   CpuTrace;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Allocate a new empty CpuTrace structure.
+ * Return        : A pointer to an allocated CpuTrace.
+ */
+CpuTrace *
+CpuTrace_new (void);
+
+/*
+ * Description     : Load a CpuTrace saved by CpuTrace_save.
+ * char *filename : Path of the trace
+ * Return        : A pointer to an allocated CpuTrace, NULL on failure.
+ */
+CpuTrace *
+CpuTrace_load (
+    char *filename
+);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Record an instruction about to be executed, overwriting the oldest one
+ * CpuTrace *this : An allocated CpuTrace
+ * uint16_t ip, opcode, I : State of the CPU before the instruction
+ * uint8_t vx, vy : Registers VX and VY of the opcode
+ * Return : void
+ */
+static inline void
+CpuTrace_record (
+    CpuTrace *this,
+    uint16_t ip,
+    uint16_t opcode,
+    uint16_t I,
+    uint8_t vx,
+    uint8_t vy
+) {
+    CpuTraceRecord *record = &this->records[this->count++ & (CPU_TRACE_SIZE - 1)];
+
+    record->ip     = ip;
+    record->opcode = opcode;
+    record->I      = I;
+    record->vx     = vx;
+    record->vy     = vy;
+}
+
+/*
+ * Description : Get the number of records kept by the trace
+ * CpuTrace *this : An allocated CpuTrace
+ * Return : int the number of records
+ */
+int
+CpuTrace_getRecordsCount (
+    CpuTrace *this
+);
+
+/*
+ * Description : Get a record, from the oldest one kept
+ * CpuTrace *this : An allocated CpuTrace
+ * int index : Index of the record, 0 for the oldest one
+ * Return : CpuTraceRecord * the record
+ */
+CpuTraceRecord *
+CpuTrace_getRecord (
+    CpuTrace *this,
+    int index
+);
+
+/*
+ * Description : Save the records of the trace in a file
+ * CpuTrace *this : An allocated CpuTrace
+ * char *filename : Path of the trace
+ * uint32_t fault : Fault which stopped the CPU
+ * Return : bool, true on success, false otherwise
+ */
+bool
+CpuTrace_save (
+    CpuTrace *this,
+    char *filename,
+    uint32_t fault
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated CpuTrace structure.
+ * CpuTrace *this : An allocated CpuTrace to free.
+ */
+void
+CpuTrace_free (
+    CpuTrace *this
+);
@@ -0,0 +1,62 @@
+#include "CycleDetector.h"
+
+/*
+ * Description : Start a new detection from a state, e.g. when the input changes
+ * CycleDetector *this : A CycleDetector
+ * uint64_t hash : Hash of the current state (Cpu_hashState)
+ * Return : void
+ */
+void
+CycleDetector_reset (
+    CycleDetector *this,
+    uint64_t hash
+) {
+    this->hash      = hash;
+    this->countdown = CYCLE_DETECTOR_INTERVAL;
+    this->steps     = 0;
+    this->power     = 1;
+    this->length    = 0;
+}
+
+
+/*
+ * Description : Count one more frame emulated
+ * CycleDetector *this : A CycleDetector
+ * Return : bool, true when the state must be hashed and given to CycleDetector_update
+ */
+bool
+CycleDetector_isDue (
+    CycleDetector *this
+) {
+    return (--this->countdown == 0);
+}
+
+
+/*
+ * Description : Feed the hash of the state, when CycleDetector_isDue asks for it
+ * CycleDetector *this : A CycleDetector
+ * uint64_t hash : Hash of the current state (Cpu_hashState)
+ * Return : bool, true when the state already happened : the machine is in a cycle of "length" frames
+ */
+bool
+CycleDetector_update (
+    CycleDetector *this,
+    uint64_t hash
+) {
+    this->countdown = CYCLE_DETECTOR_INTERVAL;
+    this->steps++;
+
+    if (hash == this->hash) {
+        this->length = this->steps * CYCLE_DETECTOR_INTERVAL;
+        return true;
+    }
+
+    if (this->steps == this->power && this->power < CYCLE_DETECTOR_MAX_LENGTH) {
+        // Save the current state and wait twice longer for it
+        this->hash  = hash;
+        this->power <<= 1;
+        this->steps = 0;
+    }
+
+    return false;
+}
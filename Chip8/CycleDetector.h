@@ -0,0 +1,76 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+// The state is hashed once every CYCLE_DETECTOR_INTERVAL frames : a cycle of L frames
+// is then found as a cycle of a multiple of L frames, which repeats the states as well.
+#define CYCLE_DETECTOR_INTERVAL 8
+
+// Longest cycle detected, in hashes compared. Longer loops are considered as progress.
+#define CYCLE_DETECTOR_MAX_LENGTH (1 << 16)
+
+// ------ Structure declaration -------
+
+/*
+ *    Detects a machine running in circles (attract mode, dead loop) from the hashes of its
+ *    whole state while the input doesn't change (Brent's algorithm) : the hash saved is
+ *    compared to the next ones, and replaced each time the number of hashes compared
+ *    reaches a power of two. It needs no history and one compare per hash.
+ */
+typedef struct _CycleDetector
+{
+    // Hash of the state saved
+    uint64_t hash;
+
+    // Frames before the next hash
+    uint32_t countdown;
+
+    // Hashes since the state saved, and hashes to wait before saving a new one
+    uint32_t steps;
+    uint32_t power;
+
+    // Length of the cycle found (in frames), 0 until a cycle is found
+    uint32_t length;
+
+}   CycleDetector;
+
+
+// ----------- Functions ------------
+
+/*
+ * Description : Start a new detection from a state, e.g. when the input changes
+ * CycleDetector *this : A CycleDetector
+ * uint64_t hash : Hash of the current state (Cpu_hashState)
+ * Return : void
+ */
+void
+CycleDetector_reset (
+    CycleDetector *this,
+    uint64_t hash
+);
+
+/*
+ * Description : Count one more frame emulated
+ * CycleDetector *this : A CycleDetector
+ * Return : bool, true when the state must be hashed and given to CycleDetector_update
+ */
+bool
+CycleDetector_isDue (
+    CycleDetector *this
+);
+
+/*
+ * Description : Feed the hash of the state, when CycleDetector_isDue asks for it
+ * CycleDetector *this : A CycleDetector
+ * uint64_t hash : Hash of the current state (Cpu_hashState)
+ * Return : bool, true when the state already happened : the machine is in a cycle of "length" frames
+ */
+bool
+CycleDetector_update (
+    CycleDetector *this,
+    uint64_t hash
+);
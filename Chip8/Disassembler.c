@@ -0,0 +1,239 @@
+#include "Disassembler.h"
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "Disassembler"
+#include "dbg/dbg.h"
+
+// Operands of the templates, replaced by the fields of the opcode
+enum {
+    OPERAND_VX = 1, OPERAND_VY, OPERAND_NNN, OPERAND_NN, OPERAND_N, OPERAND_OPCODE
+};
+#define _VX_ "\x01"
+#define _VY_ "\x02"
+#define NNN_ "\x03"
+#define NN__ "\x04"
+#define N___ "\x05"
+#define OPCD "\x06"
+
+
+/*
+ * Get the template of the text of an opcode
+ */
+static const char *
+Disassembler_getTemplate (
+    uint16_t opcode
+) {
+    switch (opcode >> 12)
+    {
+        case 0:
+        switch (opcode & 0xfff)
+        {
+            case 0xe0:  return "CLS          ; Clear screen";
+            case 0xee:  return "RET          ; Return from subroutine call";
+            case 0xfb:  return "SCR           ; Scroll right";
+            case 0xfc:  return "SCL           ; Scroll left";
+            case 0xfd:  return "EXIT          ; Terminate the interpreter";
+            case 0xfe:  return "LOW           ; Disable extended screen mode";
+            case 0xff:  return "HIGH          ; Enable extended screen mode";
+            default:    return "SYS  " NNN_ "     ; Unknown system call";
+        }
+
+        case 1:     return "JP   " NNN_ "     ; Jump to address";
+        case 2:     return "CALL " NNN_ "     ; Call subroutine";
+        case 3:     return "SE   " _VX_ "," NN__ "   ; Skip if register == constant";
+        case 4:     return "SNE  " _VX_ "," NN__ "   ; Skip if register <> constant";
+        case 5:     return "SE   " _VX_ "," _VY_ "   ; Skip if register == register";
+        case 6:     return "LD   " _VX_ "," NN__ "   ; Set VX = Byte";
+        case 7:     return "ADD  " _VX_ "," NN__ "   ; Set VX = VX + Byte";
+
+        case 8:
+        switch (opcode & 0x0f)
+        {
+            case 0:     return "LD   " _VX_ "," _VY_ "   ; Set VX = VY, VF updates";
+            case 1:     return "OR   " _VX_ "," _VY_ "   ; Set VX = VX | VY, VF updates";
+            case 2:     return "AND  " _VX_ "," _VY_ "   ; Set VX = VX & VY, VF updates";
+            case 3:     return "XOR  " _VX_ "," _VY_ "   ; Set VX = VX ^ VY, VF updates";
+            case 4:     return "ADD  " _VX_ "," _VY_ "   ; Set VX = VX + VY, VF = carry";
+            case 5:     return "SUB  " _VX_ "," _VY_ "   ; Set VX = VX - VY, VF = !borrow";
+            case 6:     return "SHR  " _VX_ "," _VY_ "   ; Set VX = VX >> 1, VF = carry";
+            case 7:     return "SUBN " _VX_ "," _VY_ "   ; Set VX = VY - VX, VF = !borrow";
+            case 14:    return "SHL  " _VX_ "," _VY_ "   ; Set VX = VX << 1, VF = carry";
+            default:    return "Illegal opcode";
+        }
+
+        case 9:     return "SNE  " _VX_ "," _VY_ "   ; Skip next instruction iv VX!=VY";
+        case 10:    return "LD   I," NNN_ "   ; Set I = Addr";
+        case 11:    return "JP   V0," NNN_ "  ; Jump to Addr + V0";
+        case 12:    return "RND  " _VX_ "," NN__ "   ; Set VX = random & Byte";
+        case 13:    return "DRW  " _VX_ "," _VY_ "," N___ " ; Draw n byte sprite stored at [i] at VX,VY.";
+
+        case 14:
+        switch (opcode & 0xff)
+        {
+            case 0x9e:  return "SKP  " _VX_ "      ; Skip next instruction if key VX down";
+            case 0xa1:  return "SKNP " _VX_ "      ; Skip next instruction if key VX up";
+            default:    return OPCD "        ; Illegal opcode";
+        }
+
+        default:
+        switch (opcode & 0xff)
+        {
+            case 0x07:  return "LD   " _VX_ ",DT   ; Set VX = delaytimer";
+            case 0x0a:  return "LD   " _VX_ ",K    ; Set VX = key, wait for keypress";
+            case 0x15:  return "LD   DT," _VX_ "   ; Set delaytimer = VX";
+            case 0x18:  return "LD   ST," _VX_ "   ; Set soundtimer = VX";
+            case 0x1e:  return "ADD  I," _VX_ "    ; Set I = I + VX";
+            case 0x29:  return "LD  LF," _VX_ "    ; Point I to 5 byte numeric sprite for value in VX";
+            case 0x30:  return "LD  HF," _VX_ "    ; Point I to 10 byte numeric sprite for value in VX";
+            case 0x33:  return "LD   B," _VX_ "    ; Store BCD of VX in [I], [I+1], [I+2]";
+            case 0x55:  return "LD   [I]," _VX_ "  ; Store V0..VX in [I]..[I+X]";
+            case 0x65:  return "LD   " _VX_ ",[I]  ; Read V0..VX from [I]..[I+X]";
+            case 0x75:  return "LD   R," _VX_ "    ; Store V0..VX in RPL user flags (X<=7)";
+            case 0x85:  return "LD   " _VX_ ",R    ; Read V0..VX from RPL user flags (X<=7)";
+            default:    return OPCD "        ; Illegal opcode";
+        }
+    }
+}
+
+
+/*
+ * Write the "digits" last hexadecimal digits of a value
+ */
+static inline char *
+Disassembler_writeHex (
+    char *output,
+    uint16_t value,
+    int digits
+) {
+    static const char hex [] = "0123456789ABCDEF";
+
+    for (int digit = digits - 1; digit >= 0; digit--) {
+        *output++ = hex[(value >> (digit * 4)) & 0xF];
+    }
+
+    return output;
+}
+
+
+/*
+ * Description : Write the mnemonic of an opcode and its comment, e.g. "JP   2A4     ; Jump to address".
+ *               No printf : the operands are written digit by digit, it is cheap enough for whole ROMs.
+ * uint16_t opcode : The opcode to disassemble
+ * char *buffer : Where the text is written, at least DISASSEMBLER_TEXT_SIZE bytes
+ * Return : int the length of the text
+ */
+int
+Disassembler_format (
+    uint16_t opcode,
+    char *buffer
+) {
+    const char *template = Disassembler_getTemplate (opcode);
+    char *output = buffer;
+
+    for (; *template; template++) {
+        switch (*template)
+        {
+            case OPERAND_VX:
+                *output++ = 'V';
+                output = Disassembler_writeHex (output, opcode >> 8, 1);
+            break;
+
+            case OPERAND_VY:
+                *output++ = 'V';
+                output = Disassembler_writeHex (output, opcode >> 4, 1);
+            break;
+
+            case OPERAND_NNN:    output = Disassembler_writeHex (output, opcode, 3); break;
+            case OPERAND_NN:     output = Disassembler_writeHex (output, opcode, 2); break;
+            case OPERAND_N:      output = Disassembler_writeHex (output, opcode, 1); break;
+            case OPERAND_OPCODE: output = Disassembler_writeHex (output, opcode, 4); break;
+
+            default:
+                *output++ = *template;
+            break;
+        }
+    }
+
+    *output = '\0';
+
+    return output - buffer;
+}
+
+
+/*
+ * Description : Get the class of an opcode
+ * uint16_t opcode : The opcode
+ * Return : OpcodeClass the class of the opcode
+ */
+OpcodeClass
+Disassembler_getClass (
+    uint16_t opcode
+) {
+    static const OpcodeClass aluClasses [16] = {
+        OPCODE_8XY0, OPCODE_8XY1, OPCODE_8XY2, OPCODE_8XY3, OPCODE_8XY4, OPCODE_8XY5, OPCODE_8XY6, OPCODE_8XY7,
+        OPCODE_UNKNOWN, OPCODE_UNKNOWN, OPCODE_UNKNOWN, OPCODE_UNKNOWN, OPCODE_UNKNOWN, OPCODE_UNKNOWN, OPCODE_8XYE, OPCODE_UNKNOWN
+    };
+
+    switch (opcode >> 12)
+    {
+        case 0x0:
+            if (opcode == 0x00E0) return OPCODE_00E0;
+            if (opcode == 0x00EE) return OPCODE_00EE;
+            return (opcode & 0x0F00) ? OPCODE_0NNN : OPCODE_UNKNOWN;
+
+        case 0x1: return OPCODE_1NNN;
+        case 0x2: return OPCODE_2NNN;
+        case 0x3: return OPCODE_3XNN;
+        case 0x4: return OPCODE_4XNN;
+        case 0x5: return OPCODE_5XY0;
+        case 0x6: return OPCODE_6XNN;
+        case 0x7: return OPCODE_7XNN;
+        case 0x8: return aluClasses[opcode & 0xF];
+        case 0x9: return OPCODE_9XY0;
+        case 0xA: return OPCODE_ANNN;
+        case 0xB: return OPCODE_BNNN;
+        case 0xC: return OPCODE_CXNN;
+        case 0xD: return OPCODE_DXYN;
+
+        case 0xE:
+            if ((opcode & 0xFF) == 0x9E) return OPCODE_EX9E;
+            if ((opcode & 0xFF) == 0xA1) return OPCODE_EXA1;
+            return OPCODE_UNKNOWN;
+
+        default:
+            switch (opcode & 0xFF) {
+                case 0x07: return OPCODE_FX07;
+                case 0x0A: return OPCODE_FX0A;
+                case 0x15: return OPCODE_FX15;
+                case 0x18: return OPCODE_FX18;
+                case 0x1E: return OPCODE_FX1E;
+                case 0x29: return OPCODE_FX29;
+                case 0x33: return OPCODE_FX33;
+                case 0x55: return OPCODE_FX55;
+                case 0x65: return OPCODE_FX65;
+            }
+            return OPCODE_UNKNOWN;
+    }
+}
+
+
+/*
+ * Description : Get the name of a class of opcodes, e.g. "8XY4"
+ * OpcodeClass class : A class of opcodes
+ * Return : char * the name of the class
+ */
+char *
+Disassembler_getClassName (
+    OpcodeClass class
+) {
+    char *names [] = {
+        "00E0", "00EE", "0NNN",
+        "1NNN", "2NNN", "3XNN", "4XNN", "5XY0", "6XNN", "7XNN",
+        "8XY0", "8XY1", "8XY2", "8XY3", "8XY4", "8XY5", "8XY6", "8XY7", "8XYE",
+        "9XY0", "ANNN", "BNNN", "CXNN", "DXYN", "EX9E", "EXA1",
+        "FX07", "FX0A", "FX15", "FX18", "FX1E", "FX29", "FX33", "FX55", "FX65",
+        "????",
+    };
+
+    return (class < opcodeClassCount) ? names[class] : "????";
+}
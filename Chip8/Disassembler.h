@@ -0,0 +1,57 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define DISASSEMBLER_TEXT_SIZE 80 // Enough for the longest instruction, with its comment
+
+// Classes of opcodes, one per instruction of Cpu_executeOpcode
+typedef enum {
+    OPCODE_00E0, OPCODE_00EE, OPCODE_0NNN,
+    OPCODE_1NNN, OPCODE_2NNN, OPCODE_3XNN, OPCODE_4XNN, OPCODE_5XY0, OPCODE_6XNN, OPCODE_7XNN,
+    OPCODE_8XY0, OPCODE_8XY1, OPCODE_8XY2, OPCODE_8XY3, OPCODE_8XY4, OPCODE_8XY5, OPCODE_8XY6, OPCODE_8XY7, OPCODE_8XYE,
+    OPCODE_9XY0, OPCODE_ANNN, OPCODE_BNNN, OPCODE_CXNN, OPCODE_DXYN, OPCODE_EX9E, OPCODE_EXA1,
+    OPCODE_FX07, OPCODE_FX0A, OPCODE_FX15, OPCODE_FX18, OPCODE_FX1E, OPCODE_FX29, OPCODE_FX33, OPCODE_FX55, OPCODE_FX65,
+    OPCODE_UNKNOWN,
+
+    opcodeClassCount // Always at the end
+} OpcodeClass;
+
+
+// ----------- Functions ------------
+
+/*
+ * Description : Write the mnemonic of an opcode and its comment, e.g. "JP   2A4     ; Jump to address".
+ *               No printf : the operands are written digit by digit, it is cheap enough for whole ROMs.
+ * uint16_t opcode : The opcode to disassemble
+ * char *buffer : Where the text is written, at least DISASSEMBLER_TEXT_SIZE bytes
+ * Return : int the length of the text
+ */
+int
+Disassembler_format (
+    uint16_t opcode,
+    char *buffer
+);
+
+/*
+ * Description : Get the class of an opcode
+ * uint16_t opcode : The opcode
+ * Return : OpcodeClass the class of the opcode
+ */
+OpcodeClass
+Disassembler_getClass (
+    uint16_t opcode
+);
+
+/*
+ * Description : Get the name of a class of opcodes, e.g. "8XY4"
+ * OpcodeClass class : A class of opcodes
+ * Return : char * the name of the class
+ */
+char *
+Disassembler_getClassName (
+    OpcodeClass class
+);
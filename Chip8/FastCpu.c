@@ -0,0 +1,411 @@
+#include "FastCpu.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "FastCpu"
+#include "dbg/dbg.h"
+
+// Macro helpers
+#define VX this->V[insn->x]
+#define VY this->V[insn->y]
+#define VF this->V[0x0F]
+
+
+// ---------- Handlers -------------
+// Each handler is the case of Cpu_executeOpcode with the same name, IP already points to the next opcode.
+
+static void
+FastCpu_unknown (Cpu *this, CpuDecodedInsn *insn) {
+    Cpu_unknownOpcode (this);
+}
+
+static void
+FastCpu_rcaCall (Cpu *this, CpuDecodedInsn *insn) {
+    Cpu_raiseFault (this, CPU_FAULT_RCA_CALL);
+}
+
+static void
+FastCpu_00E0 (Cpu *this, CpuDecodedInsn *insn) {
+    Screen_clear (this->screen);
+    if (this->latency) {
+        InputLatency_publish (this->latency);
+    }
+}
+
+static void
+FastCpu_00EE (Cpu *this, CpuDecodedInsn *insn) {
+    this->ip = Cpu_stackPop (this);
+}
+
+static void
+FastCpu_1NNN (Cpu *this, CpuDecodedInsn *insn) {
+    this->ip = insn->nnn;
+}
+
+static void
+FastCpu_2NNN (Cpu *this, CpuDecodedInsn *insn) {
+    Cpu_stackPush (this, this->ip);
+    this->ip = insn->nnn;
+}
+
+static void
+FastCpu_3XNN (Cpu *this, CpuDecodedInsn *insn) {
+    if (VX == insn->nn) {
+        this->ip += INSN_SIZE;
+    }
+}
+
+static void
+FastCpu_4XNN (Cpu *this, CpuDecodedInsn *insn) {
+    if (VX != insn->nn) {
+        this->ip += INSN_SIZE;
+    }
+}
+
+static void
+FastCpu_5XY0 (Cpu *this, CpuDecodedInsn *insn) {
+    if (VX == VY) {
+        this->ip += INSN_SIZE;
+    }
+}
+
+static void
+FastCpu_6XNN (Cpu *this, CpuDecodedInsn *insn) {
+    VX = insn->nn;
+}
+
+static void
+FastCpu_7XNN (Cpu *this, CpuDecodedInsn *insn) {
+    VX += insn->nn;
+}
+
+static void
+FastCpu_8XY0 (Cpu *this, CpuDecodedInsn *insn) {
+    VX = VY;
+}
+
+static void
+FastCpu_8XY1 (Cpu *this, CpuDecodedInsn *insn) {
+    VX |= VY;
+}
+
+static void
+FastCpu_8XY2 (Cpu *this, CpuDecodedInsn *insn) {
+    VX &= VY;
+}
+
+static void
+FastCpu_8XY3 (Cpu *this, CpuDecodedInsn *insn) {
+    VX ^= VY;
+}
+
+// VF is written before VX in the 8XY* handlers, as in Cpu_executeOpcode : it matters when X or Y is F.
+static void
+FastCpu_8XY4 (Cpu *this, CpuDecodedInsn *insn) {
+    VF = ((int) VX + VY) > 0xFF;
+    VX += VY;
+}
+
+static void
+FastCpu_8XY5 (Cpu *this, CpuDecodedInsn *insn) {
+    VF = ((int) VX - VY) < 0;
+    VX -= VY;
+}
+
+static void
+FastCpu_8XY6 (Cpu *this, CpuDecodedInsn *insn) {
+    VF = VX & 1;
+    VX >>= 1;
+}
+
+static void
+FastCpu_8XY7 (Cpu *this, CpuDecodedInsn *insn) {
+    VF = ((int) VY - VX) < 0;
+    VX = VY - VX;
+}
+
+static void
+FastCpu_8XYE (Cpu *this, CpuDecodedInsn *insn) {
+    VF = VX >= 0x80;
+    VX <<= 1;
+}
+
+static void
+FastCpu_9XY0 (Cpu *this, CpuDecodedInsn *insn) {
+    if (VX != VY) {
+        this->ip += INSN_SIZE;
+    }
+}
+
+static void
+FastCpu_ANNN (Cpu *this, CpuDecodedInsn *insn) {
+    this->I = insn->nnn;
+}
+
+static void
+FastCpu_BNNN (Cpu *this, CpuDecodedInsn *insn) {
+    this->ip = insn->nnn + this->V[0];
+}
+
+static void
+FastCpu_CXNN (Cpu *this, CpuDecodedInsn *insn) {
+    VX = (Cpu_random (this) >> 7) & insn->nn;
+}
+
+static void
+FastCpu_DXYN (Cpu *this, CpuDecodedInsn *insn) {
+    if (!Cpu_checkMemoryAccess (this, this->I, (insn->n) ? insn->n : 16)) {
+        return;
+    }
+
+    VF = Screen_drawSprite (this->screen, VX, VY, insn->n, this->memory, this->I);
+    if (this->latency) {
+        InputLatency_publish (this->latency);
+    }
+}
+
+static void
+FastCpu_EX9E (Cpu *this, CpuDecodedInsn *insn) {
+    if (this->keys[VX & 0xF] == KEY_PRESSED) {
+        this->ip += INSN_SIZE;
+        if (this->latency) {
+            InputLatency_observe (this->latency, VX & 0xF);
+        }
+    }
+}
+
+static void
+FastCpu_EXA1 (Cpu *this, CpuDecodedInsn *insn) {
+    if (this->keys[VX & 0xF] == KEY_RELEASED) {
+        this->ip += INSN_SIZE;
+    }
+    else if (this->latency) {
+        InputLatency_observe (this->latency, VX & 0xF);
+    }
+}
+
+static void
+FastCpu_FX07 (Cpu *this, CpuDecodedInsn *insn) {
+    VX = this->delayTimer;
+}
+
+static void
+FastCpu_FX0A (Cpu *this, CpuDecodedInsn *insn) {
+    for (C8KeyCode code = 0; code < keyCodeCount; code++) {
+        if (this->keys[code] == KEY_PRESSED) {
+            VX = code;
+            this->keys[code] = KEY_PUSHED;
+            if (this->latency) {
+                InputLatency_observe (this->latency, code);
+            }
+            return;
+        }
+    }
+
+    // Wait on this instruction until a key is pressed
+    this->ip -= INSN_SIZE;
+}
+
+static void
+FastCpu_FX15 (Cpu *this, CpuDecodedInsn *insn) {
+    this->delayTimer = VX;
+}
+
+static void
+FastCpu_FX18 (Cpu *this, CpuDecodedInsn *insn) {
+    this->soundTimer = VX;
+}
+
+static void
+FastCpu_FX1E (Cpu *this, CpuDecodedInsn *insn) {
+    this->I += VX;
+}
+
+static void
+FastCpu_FX29 (Cpu *this, CpuDecodedInsn *insn) {
+    this->I = 5 * (VX & 0xF);
+}
+
+static void
+FastCpu_FX33 (Cpu *this, CpuDecodedInsn *insn) {
+    if (!Cpu_checkMemoryAccess (this, this->I, 3)) {
+        return;
+    }
+
+    Cpu_writeMemory (this, this->I,      VX / 100);
+    Cpu_writeMemory (this, this->I + 1, (VX / 10)  % 10);
+    Cpu_writeMemory (this, this->I + 2,  VX % 10);
+}
+
+static void
+FastCpu_FX55 (Cpu *this, CpuDecodedInsn *insn) {
+    if (!Cpu_checkMemoryAccess (this, this->I, insn->x + 1)) {
+        return;
+    }
+
+    for (int pos = 0; pos <= insn->x; pos++) {
+        Cpu_writeMemory (this, this->I + pos, this->V[pos]);
+    }
+}
+
+static void
+FastCpu_FX65 (Cpu *this, CpuDecodedInsn *insn) {
+    if (!Cpu_checkMemoryAccess (this, this->I, insn->x + 1)) {
+        return;
+    }
+
+    memcpy (this->V, &this->memory[this->I], insn->x + 1);
+}
+
+#undef VX
+#undef VY
+#undef VF
+
+
+// ---------- Decoding -------------
+
+static CpuInsnHandler aluHandlers [16] = {
+    [0x0] = FastCpu_8XY0, [0x1] = FastCpu_8XY1, [0x2] = FastCpu_8XY2, [0x3] = FastCpu_8XY3,
+    [0x4] = FastCpu_8XY4, [0x5] = FastCpu_8XY5, [0x6] = FastCpu_8XY6, [0x7] = FastCpu_8XY7,
+    [0xE] = FastCpu_8XYE,
+};
+
+/*
+ * Description : Get the handler of an opcode
+ * uint16_t opcode : The opcode
+ * Return : CpuInsnHandler the handler executing the opcode
+ */
+static CpuInsnHandler
+FastCpu_getHandler (
+    uint16_t opcode
+) {
+    CpuInsnHandler handler = NULL;
+
+    switch (opcode >> 12)
+    {
+        case 0x0:
+            if      (opcode == 0x00E0)        handler = FastCpu_00E0;
+            else if (opcode == 0x00EE)        handler = FastCpu_00EE;
+            else if ((opcode & 0x0F00) != 0)  handler = FastCpu_rcaCall;
+        break;
+
+        case 0x1: handler = FastCpu_1NNN; break;
+        case 0x2: handler = FastCpu_2NNN; break;
+        case 0x3: handler = FastCpu_3XNN; break;
+        case 0x4: handler = FastCpu_4XNN; break;
+        case 0x5: handler = FastCpu_5XY0; break;
+        case 0x6: handler = FastCpu_6XNN; break;
+        case 0x7: handler = FastCpu_7XNN; break;
+        case 0x8: handler = aluHandlers[opcode & 0xF]; break;
+        case 0x9: handler = FastCpu_9XY0; break;
+        case 0xA: handler = FastCpu_ANNN; break;
+        case 0xB: handler = FastCpu_BNNN; break;
+        case 0xC: handler = FastCpu_CXNN; break;
+        case 0xD: handler = FastCpu_DXYN; break;
+
+        case 0xE:
+            if      ((opcode & 0xFF) == 0x9E) handler = FastCpu_EX9E;
+            else if ((opcode & 0xFF) == 0xA1) handler = FastCpu_EXA1;
+        break;
+
+        case 0xF:
+            switch (opcode & 0xFF) {
+                case 0x07: handler = FastCpu_FX07; break;
+                case 0x0A: handler = FastCpu_FX0A; break;
+                case 0x15: handler = FastCpu_FX15; break;
+                case 0x18: handler = FastCpu_FX18; break;
+                case 0x1E: handler = FastCpu_FX1E; break;
+                case 0x29: handler = FastCpu_FX29; break;
+                case 0x33: handler = FastCpu_FX33; break;
+                case 0x55: handler = FastCpu_FX55; break;
+                case 0x65: handler = FastCpu_FX65; break;
+            }
+        break;
+    }
+
+    return (handler) ? handler : FastCpu_unknown;
+}
+
+
+/*
+ * Description : Decode the instruction at an address
+ * Cpu *this : An allocated Cpu using the fast engine
+ * uint16_t ip : Address of the instruction
+ * Return : CpuDecodedInsn * the instruction decoded
+ */
+CpuDecodedInsn *
+FastCpu_decode (
+    Cpu *this,
+    uint16_t ip
+) {
+    CpuDecodedInsn *insn = &this->decoded[ip];
+    uint16_t opcode = Cpu_fetchOpcode (this, ip);
+
+    insn->opcode  = opcode;
+    insn->nnn     = opcode & 0x0FFF;
+    insn->nn      = opcode & 0x00FF;
+    insn->n       = opcode & 0x000F;
+    insn->x       = (opcode & 0x0F00) >> 8;
+    insn->y       = (opcode & 0x00F0) >> 4;
+    insn->handler = FastCpu_getHandler (opcode);
+
+    return insn;
+}
+
+
+/*
+ * Description : Emulate a CPU cycle with the fast engine
+ * Cpu *this : An allocated Cpu using the fast engine
+ * Return : void
+ */
+void
+FastCpu_emulateCycle (
+    Cpu *this
+) {
+    uint16_t ip = this->ip;
+
+    if (ip > MEMORY_SIZE - INSN_SIZE) {
+        Cpu_raiseFault (this, CPU_FAULT_MEMORY_ACCESS);
+        return;
+    }
+
+    CpuDecodedInsn *insn = &this->decoded[ip];
+    if (insn->handler == NULL || insn->opcode != ((this->memory[ip] << 8) | this->memory[ip + 1])) {
+        insn = FastCpu_decode (this, ip);
+    }
+
+    if (this->trace) {
+        CpuTrace_record (this->trace, ip, insn->opcode, this->I, this->V[insn->x], this->V[insn->y]);
+    }
+
+    this->opcode = insn->opcode;
+    this->ip = ip + INSN_SIZE;
+
+    #ifdef CPU_OPCODE_STATS
+    uint64_t startClock = OpcodeStats_readClock ();
+    #endif
+
+    insn->handler (this, insn);
+
+    #ifdef CPU_OPCODE_STATS
+    OpcodeStats_record (insn->opcode, startClock);
+    #endif
+}
+
+
+/*
+ * Description : Emulate a frame with the fast engine : "speed" CPU cycles followed by a timers update.
+ * Cpu *this : An allocated Cpu using the fast engine
+ * Return : void
+ */
+void
+FastCpu_emulateFrame (
+    Cpu *this
+) {
+    for (int cycle = 0; cycle < this->speed && this->isRunning; cycle++) {
+        FastCpu_emulateCycle (this);
+    }
+
+    Cpu_updateTimers (this);
+}
+
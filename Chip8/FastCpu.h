@@ -0,0 +1,65 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "CPU.h"
+#include <stdint.h>
+
+// ------ Structure declaration -------
+
+/*
+ *    The fast engine decodes each instruction once, the first time it is executed, into its
+ *    handler and operands. The decoded instructions are indexed by their address and keep
+ *    their opcode : an instruction is decoded again when the memory under it doesn't hold
+ *    this opcode anymore (self-modifying code, save states), so nothing has to be invalidated.
+ */
+typedef void (*CpuInsnHandler) (Cpu *this, CpuDecodedInsn *insn);
+
+struct _CpuDecodedInsn
+{
+    // Handler executing the instruction, NULL until the instruction is decoded
+    CpuInsnHandler handler;
+
+    uint16_t opcode;
+    uint16_t nnn;
+    uint8_t nn;
+    uint8_t n;
+    uint8_t x;
+    uint8_t y;
+};
+
+
+
+// ----------- Functions ------------
+
+/*
+ * Description : Decode the instruction at an address
+ * Cpu *this : An allocated Cpu using the fast engine
+ * uint16_t ip : Address of the instruction
+ * Return : CpuDecodedInsn * the instruction decoded
+ */
+CpuDecodedInsn *
+FastCpu_decode (
+    Cpu *this,
+    uint16_t ip
+);
+
+/*
+ * Description : Emulate a CPU cycle with the fast engine
+ * Cpu *this : An allocated Cpu using the fast engine
+ * Return : void
+ */
+void
+FastCpu_emulateCycle (
+    Cpu *this
+);
+
+/*
+ * Description : Emulate a frame with the fast engine : "speed" CPU cycles followed by a timers update.
+ * Cpu *this : An allocated Cpu using the fast engine
+ * Return : void
+ */
+void
+FastCpu_emulateFrame (
+    Cpu *this
+);
@@ -0,0 +1,269 @@
+#include "GuestProfiler.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "GuestProfiler"
+#include "dbg/dbg.h"
+
+/*
+ * Description     : Allocate a new GuestProfiler structure.
+ * Return        : A pointer to an allocated GuestProfiler.
+ */
+GuestProfiler *
+GuestProfiler_new (void)
+{
+    GuestProfiler *this;
+
+    if ((this = calloc (1, sizeof(GuestProfiler))) == NULL)
+        return NULL;
+
+    if (!GuestProfiler_init (this)) {
+        GuestProfiler_free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+
+/*
+ * Description : Initialize an allocated GuestProfiler structure.
+ * GuestProfiler *this : An allocated GuestProfiler to initialize.
+ * Return : true on success, false on failure.
+ */
+bool
+GuestProfiler_init (
+    GuestProfiler *this
+) {
+    this->nodesCapacity = 64;
+
+    if ((this->nodes = malloc (this->nodesCapacity * sizeof(GuestProfilerNode))) == NULL) {
+        return false;
+    }
+
+    this->nodes[GUEST_PROFILER_ROOT] = (GuestProfilerNode) {
+        .address = 0, .parent = -1, .firstChild = -1, .nextSibling = -1, .selfCount = 0
+    };
+    this->nodesCount = 1;
+    this->current = GUEST_PROFILER_ROOT;
+
+    return true;
+}
+
+
+/*
+ * Description : Get the child of the current node for a subroutine, and create it if needed
+ * GuestProfiler *this : An allocated GuestProfiler
+ * uint16_t address : Address of the subroutine
+ * Return : int the index of the child, the current node when out of memory
+ */
+static int
+GuestProfiler_enter (
+    GuestProfiler *this,
+    uint16_t address
+) {
+    int child;
+
+    for (child = this->nodes[this->current].firstChild; child != -1; child = this->nodes[child].nextSibling) {
+        if (this->nodes[child].address == address) {
+            return child;
+        }
+    }
+
+    if (this->nodesCount == this->nodesCapacity) {
+        GuestProfilerNode *nodes = realloc (this->nodes, 2 * this->nodesCapacity * sizeof(GuestProfilerNode));
+        if (nodes == NULL) {
+            return this->current;
+        }
+        this->nodes = nodes;
+        this->nodesCapacity *= 2;
+    }
+
+    child = this->nodesCount++;
+    this->nodes[child] = (GuestProfilerNode) {
+        .address     = address,
+        .parent      = this->current,
+        .firstChild  = -1,
+        .nextSibling = this->nodes[this->current].firstChild,
+        .selfCount   = 0
+    };
+    this->nodes[this->current].firstChild = child;
+
+    return child;
+}
+
+
+/*
+ * Description : Count an instruction about to be executed
+ * GuestProfiler *this : An allocated GuestProfiler
+ * uint16_t ip : Address of the instruction
+ * Return : void
+ */
+void
+GuestProfiler_record (
+    GuestProfiler *this,
+    uint16_t ip
+) {
+    if (this->isCalling) {
+        this->current = GuestProfiler_enter (this, ip);
+        this->isCalling = false;
+    }
+
+    this->addressCounts[ip & (GUEST_PROFILER_ADDRESSES - 1)]++;
+    this->nodes[this->current].selfCount++;
+    this->instructionsCount++;
+}
+
+
+/*
+ * Description : A return address has been pushed by a CALL
+ * GuestProfiler *this : An allocated GuestProfiler
+ * Return : void
+ */
+void
+GuestProfiler_call (
+    GuestProfiler *this
+) {
+    this->isCalling = true;
+}
+
+
+/*
+ * Description : A return address has been popped by a RET
+ * GuestProfiler *this : An allocated GuestProfiler
+ * Return : void
+ */
+void
+GuestProfiler_return (
+    GuestProfiler *this
+) {
+    // A stack restored by a save state can return above the root
+    if (this->nodes[this->current].parent != -1) {
+        this->current = this->nodes[this->current].parent;
+    }
+}
+
+
+/*
+ * Description : Write the call stack of a node, from the root
+ */
+static void
+GuestProfiler_writeStack (
+    GuestProfiler *this,
+    int node,
+    FILE *output
+) {
+    if (node == GUEST_PROFILER_ROOT) {
+        fprintf (output, "main");
+        return;
+    }
+
+    GuestProfiler_writeStack (this, this->nodes[node].parent, output);
+    fprintf (output, ";sub_%03X", this->nodes[node].address);
+}
+
+
+/*
+ * Description : Write the call stacks in the folded format of the flamegraph tools :
+ *               "main;sub_2A4;sub_31C <instructions>" per line
+ * GuestProfiler *this : An allocated GuestProfiler
+ * FILE *output : Where the stacks are written
+ * Return : void
+ */
+void
+GuestProfiler_writeFolded (
+    GuestProfiler *this,
+    FILE *output
+) {
+    for (int node = 0; node < this->nodesCount; node++) {
+        if (this->nodes[node].selfCount > 0) {
+            GuestProfiler_writeStack (this, node, output);
+            fprintf (output, " %llu\n", (unsigned long long) this->nodes[node].selfCount);
+        }
+    }
+}
+
+
+// Sorting helpers of the report
+static uint64_t *sortedCounts = NULL;
+
+static int
+GuestProfiler_compareCounts (const void *a, const void *b) {
+    uint64_t x = sortedCounts[*(uint16_t *) a];
+    uint64_t y = sortedCounts[*(uint16_t *) b];
+    return (x < y) - (x > y);
+}
+
+
+/*
+ * Description : Print the addresses and the subroutines executing the most instructions
+ * GuestProfiler *this : An allocated GuestProfiler
+ * uint8_t *memory : Memory of the guest, to show the opcodes
+ * int count : Number of addresses and subroutines shown
+ * Return : void
+ */
+void
+GuestProfiler_report (
+    GuestProfiler *this,
+    uint8_t *memory,
+    int count
+) {
+    static uint64_t selfCounts [GUEST_PROFILER_ADDRESSES];
+    static uint16_t addresses [GUEST_PROFILER_ADDRESSES];
+    double total = (this->instructionsCount) ? this->instructionsCount : 1;
+
+    for (int address = 0; address < GUEST_PROFILER_ADDRESSES; address++) {
+        addresses[address] = address;
+        selfCounts[address] = 0;
+    }
+
+    // Subroutines : instructions of all their call stacks, the entry of the program is its own routine
+    for (int node = 0; node < this->nodesCount; node++) {
+        selfCounts[this->nodes[node].address & (GUEST_PROFILER_ADDRESSES - 1)] += this->nodes[node].selfCount;
+    }
+
+    sortedCounts = this->addressCounts;
+    qsort (addresses, GUEST_PROFILER_ADDRESSES, sizeof(uint16_t), GuestProfiler_compareCounts);
+
+    printf ("%llu instructions\n\nHot addresses :\n", (unsigned long long) this->instructionsCount);
+    for (int i = 0; i < count && this->addressCounts[addresses[i]]; i++) {
+        uint16_t address = addresses[i];
+        uint16_t opcode = (address < GUEST_PROFILER_ADDRESSES - 1) ? (memory[address] << 8) | memory[address + 1] : 0;
+        printf ("  %03X  %04X  %12llu  %6.2f%%\n", address, opcode,
+            (unsigned long long) this->addressCounts[address], this->addressCounts[address] * 100 / total);
+    }
+
+    for (int address = 0; address < GUEST_PROFILER_ADDRESSES; address++) {
+        addresses[address] = address;
+    }
+    sortedCounts = selfCounts;
+    qsort (addresses, GUEST_PROFILER_ADDRESSES, sizeof(uint16_t), GuestProfiler_compareCounts);
+    sortedCounts = NULL;
+
+    printf ("\nHot subroutines (instructions executed by the routine itself) :\n");
+    for (int i = 0; i < count && selfCounts[addresses[i]]; i++) {
+        uint16_t address = addresses[i];
+        char name [16] = "main";
+        if (address != 0) {
+            sprintf (name, "sub_%03X", address);
+        }
+        printf ("  %-8s  %12llu  %6.2f%%\n",
+            name, (unsigned long long) selfCounts[address], selfCounts[address] * 100 / total);
+    }
+}
+
+
+/*
+ * Description : Free an allocated GuestProfiler structure.
+ * GuestProfiler *this : An allocated GuestProfiler to free.
+ */
+void
+GuestProfiler_free (
+    GuestProfiler *this
+) {
+    if (this != NULL)
+    {
+        free (this->nodes);
+        free (this);
+    }
+}
@@ -0,0 +1,142 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define GUEST_PROFILER_ADDRESSES 0x1000
+#define GUEST_PROFILER_ROOT 0
+
+// ------ Structure declaration -------
+
+/*
+ *    Instructions executed by the guest, per address and per call stack of subroutines.
+ *    The call stacks form a tree : CALL (2NNN) enters the child of the current node for the
+ *    subroutine called, RET (00EE) goes back to its parent. The root is the program entry.
+ */
+typedef struct _GuestProfilerNode
+{
+    // Address of the subroutine
+    uint16_t address;
+
+    // Tree links (indexes of the nodes, -1 when none)
+    int parent;
+    int firstChild;
+    int nextSibling;
+
+    // Instructions executed by this subroutine itself, for this call stack
+    uint64_t selfCount;
+
+}   GuestProfilerNode;
+
+typedef struct _GuestProfiler
+{
+    // Instructions executed at each address
+    uint64_t addressCounts [GUEST_PROFILER_ADDRESSES];
+    uint64_t instructionsCount;
+
+    // Call tree, and the node of the current call stack
+    GuestProfilerNode *nodes;
+    int nodesCount;
+    int nodesCapacity;
+    int current;
+
+    // A CALL happened : the next instruction executed is the entry of the subroutine
+    bool isCalling;
+
+}   GuestProfiler;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Allocate a new GuestProfiler structure.
+ * Return        : A pointer to an allocated GuestProfiler.
+ */
+GuestProfiler *
+GuestProfiler_new (void);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Initialize an allocated GuestProfiler structure.
+ * GuestProfiler *this : An allocated GuestProfiler to initialize.
+ * Return : true on success, false on failure.
+ */
+bool
+GuestProfiler_init (
+    GuestProfiler *this
+);
+
+/*
+ * Description : Count an instruction about to be executed
+ * GuestProfiler *this : An allocated GuestProfiler
+ * uint16_t ip : Address of the instruction
+ * Return : void
+ */
+void
+GuestProfiler_record (
+    GuestProfiler *this,
+    uint16_t ip
+);
+
+/*
+ * Description : A return address has been pushed by a CALL
+ * GuestProfiler *this : An allocated GuestProfiler
+ * Return : void
+ */
+void
+GuestProfiler_call (
+    GuestProfiler *this
+);
+
+/*
+ * Description : A return address has been popped by a RET
+ * GuestProfiler *this : An allocated GuestProfiler
+ * Return : void
+ */
+void
+GuestProfiler_return (
+    GuestProfiler *this
+);
+
+/*
+ * Description : Write the call stacks in the folded format of the flamegraph tools :
+ *               "main;sub_2A4;sub_31C <instructions>" per line
+ * GuestProfiler *this : An allocated GuestProfiler
+ * FILE *output : Where the stacks are written
+ * Return : void
+ */
+void
+GuestProfiler_writeFolded (
+    GuestProfiler *this,
+    FILE *output
+);
+
+/*
+ * Description : Print the addresses and the subroutines executing the most instructions
+ * GuestProfiler *this : An allocated GuestProfiler
+ * uint8_t *memory : Memory of the guest, to show the opcodes
+ * int count : Number of addresses and subroutines shown
+ * Return : void
+ */
+void
+GuestProfiler_report (
+    GuestProfiler *this,
+    uint8_t *memory,
+    int count
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated GuestProfiler structure.
+ * GuestProfiler *this : An allocated GuestProfiler to free.
+ */
+void
+GuestProfiler_free (
+    GuestProfiler *this
+);
@@ -0,0 +1,193 @@
+#include "InputLatency.h"
+#include "Profiler/ProfilerClock.h"
+#include "Profiler/ProfilerFactory.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "InputLatency"
+#include "dbg/dbg.h"
+
+/*
+ * Description     : Allocate a new InputLatency structure.
+ * Return        : A pointer to an allocated InputLatency.
+ */
+InputLatency *
+InputLatency_new (void)
+{
+    InputLatency *this;
+
+    if ((this = calloc (1, sizeof(InputLatency))) == NULL)
+        return NULL;
+
+    if (!InputLatency_init (this)) {
+        InputLatency_free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+
+/*
+ * Description : Initialize an allocated InputLatency structure.
+ * InputLatency *this : An allocated InputLatency to initialize.
+ * Return : true on success, false on failure.
+ */
+bool
+InputLatency_init (
+    InputLatency *this
+) {
+    if (!(this->wakeDelays    = ProfilerFactory_getHistogram ("Key wake"))
+    ||  !(this->observeDelays = ProfilerFactory_getHistogram ("Key to CPU"))
+    ||  !(this->publishDelays = ProfilerFactory_getHistogram ("CPU to publish"))
+    ||  !(this->presentDelays = ProfilerFactory_getHistogram ("Publish to present"))
+    ||  !(this->totalDelays   = ProfilerFactory_getHistogram ("Key to photon"))) {
+        dbg ("Cannot allocate the latency histograms.");
+        return false;
+    }
+
+    this->wakeTime = ProfilerClock_microseconds ();
+
+    return true;
+}
+
+
+/*
+ * Description : Window thread : an event woke the Window up
+ * InputLatency *this : An allocated InputLatency
+ * Return : void
+ */
+void
+InputLatency_wake (
+    InputLatency *this
+) {
+    this->wakeTime = ProfilerClock_microseconds ();
+}
+
+
+/*
+ * Description : Window thread : a key has been pressed
+ * InputLatency *this : An allocated InputLatency
+ * int code : The CHIP-8 key pressed
+ * Return : void
+ */
+void
+InputLatency_press (
+    InputLatency *this,
+    int code
+) {
+    uint64_t now = ProfilerClock_microseconds ();
+
+    // Time spent by the Window since it woke up, before handling this event
+    ProfilerHistogram_record (this->wakeDelays, now - this->wakeTime);
+
+    __atomic_store_n (&this->pressTimes[code], now, __ATOMIC_RELAXED);
+}
+
+
+/*
+ * Description : CPU thread : an instruction read a key pressed
+ * InputLatency *this : An allocated InputLatency
+ * int code : The CHIP-8 key read
+ * Return : void
+ */
+void
+InputLatency_observe (
+    InputLatency *this,
+    int code
+) {
+    // Only the first observation of a press counts
+    uint64_t pressTime = __atomic_exchange_n (&this->pressTimes[code], 0, __ATOMIC_RELAXED);
+
+    if (pressTime == 0) {
+        return;
+    }
+
+    // A press observed earlier without any framebuffer change since is replaced
+    this->observed.pressTime = pressTime;
+    this->observed.observeTime = ProfilerClock_microseconds ();
+}
+
+
+/*
+ * Description : CPU thread : the framebuffer has been changed
+ * InputLatency *this : An allocated InputLatency
+ * Return : void
+ */
+void
+InputLatency_publish (
+    InputLatency *this
+) {
+    if (this->observed.pressTime == 0
+    ||  __atomic_load_n (&this->isPublished, __ATOMIC_ACQUIRE)) {
+        // Nothing observed, or the Screen hasn't taken the previous probe yet
+        return;
+    }
+
+    this->published = this->observed;
+    this->published.publishTime = ProfilerClock_microseconds ();
+    __atomic_store_n (&this->isPublished, true, __ATOMIC_RELEASE);
+
+    this->observed.pressTime = 0;
+}
+
+
+/*
+ * Description : Screen thread : the framebuffer is about to be read for a new frame
+ * InputLatency *this : An allocated InputLatency
+ * Return : void
+ */
+void
+InputLatency_beginFrame (
+    InputLatency *this
+) {
+    // A probe published after this point is in the next frame, not in this one
+    if (this->isRendered || !__atomic_load_n (&this->isPublished, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    this->rendered = this->published;
+    this->isRendered = true;
+    __atomic_store_n (&this->isPublished, false, __ATOMIC_RELEASE);
+}
+
+
+/*
+ * Description : Screen thread : the frame has been displayed
+ * InputLatency *this : An allocated InputLatency
+ * Return : void
+ */
+void
+InputLatency_present (
+    InputLatency *this
+) {
+    if (!this->isRendered) {
+        return;
+    }
+
+    uint64_t now = ProfilerClock_microseconds ();
+    InputLatencyProbe *probe = &this->rendered;
+
+    ProfilerHistogram_record (this->observeDelays, probe->observeTime - probe->pressTime);
+    ProfilerHistogram_record (this->publishDelays, probe->publishTime - probe->observeTime);
+    ProfilerHistogram_record (this->presentDelays, now - probe->publishTime);
+    ProfilerHistogram_record (this->totalDelays,   now - probe->pressTime);
+
+    this->isRendered = false;
+}
+
+
+/*
+ * Description : Free an allocated InputLatency structure.
+ * InputLatency *this : An allocated InputLatency to free.
+ */
+void
+InputLatency_free (
+    InputLatency *this
+) {
+    // The histograms belong to the ProfilerFactory registry
+    if (this != NULL)
+    {
+        free (this);
+    }
+}
@@ -0,0 +1,154 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include "Profiler/ProfilerHistogram.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define INPUT_LATENCY_KEYS_COUNT 16
+
+// ------ Structure declaration -------
+
+// Timestamps in microseconds of a key press followed along the pipeline
+typedef struct _InputLatencyProbe
+{
+    uint64_t pressTime;   // Window_loop received the key event
+    uint64_t observeTime; // The CPU read the key pressed (EX9E, EXA1 or FX0A)
+    uint64_t publishTime; // The CPU changed the framebuffer afterwards (DXYN or 00E0)
+
+}   InputLatencyProbe;
+
+/*
+ *    Input to photon latency : a key press is timestamped by the Window thread, the CPU thread
+ *    tags when it first observes the key then when it changes the framebuffer, and the Screen
+ *    thread tags when the frame containing that change is presented.
+ *    Each stage is owned by one thread, and a probe is handed to the next one through a single
+ *    slot : the probes arriving while the slot is full are dropped, not delayed.
+ */
+typedef struct _InputLatency
+{
+    // Window thread : when an event last woke it up, and the presses not observed yet (0 otherwise)
+    uint64_t wakeTime;
+    uint64_t pressTimes [INPUT_LATENCY_KEYS_COUNT];
+
+    // CPU thread : a press observed, waiting for a framebuffer change
+    InputLatencyProbe observed;
+
+    // CPU -> Screen slot
+    InputLatencyProbe published;
+    bool isPublished;
+
+    // Screen thread : the probe of the frame being rendered
+    InputLatencyProbe rendered;
+    bool isRendered;
+
+    // Delay between the Window waking up and handling a key event, written by the Window thread
+    ProfilerHistogram *wakeDelays;
+
+    // Delays of each stage, and the whole latency, written by the Screen thread
+    ProfilerHistogram *observeDelays;
+    ProfilerHistogram *publishDelays;
+    ProfilerHistogram *presentDelays;
+    ProfilerHistogram *totalDelays;
+
+}   InputLatency;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Allocate a new InputLatency structure.
+ * Return        : A pointer to an allocated InputLatency.
+ */
+InputLatency *
+InputLatency_new (void);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Initialize an allocated InputLatency structure.
+ * InputLatency *this : An allocated InputLatency to initialize.
+ * Return : true on success, false on failure.
+ */
+bool
+InputLatency_init (
+    InputLatency *this
+);
+
+/*
+ * Description : Window thread : an event woke the Window up
+ * InputLatency *this : An allocated InputLatency
+ * Return : void
+ */
+void
+InputLatency_wake (
+    InputLatency *this
+);
+
+/*
+ * Description : Window thread : a key has been pressed
+ * InputLatency *this : An allocated InputLatency
+ * int code : The CHIP-8 key pressed
+ * Return : void
+ */
+void
+InputLatency_press (
+    InputLatency *this,
+    int code
+);
+
+/*
+ * Description : CPU thread : an instruction read a key pressed
+ * InputLatency *this : An allocated InputLatency
+ * int code : The CHIP-8 key read
+ * Return : void
+ */
+void
+InputLatency_observe (
+    InputLatency *this,
+    int code
+);
+
+/*
+ * Description : CPU thread : the framebuffer has been changed
+ * InputLatency *this : An allocated InputLatency
+ * Return : void
+ */
+void
+InputLatency_publish (
+    InputLatency *this
+);
+
+/*
+ * Description : Screen thread : the framebuffer is about to be read for a new frame
+ * InputLatency *this : An allocated InputLatency
+ * Return : void
+ */
+void
+InputLatency_beginFrame (
+    InputLatency *this
+);
+
+/*
+ * Description : Screen thread : the frame has been displayed
+ * InputLatency *this : An allocated InputLatency
+ * Return : void
+ */
+void
+InputLatency_present (
+    InputLatency *this
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated InputLatency structure.
+ * InputLatency *this : An allocated InputLatency to free.
+ */
+void
+InputLatency_free (
+    InputLatency *this
+);
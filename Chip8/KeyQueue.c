@@ -0,0 +1,110 @@
+#include "KeyQueue.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "KeyQueue"
+#include "dbg/dbg.h"
+
+/*
+ * Description     : Allocate a new empty KeyQueue structure.
+ * Return        : A pointer to an allocated KeyQueue.
+ */
+KeyQueue *
+KeyQueue_new (void)
+{
+    KeyQueue *this;
+
+    if ((this = calloc (1, sizeof(KeyQueue))) == NULL)
+        return NULL;
+
+    return this;
+}
+
+
+/*
+ * Description : Producer : add a key event at the end of the queue
+ * KeyQueue *this : An allocated KeyQueue
+ * uint8_t code : The CHIP-8 key
+ * bool isPressed : true when the key is pressed, false when it is released
+ * Return : bool, false when the queue is full and the event is dropped
+ */
+bool
+KeyQueue_push (
+    KeyQueue *this,
+    uint8_t code,
+    bool isPressed
+) {
+    uint32_t head = this->head;
+
+    if (head - __atomic_load_n (&this->tail, __ATOMIC_ACQUIRE) == KEY_QUEUE_SIZE) {
+        dbg ("Warning : The key queue is full, the CPU doesn't consume it.");
+        return false;
+    }
+
+    this->events[head & (KEY_QUEUE_SIZE - 1)] = (KeyEvent) {
+        .code      = code,
+        .isPressed = isPressed
+    };
+
+    // Publish the event written
+    __atomic_store_n (&this->head, head + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+
+/*
+ * Description : Consumer : apply the pending events to the keys pressed, in order.
+ *               A key changes at most once per call : a tap shorter than a call is seen pressed
+ *               for one call, and the events following it wait for the next call.
+ * KeyQueue *this : An allocated KeyQueue
+ * uint16_t keysMask : Bit N set when the key N is pressed before the events
+ * Return : uint16_t the keys pressed after the events applied
+ */
+uint16_t
+KeyQueue_getKeys (
+    KeyQueue *this,
+    uint16_t keysMask
+) {
+    uint32_t tail = this->tail;
+    uint32_t head = __atomic_load_n (&this->head, __ATOMIC_ACQUIRE);
+    uint16_t changedMask = 0;
+
+    for (; tail != head; tail++)
+    {
+        KeyEvent *event = &this->events[tail & (KEY_QUEUE_SIZE - 1)];
+        uint16_t key = 1 << event->code;
+
+        if (changedMask & key) {
+            // Keep the state of this call visible : the next events are for the next call
+            break;
+        }
+
+        if (event->isPressed) {
+            keysMask |= key;
+        } else {
+            keysMask &= ~key;
+        }
+        changedMask |= key;
+    }
+
+    // Release the events read
+    __atomic_store_n (&this->tail, tail, __ATOMIC_RELEASE);
+
+    return keysMask;
+}
+
+
+/*
+ * Description : Free an allocated KeyQueue structure.
+ * KeyQueue *this : An allocated KeyQueue to free.
+ */
+void
+KeyQueue_free (
+    KeyQueue *this
+) {
+    if (this != NULL)
+    {
+        free (this);
+    }
+}
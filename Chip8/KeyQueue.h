@@ -0,0 +1,88 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define KEY_QUEUE_SIZE 64 // Events pending, a power of 2
+
+// ------ Structure declaration -------
+
+// A key pressed or released
+typedef struct _KeyEvent
+{
+    uint8_t code;
+    bool isPressed;
+
+}   KeyEvent;
+
+/*
+ *    Key events sent by the Window thread to the CPU thread, in order and without loss.
+ *    Single producer, single consumer : each index is written by one thread only, and
+ *    published to the other with a release store.
+ */
+typedef struct _KeyQueue
+{
+    KeyEvent events [KEY_QUEUE_SIZE];
+
+    // Next event to write, by the Window thread
+    uint32_t head;
+
+    // Next event to read, by the CPU thread
+    uint32_t tail;
+
+}   KeyQueue;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Allocate a new empty KeyQueue structure.
+ * Return        : A pointer to an allocated KeyQueue.
+ */
+KeyQueue *
+KeyQueue_new (void);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Producer : add a key event at the end of the queue
+ * KeyQueue *this : An allocated KeyQueue
+ * uint8_t code : The CHIP-8 key
+ * bool isPressed : true when the key is pressed, false when it is released
+ * Return : bool, false when the queue is full and the event is dropped
+ */
+bool
+KeyQueue_push (
+    KeyQueue *this,
+    uint8_t code,
+    bool isPressed
+);
+
+/*
+ * Description : Consumer : apply the pending events to the keys pressed, in order.
+ *               A key changes at most once per call : a tap shorter than a call is seen pressed
+ *               for one call, and the events following it wait for the next call.
+ * KeyQueue *this : An allocated KeyQueue
+ * uint16_t keysMask : Bit N set when the key N is pressed before the events
+ * Return : uint16_t the keys pressed after the events applied
+ */
+uint16_t
+KeyQueue_getKeys (
+    KeyQueue *this,
+    uint16_t keysMask
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated KeyQueue structure.
+ * KeyQueue *this : An allocated KeyQueue to free.
+ */
+void
+KeyQueue_free (
+    KeyQueue *this
+);
@@ -0,0 +1,109 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// ---------- Defines -------------
+
+/*
+ *    The files written by the emulator (movies, traces, WAV captures) are little endian,
+ *    whatever the host is : their fields go through these helpers, byte by byte.
+ */
+
+
+// ----------- Functions ------------
+
+/*
+ * Description : Write the low bytes of a value, the least significant first
+ * FILE *file : The file written
+ * uint32_t value : The value
+ * int size : Number of bytes written, up to 4
+ * Return : bool, true on success, false otherwise
+ */
+static inline bool
+LittleEndian_write (
+    FILE *file,
+    uint32_t value,
+    int size
+) {
+    for (int byte = 0; byte < size; byte++) {
+        if (fputc ((value >> (byte * 8)) & 0xFF, file) == EOF) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Description : Read a value written by LittleEndian_write
+ * FILE *file : The file read
+ * uint32_t *value : (out) The value
+ * int size : Number of bytes read, up to 4
+ * Return : bool, true on success, false at the end of the file
+ */
+static inline bool
+LittleEndian_read (
+    FILE *file,
+    uint32_t *value,
+    int size
+) {
+    *value = 0;
+
+    for (int byte = 0; byte < size; byte++) {
+        int read = fgetc (file);
+        if (read == EOF) {
+            return false;
+        }
+        *value |= (uint32_t) read << (byte * 8);
+    }
+
+    return true;
+}
+
+/*
+ * Description : Write an array of 32 bits words, e.g. the header of a file
+ * FILE *file : The file written
+ * uint32_t *words : The words
+ * int count : Number of words
+ * Return : bool, true on success, false otherwise
+ */
+static inline bool
+LittleEndian_writeWords (
+    FILE *file,
+    uint32_t *words,
+    int count
+) {
+    for (int word = 0; word < count; word++) {
+        if (!LittleEndian_write (file, words[word], sizeof(uint32_t))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Description : Read an array of 32 bits words written by LittleEndian_writeWords
+ * FILE *file : The file read
+ * uint32_t *words : (out) The words
+ * int count : Number of words
+ * Return : bool, true on success, false at the end of the file
+ */
+static inline bool
+LittleEndian_readWords (
+    FILE *file,
+    uint32_t *words,
+    int count
+) {
+    for (int word = 0; word < count; word++) {
+        if (!LittleEndian_read (file, &words[word], sizeof(uint32_t))) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,236 @@
+#include "Movie.h"
+#include "LittleEndian.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "Movie"
+#include "dbg/dbg.h"
+
+/*
+ * Description     : Allocate a new empty Movie structure.
+ * uint32_t seed : Seed of the CXNN random generator at boot
+ * Return        : A pointer to an allocated Movie.
+ */
+Movie *
+Movie_new (
+    uint32_t seed
+) {
+    Movie *this;
+
+    if ((this = calloc (1, sizeof(Movie))) == NULL)
+        return NULL;
+
+    if (!Movie_init (this, seed)) {
+        Movie_free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+
+/*
+ * Description : Initialize an allocated Movie structure.
+ * Movie *this : An allocated Movie to initialize.
+ * uint32_t seed : Seed of the CXNN random generator at boot
+ * Return : true on success, false on failure.
+ */
+bool
+Movie_init (
+    Movie *this,
+    uint32_t seed
+) {
+    this->seed = seed;
+    this->frames = NULL;
+    this->framesCount = 0;
+    this->framesCapacity = 0;
+
+    return true;
+}
+
+
+/*
+ * Description     : Load a Movie from a file
+ * char *filename : The movie file
+ * Return        : A pointer to an allocated Movie, NULL on failure.
+ */
+Movie *
+Movie_load (
+    char *filename
+) {
+    uint32_t header [4];
+    Movie *this;
+    FILE *file;
+
+    if ((file = fopen (filename, "rb")) == NULL) {
+        dbg ("The movie \"%s\" cannot be loaded.", filename);
+        return NULL;
+    }
+
+    if (!LittleEndian_readWords (file, header, sizeof_array (header))
+    ||  header[0] != MOVIE_MAGIC
+    ||  header[1] != MOVIE_VERSION) {
+        dbg ("\"%s\" is not a compatible movie.", filename);
+        fclose (file);
+        return NULL;
+    }
+
+    if ((this = Movie_new (header[2])) == NULL) {
+        fclose (file);
+        return NULL;
+    }
+
+    for (uint32_t frame = 0; frame < header[3]; frame++) {
+        uint8_t bytes [2];
+        if (fread (bytes, sizeof(bytes), 1, file) != 1) {
+            dbg ("The movie \"%s\" is truncated at frame %u.", filename, frame);
+            break;
+        }
+        Movie_addFrame (this, bytes[0] | (bytes[1] << 8));
+    }
+
+    fclose (file);
+
+    return this;
+}
+
+
+/*
+ * Description     : Allocate a copy of a Movie
+ * Movie *other : The movie to copy
+ * Return        : A pointer to an allocated Movie.
+ */
+Movie *
+Movie_copy (
+    Movie *other
+) {
+    Movie *this;
+
+    if ((this = Movie_new (other->seed)) == NULL)
+        return NULL;
+
+    if (other->framesCount > 0) {
+        if ((this->frames = malloc (other->framesCount * sizeof(uint16_t))) == NULL) {
+            Movie_free (this);
+            return NULL;
+        }
+        memcpy (this->frames, other->frames, other->framesCount * sizeof(uint16_t));
+        this->framesCount = this->framesCapacity = other->framesCount;
+    }
+
+    return this;
+}
+
+
+/*
+ * Description : Append a frame at the end of the movie
+ * Movie *this : An allocated Movie
+ * uint16_t keys : Keys pressed during the frame
+ * Return : bool, true on success, false otherwise
+ */
+bool
+Movie_addFrame (
+    Movie *this,
+    uint16_t keys
+) {
+    if (this->framesCount >= this->framesCapacity) {
+        int capacity = (this->framesCapacity) ? this->framesCapacity * 2 : 256;
+        uint16_t *frames = realloc (this->frames, capacity * sizeof(uint16_t));
+
+        if (frames == NULL) {
+            return false;
+        }
+
+        this->frames = frames;
+        this->framesCapacity = capacity;
+    }
+
+    this->frames[this->framesCount++] = keys;
+
+    return true;
+}
+
+
+/*
+ * Description : Get the keys pressed during a frame. The movie releases every key after its end.
+ * Movie *this : An allocated Movie
+ * int frame : The frame number
+ * Return : uint16_t the keys pressed
+ */
+inline uint16_t
+Movie_getKeys (
+    Movie *this,
+    int frame
+) {
+    return (frame < this->framesCount) ? this->frames[frame] : 0;
+}
+
+
+/*
+ * Description : Scripted input, used without movie : a random key, or none, held for
+ *               MOVIE_SCRIPT_HOLD_FRAMES frames. The same for a given seed on every ROM and run.
+ * uint32_t seed : Seed of the input
+ * int frame : The frame number
+ * Return : uint16_t the keys pressed
+ */
+uint16_t
+Movie_getScriptedKeys (
+    uint32_t seed,
+    int frame
+) {
+    uint32_t x = (seed ^ 0x9E3779B9) + (frame / MOVIE_SCRIPT_HOLD_FRAMES) * 0x85EBCA6B;
+    x ^= x >> 16; x *= 0x7FEB352D;
+    x ^= x >> 15; x *= 0x846CA68B;
+    x ^= x >> 16;
+
+    return (x & 0x10) ? 0 : (1 << (x & 0xF));
+}
+
+
+/*
+ * Description : Write the movie in a file
+ * Movie *this : An allocated Movie
+ * char *filename : The movie file
+ * Return : bool, true on success, false otherwise
+ */
+bool
+Movie_save (
+    Movie *this,
+    char *filename
+) {
+    uint32_t header [] = {MOVIE_MAGIC, MOVIE_VERSION, this->seed, this->framesCount};
+    bool result = true;
+    FILE *file;
+
+    if ((file = fopen (filename, "wb")) == NULL) {
+        dbg ("The movie \"%s\" cannot be written.", filename);
+        return false;
+    }
+
+    result = LittleEndian_writeWords (file, header, sizeof_array (header));
+
+    for (int frame = 0; result && frame < this->framesCount; frame++) {
+        uint8_t bytes [] = {this->frames[frame] & 0xFF, this->frames[frame] >> 8};
+        result = fwrite (bytes, sizeof(bytes), 1, file) == 1;
+    }
+
+    fclose (file);
+
+    return result;
+}
+
+
+/*
+ * Description : Free an allocated Movie structure.
+ * Movie *this : An allocated Movie to free.
+ */
+void
+Movie_free (
+    Movie *this
+) {
+    if (this != NULL)
+    {
+        free (this->frames);
+        free (this);
+    }
+}
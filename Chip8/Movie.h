@@ -0,0 +1,140 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define MOVIE_MAGIC   0x564D3843 // "C8MV"
+#define MOVIE_VERSION 1
+#define MOVIE_SCRIPT_HOLD_FRAMES 12 // Frames each key of the scripted input is held
+
+/*
+ *    Movie file layout (little endian) :
+ *        uint32_t magic, version, seed, framesCount
+ *        uint16_t keys [framesCount]   Bit N set when the key N is pressed during the frame
+ */
+
+// ------ Structure declaration -------
+typedef struct _Movie
+{
+    // Seed of the CXNN random generator at boot
+    uint32_t seed;
+
+    // Keys pressed during each frame
+    uint16_t *frames;
+    int framesCount;
+    int framesCapacity;
+
+}   Movie;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Allocate a new empty Movie structure.
+ * uint32_t seed : Seed of the CXNN random generator at boot
+ * Return        : A pointer to an allocated Movie.
+ */
+Movie *
+Movie_new (
+    uint32_t seed
+);
+
+/*
+ * Description     : Load a Movie from a file
+ * char *filename : The movie file
+ * Return        : A pointer to an allocated Movie, NULL on failure.
+ */
+Movie *
+Movie_load (
+    char *filename
+);
+
+/*
+ * Description     : Allocate a copy of a Movie
+ * Movie *other : The movie to copy
+ * Return        : A pointer to an allocated Movie.
+ */
+Movie *
+Movie_copy (
+    Movie *other
+);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Initialize an allocated Movie structure.
+ * Movie *this : An allocated Movie to initialize.
+ * uint32_t seed : Seed of the CXNN random generator at boot
+ * Return : true on success, false on failure.
+ */
+bool
+Movie_init (
+    Movie *this,
+    uint32_t seed
+);
+
+/*
+ * Description : Append a frame at the end of the movie
+ * Movie *this : An allocated Movie
+ * uint16_t keys : Keys pressed during the frame
+ * Return : bool, true on success, false otherwise
+ */
+bool
+Movie_addFrame (
+    Movie *this,
+    uint16_t keys
+);
+
+/*
+ * Description : Get the keys pressed during a frame. The movie releases every key after its end.
+ * Movie *this : An allocated Movie
+ * int frame : The frame number
+ * Return : uint16_t the keys pressed
+ */
+uint16_t
+Movie_getKeys (
+    Movie *this,
+    int frame
+);
+
+/*
+ * Description : Scripted input, used without movie : a random key, or none, held for
+ *               MOVIE_SCRIPT_HOLD_FRAMES frames. The same for a given seed on every ROM and run.
+ * uint32_t seed : Seed of the input
+ * int frame : The frame number
+ * Return : uint16_t the keys pressed
+ */
+uint16_t
+Movie_getScriptedKeys (
+    uint32_t seed,
+    int frame
+);
+
+/*
+ * Description : Write the movie in a file
+ * Movie *this : An allocated Movie
+ * char *filename : The movie file
+ * Return : bool, true on success, false otherwise
+ */
+bool
+Movie_save (
+    Movie *this,
+    char *filename
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated Movie structure.
+ * Movie *this : An allocated Movie to free.
+ */
+void
+Movie_free (
+    Movie *this
+);
+
+
@@ -0,0 +1,185 @@
+#include "OpcodeStats.h"
+#include "Profiler/ProfilerThreads.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "OpcodeStats"
+#include "dbg/dbg.h"
+
+// Sorting helpers of the report
+static OpcodeStats *sortedStats = NULL;
+
+
+/*
+ * Write the report in OPCODE_STATS_FILENAME when the process exits
+ */
+static void
+OpcodeStats_writeReport (void) {
+    FILE *output;
+
+    if ((output = fopen (OPCODE_STATS_FILENAME, "w")) == NULL) {
+        dbg ("Error : Cannot write \"%s\".", OPCODE_STATS_FILENAME);
+        return;
+    }
+
+    OpcodeStats_report (output);
+    fclose (output);
+    printf ("Opcode statistics written in \"%s\".\n", OPCODE_STATS_FILENAME);
+}
+
+static void
+OpcodeStats_start (void) {
+    atexit (OpcodeStats_writeReport);
+}
+
+
+// Sum of the tables of the threads exited, their slots are reused
+static OpcodeStats exitedStats;
+
+static void
+OpcodeStats_fold (
+    void *table
+) {
+    OpcodeStats *stats = table;
+
+    for (int class = 0; class < opcodeClassCount; class++) {
+        exitedStats.classCounts[class] += stats->classCounts[class];
+        exitedStats.classCycles[class] += stats->classCycles[class];
+    }
+    for (int opcode = 0; opcode < 0x10000; opcode++) {
+        exitedStats.opcodeCounts[opcode] += stats->opcodeCounts[opcode];
+    }
+}
+
+
+// Tables of the threads running, summed at exit
+static ProfilerThreads threadsStats = {
+    .name = "opcode counts",
+    .tableSize = sizeof(OpcodeStats),
+    .capacity = OPCODE_STATS_MAX_THREADS,
+    .start = OpcodeStats_start,
+    .fold = OpcodeStats_fold,
+    .mutex = PTHREAD_MUTEX_INITIALIZER
+};
+static __thread OpcodeStats *currentStats = NULL;
+static __thread bool isDropped = false; // No slot was left for the thread
+
+
+/*
+ * Description : Count an opcode executed by the current thread
+ * uint16_t opcode : The opcode executed
+ * uint64_t startClock : OpcodeStats_readClock () before the execution
+ * Return : void
+ */
+void
+OpcodeStats_record (
+    uint16_t opcode,
+    uint64_t startClock
+) {
+    OpcodeStats *stats = currentStats;
+
+    if (stats == NULL) {
+        if (isDropped || (stats = ProfilerThreads_register (&threadsStats, NULL)) == NULL) {
+            isDropped = true;
+            return;
+        }
+        currentStats = stats;
+    }
+
+    OpcodeClass class = Disassembler_getClass (opcode);
+    stats->classCounts[class]++;
+    stats->classCycles[class] += OpcodeStats_readClock () - startClock;
+    stats->opcodeCounts[opcode]++;
+}
+
+
+static int
+OpcodeStats_compareClasses (const void *a, const void *b) {
+    uint64_t x = sortedStats->classCounts[*(OpcodeClass *) a];
+    uint64_t y = sortedStats->classCounts[*(OpcodeClass *) b];
+    return (x < y) - (x > y);
+}
+
+static int
+OpcodeStats_compareOpcodes (const void *a, const void *b) {
+    uint64_t x = sortedStats->opcodeCounts[*(uint16_t *) a];
+    uint64_t y = sortedStats->opcodeCounts[*(uint16_t *) b];
+    return (x < y) - (x > y);
+}
+
+
+/*
+ * Description : Write the report of the opcodes executed by all the threads, sorted by executions
+ * FILE *output : Where the report is written
+ * Return : void
+ */
+void
+OpcodeStats_report (
+    FILE *output
+) {
+    OpcodeStats *total;
+    uint16_t *opcodes;
+    OpcodeClass classes [opcodeClassCount];
+    int opcodesCount = 0;
+    uint64_t executions = 0;
+
+    if ((total = calloc (1, sizeof(OpcodeStats))) == NULL
+    ||  (opcodes = malloc (0x10000 * sizeof(uint16_t))) == NULL) {
+        free (total);
+        return;
+    }
+
+    ProfilerThreads_lock (&threadsStats);
+    memcpy (total, &exitedStats, sizeof(OpcodeStats));
+    for (int id = 0; id < threadsStats.count; id++) {
+        OpcodeStats *stats = threadsStats.tables[id];
+        if (stats == NULL) {
+            continue;
+        }
+        for (int class = 0; class < opcodeClassCount; class++) {
+            total->classCounts[class] += stats->classCounts[class];
+            total->classCycles[class] += stats->classCycles[class];
+        }
+        for (int opcode = 0; opcode < 0x10000; opcode++) {
+            total->opcodeCounts[opcode] += stats->opcodeCounts[opcode];
+        }
+    }
+    int count = threadsStats.registeredCount;
+    ProfilerThreads_unlock (&threadsStats);
+
+    for (int class = 0; class < opcodeClassCount; class++) {
+        classes[class] = class;
+        executions += total->classCounts[class];
+    }
+    for (int opcode = 0; opcode < 0x10000; opcode++) {
+        if (total->opcodeCounts[opcode]) {
+            opcodes[opcodesCount++] = opcode;
+        }
+    }
+
+    sortedStats = total;
+    qsort (classes, opcodeClassCount, sizeof(OpcodeClass), OpcodeStats_compareClasses);
+    qsort (opcodes, opcodesCount, sizeof(uint16_t), OpcodeStats_compareOpcodes);
+    sortedStats = NULL;
+
+    fprintf (output, "%llu opcodes executed by %d threads\n\n", (unsigned long long) executions, count);
+    fprintf (output, "Class      executions      %%   cycles/op\n");
+    for (int i = 0; i < opcodeClassCount && total->classCounts[classes[i]]; i++) {
+        OpcodeClass class = classes[i];
+        fprintf (output, "%s  %16llu %6.2f %11.1f\n",
+            Disassembler_getClassName (class), (unsigned long long) total->classCounts[class],
+            total->classCounts[class] * 100.0 / executions,
+            (double) total->classCycles[class] / total->classCounts[class]);
+    }
+
+    fprintf (output, "\nOpcode     executions      %%   (%d most executed out of %d)\n", OPCODE_STATS_TOP_OPCODES, opcodesCount);
+    for (int i = 0; i < opcodesCount && i < OPCODE_STATS_TOP_OPCODES; i++) {
+        uint16_t opcode = opcodes[i];
+        fprintf (output, "%04X  %16llu %6.2f\n",
+            opcode, (unsigned long long) total->opcodeCounts[opcode],
+            total->opcodeCounts[opcode] * 100.0 / executions);
+    }
+
+    free (opcodes);
+    free (total);
+}
@@ -0,0 +1,70 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+/*
+ *    Executions per opcode, counted by the CPU engines when the emulator is built with
+ *    -DCPU_OPCODE_STATS, and compiled out entirely otherwise. With -DCPU_OPCODE_STATS_CYCLES,
+ *    the host cycles (rdtsc) spent in each class of opcodes are counted as well.
+ *    Each thread counts in its own tables (ProfilerThreads) ; the tables of the threads exited are
+ *    folded into a total, and the report is written in OPCODE_STATS_FILENAME when the process exits.
+ */
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include "Disassembler.h"
+#include <stdint.h>
+#if defined(CPU_OPCODE_STATS_CYCLES) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+// ---------- Defines -------------
+#define OPCODE_STATS_FILENAME "opcode-stats.txt"
+#define OPCODE_STATS_MAX_THREADS 256
+#define OPCODE_STATS_TOP_OPCODES 64
+
+// ------ Structure declaration -------
+typedef struct _OpcodeStats
+{
+    uint64_t classCounts [opcodeClassCount];
+    uint64_t classCycles [opcodeClassCount];
+    uint64_t opcodeCounts [0x10000];
+
+}   OpcodeStats;
+
+
+// ----------- Functions ------------
+
+/*
+ * Description : Read the host cycles counter, 0 when the cycles aren't sampled
+ * Return : uint64_t the host cycles counter
+ */
+static inline uint64_t
+OpcodeStats_readClock (void) {
+    #if defined(CPU_OPCODE_STATS_CYCLES) && (defined(__x86_64__) || defined(__i386__))
+        return __rdtsc ();
+    #else
+        return 0;
+    #endif
+}
+
+/*
+ * Description : Count an opcode executed by the current thread
+ * uint16_t opcode : The opcode executed
+ * uint64_t startClock : OpcodeStats_readClock () before the execution
+ * Return : void
+ */
+void
+OpcodeStats_record (
+    uint16_t opcode,
+    uint64_t startClock
+);
+
+/*
+ * Description : Write the report of the opcodes executed by all the threads, sorted by executions
+ * FILE *output : Where the report is written
+ * Return : void
+ */
+void
+OpcodeStats_report (
+    FILE *output
+);
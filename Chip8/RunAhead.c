@@ -0,0 +1,105 @@
+#include "RunAhead.h"
+#include "Profiler/ProfilerClock.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "RunAhead"
+#include "dbg/dbg.h"
+
+/*
+ * Description     : Allocate a new RunAhead structure.
+ * int framesCount : Frames emulated ahead, between 1 and RUN_AHEAD_MAX_FRAMES
+ * Return        : A pointer to an allocated RunAhead.
+ */
+RunAhead *
+RunAhead_new (
+    int framesCount
+) {
+    RunAhead *this;
+
+    if (framesCount < 1 || framesCount > RUN_AHEAD_MAX_FRAMES) {
+        dbg ("Error : Between 1 and %d frames can be emulated ahead.", RUN_AHEAD_MAX_FRAMES);
+        return NULL;
+    }
+
+    if ((this = calloc (1, sizeof(RunAhead))) == NULL)
+        return NULL;
+
+    this->framesCount = framesCount;
+
+    if (!(this->aheadTimes = ProfilerFactory_getHistogram ("Run-ahead"))) {
+        RunAhead_free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+
+/*
+ * Description : Save the machine, then emulate it framesCount frames ahead
+ * RunAhead *this : An allocated RunAhead
+ * Cpu *cpu : The machine after its real frame
+ * Return : void
+ */
+void
+RunAhead_start (
+    RunAhead *this,
+    Cpu *cpu
+) {
+    this->startTime = ProfilerClock_microseconds ();
+
+    Cpu_saveState (cpu, &this->state);
+
+    // Only the real frames are traced, profiled and measured, and make sounds
+    this->trace = cpu->trace;
+    this->guestProfiler = cpu->guestProfiler;
+    this->latency = cpu->latency;
+    cpu->trace = NULL;
+    cpu->guestProfiler = NULL;
+    cpu->latency = NULL;
+    cpu->isRunningAhead = true;
+
+    // The keys currently pressed stay pressed
+    for (int frame = 0; frame < this->framesCount && cpu->isRunning; frame++) {
+        Cpu_emulateFrame (cpu);
+    }
+}
+
+
+/*
+ * Description : Restore the machine saved by RunAhead_start, once the frame ahead is presented
+ * RunAhead *this : An allocated RunAhead
+ * Cpu *cpu : The machine emulated ahead
+ * Return : void
+ */
+void
+RunAhead_restore (
+    RunAhead *this,
+    Cpu *cpu
+) {
+    // A fault ahead is forgotten too : the real machine raises it when it gets there
+    Cpu_loadState (cpu, &this->state);
+
+    cpu->trace = this->trace;
+    cpu->guestProfiler = this->guestProfiler;
+    cpu->latency = this->latency;
+    cpu->isRunningAhead = false;
+
+    ProfilerHistogram_record (this->aheadTimes, ProfilerClock_microseconds () - this->startTime);
+}
+
+
+/*
+ * Description : Free an allocated RunAhead structure.
+ * RunAhead *this : An allocated RunAhead to free.
+ */
+void
+RunAhead_free (
+    RunAhead *this
+) {
+    if (this != NULL)
+    {
+        free (this);
+    }
+}
@@ -0,0 +1,88 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "CPU.h"
+#include "Profiler/ProfilerHistogram.h"
+
+// ---------- Defines -------------
+#define RUN_AHEAD_MAX_FRAMES 8
+
+// ------ Structure declaration -------
+
+/*
+ *    Run-ahead : after each real frame, the machine is saved, emulated a few frames further
+ *    with the keys currently pressed, and that future frame is presented before the machine
+ *    is restored. A game reacting to a key one or two frames late shows the reaction at once.
+ *    The frames ahead make no sound, leave no trace and aren't measured by the input latency :
+ *    only their framebuffer is shown.
+ */
+typedef struct _RunAhead
+{
+    // Frames emulated ahead of the real machine
+    int framesCount;
+
+    // The real machine, while the frames ahead are shown
+    CpuState state;
+
+    // Side effects detached during the frames ahead
+    CpuTrace *trace;
+    GuestProfiler *guestProfiler;
+    InputLatency *latency;
+
+    // Duration of the save, the frames ahead and the restore
+    ProfilerHistogram *aheadTimes;
+    uint64_t startTime;
+
+}   RunAhead;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Allocate a new RunAhead structure.
+ * int framesCount : Frames emulated ahead, between 1 and RUN_AHEAD_MAX_FRAMES
+ * Return        : A pointer to an allocated RunAhead.
+ */
+RunAhead *
+RunAhead_new (
+    int framesCount
+);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Save the machine, then emulate it framesCount frames ahead
+ * RunAhead *this : An allocated RunAhead
+ * Cpu *cpu : The machine after its real frame
+ * Return : void
+ */
+void
+RunAhead_start (
+    RunAhead *this,
+    Cpu *cpu
+);
+
+/*
+ * Description : Restore the machine saved by RunAhead_start, once the frame ahead is presented
+ * RunAhead *this : An allocated RunAhead
+ * Cpu *cpu : The machine emulated ahead
+ * Return : void
+ */
+void
+RunAhead_restore (
+    RunAhead *this,
+    Cpu *cpu
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated RunAhead structure.
+ * RunAhead *this : An allocated RunAhead to free.
+ */
+void
+RunAhead_free (
+    RunAhead *this
+);
@@ -7,7 +7,7 @@
 
 /*
  * Description     : Allocate a new Screen structure.
- * sfRenderWindow *sfmlWindow : A SFML render window context
+ * sfRenderWindow *sfmlWindow : A SFML render window context, or NULL for a headless screen
  * Return         : A pointer to an allocated Screen.
  */
 Screen *
@@ -31,7 +31,7 @@ Screen_new (
 /*
  * Description : Initialize an allocated Screen structure.
  * Screen *this : An allocated Screen to initialize.
- * sfRenderWindow *sfmlWindow : A SFML render window context
+ * sfRenderWindow *sfmlWindow : A SFML render window context, or NULL for a headless screen
  * Return : true on success, false on failure.
  */
 bool
@@ -39,15 +39,26 @@ Screen_init (
     Screen *this,
     sfRenderWindow *sfmlWindow
 ) {
+    // Share the sfmlWindow pointer
+    this->window = sfmlWindow;
+
+    // Clear the screen
+    Screen_clear (this);
+
+    // A headless screen only owns its framebuffer
+    if (this->window == NULL) {
+        this->isRunning = true;
+        return true;
+    }
+
     // Get a profiler
-    if (!(this->profiler = ProfilerFactory_getProfiler ("Screen"))) {
+    if (!(this->profiler = ProfilerFactory_getProfiler ("Screen"))
+    ||  !(this->renderTimes = ProfilerFactory_getHistogram ("Render"))
+    ||  !(this->presentIntervals = ProfilerFactory_getHistogram ("Present"))) {
         dbg ("Cannot allocate a new Profiler.");
         return false;
     }
 
-    // Share the sfmlWindow pointer
-    this->window = sfmlWindow;
-
     // Initialize the pixels array
     for (int y = 0, id = 0; y < RESOLUTION_H; y++) {
         for (int x = 0; x < RESOLUTION_W; x++, id++) {
@@ -58,8 +69,30 @@ Screen_init (
         }
     }
 
-    // Clear the screen
-    Screen_clear (this);
+	// Scan lines effect
+	for (int i = 0; i < sizeof_array(this->scanLines); i++) {
+		this->scanLines[i] = sfRectangleShape_create();
+		sfRectangleShape_setPosition (this->scanLines[i], (sfVector2f){.x = 0, .y = i*2});
+		sfRectangleShape_setSize (this->scanLines[i], (sfVector2f){.x = RESOLUTION_W * PIXEL_SIZE, .y=1});
+		sfRectangleShape_setFillColor (this->scanLines[i], sfColor_fromRGBA(0, 0, 0, 100));
+	}
+
+    // Profilers overlay, optional : it is rebuilt when the profilers are updated
+    this->overlay = ProfilerOverlay_new (PROFILER_OVERLAY_FONT);
+    this->overlayProfilersCount = -1;
+
+    // Frame timings
+    this->renderClock = sfClock_create ();
+    this->presentClock = sfClock_create ();
+    this->isPresented = false;
+
+    // The refresh period is measured on the first frames
+    this->refreshPeriod = SCREEN_FRAME_PERIOD;
+    this->renderTime = 0;
+    this->calibrationFrames = 0;
+
+    // The first frame is always rendered
+    this->presentedVersion = this->framebufferVersion - 1;
 
     // Ready state
     this->isRunning = true;
@@ -76,8 +109,91 @@ void
 Screen_clear (
     Screen *this
 ) {
-    for (int i = 0; i < RESOLUTION_W * RESOLUTION_H; i++) {
-        Pixel_setValue (this->pixels[i], PIXEL_BLACK);
+    Screen_beginUpdate (this);
+    memset (this->framebuffer, PIXEL_BLACK, sizeof(this->framebuffer));
+    this->framebufferHash = 0;
+    Screen_endUpdate (this);
+}
+
+
+/*
+ * Description : Writer side : the framebuffer is about to be changed
+ * Screen *this : An allocated Screen
+ * Return : void
+ */
+void
+Screen_beginUpdate (
+    Screen *this
+) {
+    // Odd version : a copy taken from now on is discarded
+    __atomic_store_n (&this->framebufferVersion, this->framebufferVersion + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+}
+
+
+/*
+ * Description : Writer side : publish the framebuffer changed since Screen_beginUpdate
+ * Screen *this : An allocated Screen
+ * Return : void
+ */
+void
+Screen_endUpdate (
+    Screen *this
+) {
+    __atomic_store_n (&this->framebufferVersion, this->framebufferVersion + 1, __ATOMIC_RELEASE);
+}
+
+
+/*
+ * Description : Reader side : copy the framebuffer while the CPU isn't changing it
+ * Screen *this : An allocated Screen
+ * uint32_t *version : (out) The version copied
+ * Return : bool, false when the CPU kept changing it : the previous copy is left unchanged
+ */
+static bool
+Screen_snapshot (
+    Screen *this,
+    uint32_t *version
+) {
+    uint8_t copy [RESOLUTION_W * RESOLUTION_H];
+
+    for (int retry = 0; retry < SCREEN_SNAPSHOT_RETRIES; retry++)
+    {
+        uint32_t before = __atomic_load_n (&this->framebufferVersion, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            continue;
+        }
+
+        memcpy (copy, this->framebuffer, sizeof(copy));
+
+        // The copy is whole when no change started meanwhile
+        __atomic_thread_fence (__ATOMIC_ACQUIRE);
+        if (__atomic_load_n (&this->framebufferVersion, __ATOMIC_RELAXED) == before) {
+            memcpy (this->presentedFramebuffer, copy, sizeof(copy));
+            *version = before;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/*
+ * Description : Compute again the framebuffer hash from the whole framebuffer
+ * Screen *this : An allocated Screen
+ * Return : void
+ */
+void
+Screen_rehash (
+    Screen *this
+) {
+    this->framebufferHash = 0;
+
+    for (int pos = 0; pos < RESOLUTION_W * RESOLUTION_H; pos++) {
+        if (this->framebuffer[pos] == PIXEL_WHITE) {
+            this->framebufferHash ^= STATE_HASH_PIXEL (pos);
+        }
     }
 }
 
@@ -92,7 +208,7 @@ void Screen_debug (
 ) {
     for (int y = 0; y < RESOLUTION_H; ++y) {
         for (int x = 0; x < RESOLUTION_W; ++x) {
-            printf ((this->pixels[(y * RESOLUTION_W) + x]->value == PIXEL_WHITE) ? "x" : " ");
+            printf ((this->framebuffer[(y * RESOLUTION_W) + x] == PIXEL_WHITE) ? "x" : " ");
         }
         printf ("\n");
     }
@@ -100,63 +216,192 @@ void Screen_debug (
 
 
 /*
- * Description : Draw the screen buffer to the user screen
+ * Update the refresh period of the display from the interval between two presents : presented
+ * back to back they are blocked by the vertical sync, so the interval is a multiple of the period
+ */
+static void
+Screen_measureRefresh (
+    Screen *this,
+    sfInt64 interval
+) {
+    if (this->calibrationFrames < SCREEN_CALIBRATION_FRAMES) {
+        // The shortest interval is one period : the others missed a vertical sync
+        if (this->calibrationFrames++ == 0 || interval < this->refreshPeriod) {
+            this->refreshPeriod = interval;
+        }
+
+        // Presents not blocked : the vertical sync is disabled by the driver
+        if (this->calibrationFrames == SCREEN_CALIBRATION_FRAMES && this->refreshPeriod < SCREEN_MIN_REFRESH_PERIOD) {
+            this->refreshPeriod = SCREEN_FRAME_PERIOD;
+        }
+        return;
+    }
+
+    // Then follow the small drifts, ignoring the vertical syncs missed
+    if (interval > this->refreshPeriod - this->refreshPeriod / 8
+    &&  interval < this->refreshPeriod + this->refreshPeriod / 8) {
+        this->refreshPeriod += (interval - this->refreshPeriod) / 16;
+    }
+}
+
+
+/*
+ * Description : Render and present the screen buffer, if it changed since the last present
  * Screen *this : An allocated Screen
- * Return : void
+ * Return : bool, false when there was nothing new to present
  */
-void
-Screen_loop (
+bool
+Screen_render (
     Screen *this
 ) {
-    // Information for displaying profilers
-    int profilersArraySize;
-    Profiler **profilersArray = ProfilerFactory_getArray (&profilersArraySize);
+    // Information for displaying profilers : the overlay is rebuilt when they are updated
+    Profiler *profilersArray [PROFILER_FACTORY_MAX_PROFILERS];
+    ProfilerHistogram *histogramsArray [PROFILER_FACTORY_MAX_HISTOGRAMS];
 
-	// Scan lines effect
-	sfRectangleShape *scanLines[(RESOLUTION_H * PIXEL_SIZE) / 2];
-	for (int i = 0; i < sizeof_array(scanLines); i++) {
-		scanLines[i] = sfRectangleShape_create();
-		sfRectangleShape_setPosition (scanLines[i], (sfVector2f){.x = 0, .y = i*2});
-		sfRectangleShape_setSize (scanLines[i], (sfVector2f){.x = RESOLUTION_W * PIXEL_SIZE, .y=1});
-		sfRectangleShape_setFillColor (scanLines[i], sfColor_fromRGBA(0, 0, 0, 100));
-	}
+    // Update the profilers registered so far
+    int profilersArraySize = ProfilerFactory_getSnapshot (profilersArray);
+    bool isOverlayUpdated = (profilersArraySize != this->overlayProfilersCount);
 
-    // Rendering loop
-    while (this->isRunning)
+    for (int i = 0; i < profilersArraySize; i++)
     {
-        // Increment frame counter
-        Profiler_tick (this->profiler);
+        Profiler *profiler = profilersArray[i];
 
-        // Draw screen
-        for (int pos = 0; pos < RESOLUTION_H * RESOLUTION_W; pos++) {
-            Pixel *pixel = this->pixels[pos];
-            sfRenderWindow_drawRectangleShape (this->window, pixel->rect, NULL);
+        // Compute tick per second
+        if (Profiler_getTime (profiler) >= 1.0f) {
+            Profiler_snapshot (profiler);
+            Profiler_update (profiler);
+            isOverlayUpdated = true;
         }
+    }
 
-		// Draw scan lines
-        for (int i = 0; i < sizeof_array(scanLines); i++) {
-			sfRenderWindow_drawRectangleShape(this->window, scanLines[i], NULL);
-        }
+    // Nothing new to show : the display is still presented back to back while its refresh period is measured
+    uint32_t version = __atomic_load_n (&this->framebufferVersion, __ATOMIC_ACQUIRE);
+    bool isCalibrating = (this->calibrationFrames < SCREEN_CALIBRATION_FRAMES);
+    if (version == this->presentedVersion && !(isOverlayUpdated && this->overlay) && !isCalibrating) {
+        this->isPresented = false;
+        return false;
+    }
 
-        // Draw profiling information
-        for (int i = 0; i < profilersArraySize; i++)
-        {
-            Profiler *profiler = profilersArray[i];
+    // Increment frame counter
+    Profiler_tick (this->profiler);
+    sfClock_restart (this->renderClock);
 
-            // Compute tick per second
-            if (Profiler_getTime (profiler) >= 1.0f) {
-                Profiler_update (profiler);
-                Profiler_restart (profiler);
+    if (this->latency) {
+        InputLatency_beginFrame (this->latency);
+    }
+
+    // Latch the framebuffer : a sprite being drawn is never shown half drawn.
+    // When the CPU keeps changing it, the previous frame is drawn again and the next one retries.
+    if (Screen_snapshot (this, &version)) {
+        this->presentedVersion = version;
+    }
+
+    // Draw screen
+    PROFILER_ZONE_BEGIN ("Pixels");
+    for (int pos = 0; pos < RESOLUTION_H * RESOLUTION_W; pos++) {
+        Pixel *pixel = this->pixels[pos];
+        Pixel_setValue (pixel, this->presentedFramebuffer[pos]);
+        sfRenderWindow_drawRectangleShape (this->window, pixel->rect, NULL);
+    }
+    PROFILER_ZONE_END ();
+
+	// Draw scan lines
+    for (int i = 0; i < sizeof_array(this->scanLines); i++) {
+		sfRenderWindow_drawRectangleShape(this->window, this->scanLines[i], NULL);
+    }
+
+    // Draw profiling information
+    if (this->overlay)
+    {
+        if (isOverlayUpdated) {
+            ProfilerOverlay_clear (this->overlay);
+            for (int i = 0; i < profilersArraySize; i++) {
+                ProfilerOverlay_addLine (this->overlay, profilersArray[i]->text, sfRed);
             }
 
-            sfRenderWindow_drawText (this->window, profiler->text, NULL);
+            // Percentiles since the start
+            int histogramsArraySize = ProfilerFactory_getHistogramsSnapshot (histogramsArray);
+            for (int i = 0; i < histogramsArraySize; i++) {
+                char text [PROFILER_HISTOGRAM_TEXT_SIZE];
+                ProfilerHistogram_format (histogramsArray[i], text);
+                ProfilerOverlay_addLine (this->overlay, text, sfYellow);
+            }
+            this->overlayProfilersCount = profilersArraySize;
         }
 
-        // Request display
-        sfRenderWindow_display (this->window);
+        ProfilerOverlay_draw (this->overlay, this->window);
+    }
+
+    // The longest rendering time, slowly forgotten
+    sfInt64 renderTime = sfTime_asMicroseconds (sfClock_getElapsedTime (this->renderClock));
+    this->renderTime = (renderTime > this->renderTime) ? renderTime : this->renderTime - this->renderTime / 64;
+    ProfilerHistogram_record (this->renderTimes, renderTime);
+
+    // Request display
+    PROFILER_ZONE_BEGIN ("Present");
+    sfRenderWindow_display (this->window);
+    PROFILER_ZONE_END ();
+
+    if (this->latency) {
+        InputLatency_present (this->latency);
+    }
+
+    // Present to present interval, of the frames rendered back to back
+    sfInt64 interval = sfTime_asMicroseconds (sfClock_restart (this->presentClock));
+    if (this->isPresented) {
+        ProfilerHistogram_record (this->presentIntervals, interval);
+        Screen_measureRefresh (this, interval);
+    }
+    this->isPresented = true;
+
+    return true;
+}
+
 
-        // Sleep a bit so the CPU doesn't burn
-        sfSleep(sfMilliseconds(1));
+/*
+ * Description : Sleep until the latest time a frame can be rendered before the next vertical sync,
+ *               so the frame presented is made from the newest framebuffer (late latching)
+ * Screen *this : An allocated Screen
+ * Return : void
+ */
+void
+Screen_waitFrame (
+    Screen *this
+) {
+    if (this->calibrationFrames < SCREEN_CALIBRATION_FRAMES) {
+        // The vertical sync paces the presents while the refresh period is measured
+        return;
+    }
+
+    // The vertical syncs follow the last present, one per refresh period
+    sfInt64 elapsed = sfTime_asMicroseconds (sfClock_getElapsedTime (this->presentClock));
+    sfInt64 delay = this->refreshPeriod - (elapsed % this->refreshPeriod) - this->renderTime - SCREEN_FRAME_MARGIN;
+
+    // Too late for this vertical sync : latch for the next one
+    while (delay < 0) {
+        delay += this->refreshPeriod;
+    }
+
+    sfSleep (sfMicroseconds (delay));
+}
+
+
+/*
+ * Description : Draw the screen buffer to the user screen
+ * Screen *this : An allocated Screen
+ * Return : void
+ */
+void
+Screen_loop (
+    Screen *this
+) {
+    PROFILER_THREAD_NAME ("Screen");
+
+    // Rendering loop : each frame is rendered just before the vertical sync
+    while (this->isRunning)
+    {
+        Screen_waitFrame (this);
+        Screen_render (this);
     }
 
     // Request to close the window
@@ -210,9 +455,12 @@ Screen_drawSprite (
     uint8_t *memory,
     uint16_t index
 ) {
+    PROFILER_ZONE ("Sprite");
     bool result = false;
     uint8_t mByte;
 
+    Screen_beginUpdate (this);
+
     if (height == 0) {
 		height = 16;
     }
@@ -231,20 +479,24 @@ Screen_drawSprite (
 				&&  (x + posX) >= 0
 				&&  (y + posY) >= 0)
 				{
-					Pixel *pixel = this->pixels [x + posX + ((y + posY) * RESOLUTION_W)];
+					uint8_t *pixel = &this->framebuffer [x + posX + ((y + posY) * RESOLUTION_W)];
 
-					if (pixel->value == PIXEL_WHITE) {
+					if (*pixel == PIXEL_WHITE) {
 						// A pixel changed from PIXEL_WHITE to PIXEL_BLACK
 						result = true;
 					}
 
 					// Invert pixel color
-					Pixel_invertColor (pixel);
+					*pixel ^= PIXEL_WHITE;
+					this->framebufferHash ^= STATE_HASH_PIXEL (pixel - this->framebuffer);
 				}
             }
         }
     }
 
+    // Publish the sprite drawn to the rendering thread
+    Screen_endUpdate (this);
+
     return result;
 }
 
@@ -262,9 +514,24 @@ Screen_free (
         for (int i = 0; i < RESOLUTION_W * RESOLUTION_H; i++) {
             Pixel_free (this->pixels[i]);
         }
+        for (int i = 0; i < sizeof_array(this->scanLines); i++) {
+            if (this->scanLines[i]) {
+                sfRectangleShape_destroy (this->scanLines[i]);
+            }
+        }
+        ProfilerOverlay_free (this->overlay);
+        if (this->renderClock) {
+            sfClock_destroy (this->renderClock);
+        }
+        if (this->presentClock) {
+            sfClock_destroy (this->presentClock);
+        }
+
+        if (this->window) {
+            sfRenderWindow_destroy (this->window);
+        }
 
-        sfRenderWindow_destroy (this->window);
-        Profiler_free (this->profiler);
+        // The profiler and the histograms belong to the ProfilerFactory registry
         free (this);
     }
 }
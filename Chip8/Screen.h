@@ -4,25 +4,69 @@
 // ---------- Includes ------------
 #include "Utils/Utils.h"
 #include "Pixel.h"
+#include "StateHash.h"
+#include "InputLatency.h"
 #include "Profiler/ProfilerFactory.h"
+#include "Profiler/ProfilerOverlay.h"
 #include <SFML/Graphics.h>
 
 // ---------- Defines -------------
 #define RESOLUTION_W 64
 #define RESOLUTION_H 32
+#define SCREEN_FRAME_PERIOD 16667 // Microseconds between two vertical syncs at 60 Hz, until the refresh period is measured
+#define SCREEN_FRAME_MARGIN 1000  // Microseconds of slack for the sleep, on top of the rendering time
+#define SCREEN_CALIBRATION_FRAMES 30 // Frames presented back to back to measure the refresh period
+#define SCREEN_MIN_REFRESH_PERIOD 4000 // Microseconds, 250 Hz : shorter periods mean no vertical sync
+#define SCREEN_SNAPSHOT_RETRIES 8 // Copies of the framebuffer attempted while the CPU is changing it
 
 // ------ Structure declaration -------
 typedef struct _Screen
 {
-    // Screen display buffer
+    // Screen display buffer : one PixelValue per pixel, written by the CPU
+    uint8_t framebuffer [RESOLUTION_W * RESOLUTION_H];
+
+    // Hash of the framebuffer, updated on each pixel toggled (see StateHash.h)
+    uint64_t framebufferHash;
+
+    // Incremented by the CPU before and after each change of the framebuffer : odd while the
+    // framebuffer is being changed, so the rendering thread can take a whole copy (seqlock)
+    uint32_t framebufferVersion;
+
+    // Copy of the framebuffer drawn by the rendering thread, taken between two changes
+    uint8_t presentedFramebuffer [RESOLUTION_W * RESOLUTION_H];
+
+    // Pixels rendered to the user screen, and the scan lines over them (NULL when headless)
     Pixel * pixels [RESOLUTION_W * RESOLUTION_H];
+    sfRectangleShape *scanLines [(RESOLUTION_H * PIXEL_SIZE) / 2];
+
+    // Profilers drawn over the screen (NULL when headless or without font), and the profilers count shown
+    ProfilerOverlay *overlay;
+    int overlayProfilersCount;
 
-    // SFML window object shared with Window
+    // SFML window object shared with Window (NULL when headless)
     sfRenderWindow *window;
 
     // Profiler for the Screen display
     Profiler * profiler;
 
+    // Durations of the rendering of a frame, and between two presents
+    ProfilerHistogram *renderTimes;
+    ProfilerHistogram *presentIntervals;
+    sfClock *renderClock;
+    sfClock *presentClock;
+    bool isPresented; // The previous frame was presented too
+
+    // Frame pacing : refresh period of the display and time to render a frame, in microseconds
+    sfInt64 refreshPeriod;
+    sfInt64 renderTime;
+    int calibrationFrames;
+
+    // Version of the framebuffer presented last
+    uint32_t presentedVersion;
+
+    // Input to photon latency, measured only when it is set
+    InputLatency *latency;
+
     // Running state
     bool isRunning;
 
@@ -37,7 +81,7 @@ typedef struct _Screen
 
 /*
  * Description     : Allocate a new Screen structure.
- * sfRenderWindow *sfmlWindow : A SFML render window context
+ * sfRenderWindow *sfmlWindow : A SFML render window context, or NULL for a headless screen
  * Return         : A pointer to an allocated Screen.
  */
 Screen *
@@ -50,7 +94,7 @@ Screen_new (
 /*
  * Description : Initialize an allocated Screen structure.
  * Screen *this : An allocated Screen to initialize.
- * sfRenderWindow *sfmlWindow : A SFML render window context
+ * sfRenderWindow *sfmlWindow : A SFML render window context, or NULL for a headless screen
  * Return : true on success, false on failure.
  */
 bool
@@ -80,15 +124,46 @@ Screen_drawSprite (
 );
 
 /*
- * Description : Draw the screen buffer to the user screen
+ * Description : Writer side : the framebuffer is about to be changed
  * Screen *this : An allocated Screen
  * Return : void
  */
 void
+Screen_beginUpdate (
+    Screen *this
+);
+
+/*
+ * Description : Writer side : publish the framebuffer changed since Screen_beginUpdate
+ * Screen *this : An allocated Screen
+ * Return : void
+ */
+void
+Screen_endUpdate (
+    Screen *this
+);
+
+/*
+ * Description : Render and present the screen buffer, if it changed since the last present
+ * Screen *this : An allocated Screen
+ * Return : bool, false when there was nothing new to present
+ */
+bool
 Screen_render (
     Screen *this
 );
 
+/*
+ * Description : Sleep until the latest time a frame can be rendered before the next vertical sync,
+ *               so the frame presented is made from the newest framebuffer (late latching)
+ * Screen *this : An allocated Screen
+ * Return : void
+ */
+void
+Screen_waitFrame (
+    Screen *this
+);
+
 /*
  * Description : Clear the screen
  * Screen *this : An allocated Screen
@@ -99,6 +174,16 @@ Screen_clear (
     Screen *this
 );
 
+/*
+ * Description : Compute again the framebuffer hash from the whole framebuffer
+ * Screen *this : An allocated Screen
+ * Return : void
+ */
+void
+Screen_rehash (
+    Screen *this
+);
+
 /*
  * Description : Start the main loop of the screen rendering in a separate thread.
  * Screen *this : An allocated Screen
@@ -0,0 +1,39 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include <stdint.h>
+
+// ---------- Defines -------------
+
+/*
+ *    Incremental hashes of the memory and of the framebuffer (Zobrist style) :
+ *    the hash of a buffer is the XOR of the hashes of its non-zero cells, so a write
+ *    only XORs out the old cell and XORs in the new one. Zeroed buffers hash to 0.
+ */
+#define STATE_HASH_BYTE(address, value) \
+    ((value) ? StateHash_mix (((uint64_t) (address) << 8) | (value)) : 0)
+
+#define STATE_HASH_PIXEL(pos) \
+    StateHash_mix (0x100000 | (uint64_t) (pos))
+
+
+// ----------- Functions ------------
+
+/*
+ * Description : Mix a 64 bits value (splitmix64 finalizer)
+ * uint64_t value : The value to mix
+ * Return : uint64_t the mixed value
+ */
+static inline uint64_t
+StateHash_mix (
+    uint64_t value
+) {
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ULL;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBULL;
+    value ^= value >> 31;
+
+    return value;
+}
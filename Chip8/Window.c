@@ -36,6 +36,24 @@ Window_new (void)
 }
 
 
+/*
+ * Emit a beep, in the beep thread : the event loop sleeps until the next event,
+ * and the CPU must not wait for the sound to end
+ */
+static void
+Window_beep (
+    Window *this
+) {
+    #ifdef WIN32
+        Beep (440, 120);
+    #else
+        dbg ("Beep !");
+    #endif
+
+    __atomic_store_n (&this->isBeeping, false, __ATOMIC_RELEASE);
+}
+
+
 /*
  * Description : Initialize an allocated Window structure.
  * Window *this : An allocated Window to initialize.
@@ -67,8 +85,14 @@ Window_init (
     sfRenderWindow_setVerticalSyncEnabled (this->sfmlWindow, true);
     sfRenderWindow_setActive (this->sfmlWindow, false);
 
-    // Reset keys state
-    memset (this->keysState, KEY_RELEASED, sizeof (this->keysState));
+    // Key events queue
+    if ((this->keyQueue = KeyQueue_new ()) == NULL) {
+        return false;
+    }
+    this->keysDown = 0;
+
+    // Beeps are emitted in their own thread
+    this->beepThread = sfThread_create ((void (*)(void*)) Window_beep, this);
 
     // Initialize the profiler
     this->profiler = ProfilerFactory_getProfiler ("Window");
@@ -87,35 +111,16 @@ Window_init (
  */
 void
 Window_requestBeep (void) {
-    g_this->beepRequest = true;
-}
-
-
-/*
- * Description : Set a key at a given state
- * C8KeyCode code : The key targeted
- * KeyState state : The new state of the key
- * Return : void
- */
-void
-Window_setKeyState (
-    C8KeyCode code,
-    KeyState state
-) {
-    g_this->keysState[code] = state;
-}
-
+    // Headless machines have no window to beep
+    if (g_this == NULL) {
+        return;
+    }
 
-/*
- * Description : Retrieve the state of a given key
- * C8KeyCode code : The requested key
- * Return : keyState
- */
-KeyState
-Window_getKeyState (
-    C8KeyCode code
-) {
-    return g_this->keysState[code];
+    // A beep requested while another one is emitted is skipped
+    bool isBeeping = false;
+    if (__atomic_compare_exchange_n (&g_this->isBeeping, &isBeeping, true, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        sfThread_launch (g_this->beepThread);
+    }
 }
 
 
@@ -144,24 +149,22 @@ void
 Window_stopThread (
     Window *this
 ) {
+    // The loop sleeps until the next event, it stops once it is received
     this->isRunning = false;
     sfThread_wait (this->thread);
 }
 
 
 /*
- * Description : Main loop handling the window events
- * Window *this : An allocated Window
- * Return : void
+ * Handle an event of the window
  */
-void
-Window_loop (
-    Window *this
+static void
+Window_handleEvent (
+    Window *this,
+    sfEvent *event
 ) {
-    sfEvent event;
-
     // Association CHIP-8 keycode <-> SFML KeyCode
-    C8KeyCode sfmlToC8Codes [] = {
+    static const C8KeyCode sfmlToC8Codes [] = {
         [sfKeyNum1] = keyCode_1,
         [sfKeyNum2] = keyCode_2,
         [sfKeyNum3] = keyCode_3,
@@ -180,93 +183,134 @@ Window_loop (
         [sfKeyV] = keyCode_V
     };
 
-    // Poll SFML window events
-    while (this->isRunning)
+    switch (event->type)
     {
-        Profiler_tick (this->profiler);
-
-        while (sfRenderWindow_pollEvent (this->sfmlWindow, &event))
-        {
-            switch (event.type)
-            {
-                case sfEvtClosed:
+        case sfEvtClosed:
+            this->isRunning = false;
+            break;
+        break;
+
+        case sfEvtKeyPressed:
+        case sfEvtKeyReleased:
+            switch (event->key.code) {
+                case sfKeyEscape:
+                    // ESCAPE : Quit
                     this->isRunning = false;
                     break;
                 break;
 
-                case sfEvtKeyPressed:
-                case sfEvtKeyReleased:
-                    switch (event.key.code) {
-                        case sfKeyEscape:
-                            // ESCAPE : Quit
-                            this->isRunning = false;
-                            break;
-                        break;
+                case sfKeyF1:
+                    // F1 : Print the frame timings percentiles
+                    if (event->type == sfEvtKeyPressed) {
+                        ProfilerFactory_reportHistograms (stdout);
+                    }
+                break;
 
-                        case sfKeyNum1:
-                        case sfKeyNum2:
-                        case sfKeyNum3:
-                        case sfKeyNum4:
-                        case sfKeyA:
-                        case sfKeyZ:
-                        case sfKeyE:
-                        case sfKeyR:
-                        case sfKeyQ:
-                        case sfKeyS:
-                        case sfKeyD:
-                        case sfKeyW:
-                        case sfKeyX:
-                        case sfKeyC:
-                        case sfKeyV: {
-                            C8KeyCode code = sfmlToC8Codes[event.key.code];
-                            if (event.type == sfEvtKeyPressed) {
-                                switch (this->keysState[code]) {
-                                    case KEY_PRESSED:
-                                        // Don't accept inputs already pushed, set the key state in a waiting state
-                                        this->keysState[code] = KEY_PUSHED;
-                                    break;
-
-                                    case KEY_RELEASED:
-                                        this->keysState[code] = KEY_PRESSED;
-                                    break;
-
-                                    default: // KEY_PUSHED : Do nothing
-                                    break;
-                                }
-                            } else {
-                                this->keysState[code] = KEY_RELEASED;
-                            }
-                        }
+                case sfKeyNum1:
+                case sfKeyNum2:
+                case sfKeyNum3:
+                case sfKeyNum4:
+                case sfKeyA:
+                case sfKeyZ:
+                case sfKeyE:
+                case sfKeyR:
+                case sfKeyQ:
+                case sfKeyS:
+                case sfKeyD:
+                case sfKeyW:
+                case sfKeyX:
+                case sfKeyC:
+                case sfKeyV: {
+                    C8KeyCode code = sfmlToC8Codes[event->key.code];
+                    bool isPressed = (event->type == sfEvtKeyPressed);
+
+                    // The key repeat sends presses while the key is held down : only changes are sent
+                    if (isPressed == ((this->keysDown >> code) & 1)) {
                         break;
+                    }
+                    this->keysDown ^= 1 << code;
 
-                        default:
-                            dbg ("Warning : keycode = '%x' unhandled", event.key.code);
-                        break;
+                    if (isPressed && this->latency) {
+                        InputLatency_press (this->latency, code);
                     }
+
+                    // The CPU applies the event at the start of its next slice
+                    KeyQueue_push (this->keyQueue, code, isPressed);
+                }
                 break;
 
-                default :
+                default:
+                    dbg ("Warning : keycode = '%x' unhandled", event->key.code);
                 break;
             }
-        }
+        break;
+
+        default :
+        break;
+    }
+}
+
+
+/*
+ * Description : Main loop handling the window events
+ * Window *this : An allocated Window
+ * Return : void
+ */
+void
+Window_loop (
+    Window *this
+) {
+    sfEvent event;
 
-        // Check if a beep is requested
-        if (this->beepRequest) {
-            #ifdef WIN32
-                Beep (440, 120);
-            #else
-                dbg ("Beep !");
-            #endif
+    PROFILER_THREAD_NAME ("Window");
 
-            this->beepRequest = false;
+    // Sleep until SFML window events arrive
+    while (this->isRunning && sfRenderWindow_waitEvent (this->sfmlWindow, &event))
+    {
+        Profiler_tick (this->profiler);
+
+        if (this->latency) {
+            InputLatency_wake (this->latency);
         }
 
-        // Sleep a bit so the CPU doesn't burn
-        sfSleep(sfMilliseconds(1));
+        // Handle the event received, then the ones pending
+        PROFILER_ZONE_BEGIN ("Events");
+        do {
+            Window_handleEvent (this, &event);
+        } while (this->isRunning && sfRenderWindow_pollEvent (this->sfmlWindow, &event));
+        PROFILER_ZONE_END ();
     }
 
 }
 
+
+/*
+ * Description : Handle the pending events of the window, without waiting
+ * Window *this : An allocated Window
+ * Return : void
+ */
+void
+Window_pollEvents (
+    Window *this
+) {
+    sfEvent event;
+    bool isAwake = false;
+
+    Profiler_tick (this->profiler);
+
+    PROFILER_ZONE_BEGIN ("Events");
+    while (this->isRunning && sfRenderWindow_pollEvent (this->sfmlWindow, &event)) {
+        // Most polls find no key : the wake up is the first key event handled
+        if (this->latency && !isAwake
+        && (event.type == sfEvtKeyPressed || event.type == sfEvtKeyReleased)) {
+            InputLatency_wake (this->latency);
+            isAwake = true;
+        }
+        Window_handleEvent (this, &event);
+    }
+    PROFILER_ZONE_END ();
+}
+
 /*
  * Description : Free an allocated Window structure.
  * Window *this : An allocated Window to free.
@@ -277,6 +321,10 @@ Window_free (
 ) {
     if (this != NULL)
     {
+        if (this->beepThread) {
+            sfThread_destroy (this->beepThread);
+        }
+        KeyQueue_free (this->keyQueue);
         free (this);
     }
 }
@@ -4,6 +4,7 @@
 // ---------- Includes ------------
 #include "Utils/Utils.h"
 #include "Screen.h"
+#include "KeyQueue.h"
 #include <SFML/Graphics.h>
 #include <stdint.h>
 
@@ -54,14 +55,16 @@ typedef struct _Window
     // SFML window object
     sfRenderWindow *sfmlWindow;
 
-    // Keys states
-    uint8_t keysState [KEYS_COUNT];
+    // Key events sent to the CPU, and the keys held down to filter the key repeat
+    KeyQueue *keyQueue;
+    uint16_t keysDown;
 
     // Running state
     bool isRunning;
 
-    // Flag true if CPU requested a beep
-    bool beepRequest;
+    // Thread emitting a beep requested by the CPU, and true until the beep ends
+    sfThread *beepThread;
+    bool isBeeping;
 
     // Thread object pointer
     sfThread *thread;
@@ -69,6 +72,9 @@ typedef struct _Window
     // Profiler
     Profiler * profiler;
 
+    // Input to photon latency, measured only when it is set
+    InputLatency *latency;
+
 }    Window;
 
 
@@ -113,6 +119,16 @@ Window_loop (
     Window *this
 );
 
+/*
+ * Description : Handle the pending events of the window, without waiting
+ * Window *this : An allocated Window
+ * Return : void
+ */
+void
+Window_pollEvents (
+    Window *this
+);
+
 /*
  * Description : Stop the separate thread for the Window
  * Window *this : An allocated Window
@@ -140,28 +156,6 @@ Window_startThread (
 void
 Window_requestBeep (void);
 
-/*
- * Description : Retrieve the state of a given key
- * C8KeyCode code : The requested key
- * Return : keyState
- */
-KeyState
-Window_getKeyState (
-    C8KeyCode code
-);
-
-/*
- * Description : Set a key at a given state
- * C8KeyCode code : The key targeted
- * KeyState state : The new state of the key
- * Return : void
- */
-void
-Window_setKeyState (
-    C8KeyCode code,
-    KeyState state
-);
-
 // --------- Destructors ----------
 
 /*
@@ -44,37 +44,23 @@ Profiler_init (
 ) {
     this->id = id;
     this->ticksCount = 0;
-    this->clock = NULL;
+    this->snapshotTicks = 0;
+    this->ticksPerSecond = 0;
     this->name = name;
 
-    this->text = sfText_create ();
-    sfText_setFont (this->text, sfFont_createFromFile("verdana.ttf"));
-    sfText_setCharacterSize (this->text, 15);
-    sfText_setColor (this->text, sfRed);
-    sfText_setPosition (this->text, (sfVector2f) {.x = 0, .y = 0 + (id * 15)});
-
-    return true;
-}
+    // Created here rather than on the first tick : the reader may use it before
+    if ((this->clock = sfClock_create ()) == NULL) {
+        return false;
+    }
 
+    Profiler_update (this);
 
-/*
- * Description : Tick the profiler
- * Profiler *this : An allocated Profiler
- * Return : void
- */
-inline void
-Profiler_tick (
-    Profiler *this
-) {
-    if (!this->clock) {
-        Profiler_start(this);
-    }
-    this->ticksCount++;
+    return true;
 }
 
 
 /*
- * Description : Update a profiler text
+ * Description : Update a profiler text with the ticks per second of the last snapshot
  * Profiler *this : An allocated Profiler
  * Return : void
  */
@@ -82,14 +68,12 @@ void
 Profiler_update (
     Profiler *this
 ) {
-    unsigned char buffer[1024];
-    sprintf (buffer, "%s = %u T/s\n", this->name, this->ticksCount);
-    sfText_setString (this->text, buffer);
+    snprintf (this->text, sizeof(this->text), "%s = %u T/s", this->name, this->ticksPerSecond);
 }
 
 
 /*
- * Description : Get seconds elasped since the last restart
+ * Description : Get seconds elasped since the last snapshot
  * Profiler *this : An allocated Profiler
  * Return : float, seconds
  */
@@ -101,29 +85,19 @@ Profiler_getTime (
 }
 
 /*
- * Description :
+ * Description : Snapshot the counter : compute the ticks per second since the last snapshot
  * Profiler *this : An allocated Profiler
  * Return : void
  */
 void
-Profiler_restart (
+Profiler_snapshot (
     Profiler *this
 ) {
-    this->ticksCount = 0;
-    sfClock_restart (this->clock);
-}
+    uint64_t ticks = __atomic_load_n (&this->ticksCount, __ATOMIC_RELAXED);
+    float seconds = sfTime_asSeconds (sfClock_restart (this->clock));
 
-/*
- * Description : Start profiling
- * Profiler *this : An allocated Profiler to initialize.
- * Return : void
- */
-void
-Profiler_start (
-    Profiler * this
-) {
-    this->clock = sfClock_create ();
-    this->ticksCount = 0;
+    this->ticksPerSecond = (seconds > 0) ? (ticks - this->snapshotTicks) / seconds : 0;
+    this->snapshotTicks = ticks;
 }
 
 
@@ -136,9 +110,9 @@ Profiler_free (
     Profiler *this
 ) {
     if (this != NULL) {
-        sfClock_destroy (this->clock);
-        sfFont_destroy ((sfFont *) sfText_getFont (this->text));
-        sfText_destroy (this->text);
+        if (this->clock) {
+            sfClock_destroy (this->clock);
+        }
         free (this);
     }
 }
@@ -3,21 +3,33 @@
 
 // ---------- Includes ------------
 #include "Utils/Utils.h"
+#include "ProfilerZone.h"
 #include <SFML/System.h>
-#include <SFML/Graphics.h>
 
 // ---------- Defines -------------
+#define PROFILER_TEXT_SIZE 64
 
 
 // ------ Structure declaration -------
 typedef int ProfilerId;
 
+/*
+ *    A counter of ticks per second. It is ticked by one thread, its owner, and read by the
+ *    thread drawing the overlay : the owner only increments ticksCount (relaxed atomic),
+ *    the reader computes the rate from its own snapshots and never writes the counter.
+ */
 typedef struct _Profiler
 {
-    unsigned int ticksCount;
+    // Written by the owner thread only
+    uint64_t ticksCount;
+
+    // Read side : ticks at the last snapshot, and the time since it
+    uint64_t snapshotTicks;
+    unsigned int ticksPerSecond;
     sfClock *clock;
 
-    sfText *text;
+    // Line of the overlay, updated by Profiler_update
+    char text [PROFILER_TEXT_SIZE];
     const char *name;
 
     ProfilerId id;
@@ -67,17 +79,20 @@ Profiler_test (
 );
 
 /*
- * Description : Tick the profiler
+ * Description : Tick the profiler, from its owner thread
  * Profiler *this : An allocated Profiler
  * Return : void
  */
-void
+static inline void
 Profiler_tick (
     Profiler *this
-);
+) {
+    // Single writer : no read-modify-write needed, the store only has to be atomic for the reader
+    __atomic_store_n (&this->ticksCount, this->ticksCount + 1, __ATOMIC_RELAXED);
+}
 
 /*
- * Description : Get seconds elasped since the last restart
+ * Description : Get seconds elasped since the last snapshot
  * Profiler *this : An allocated Profiler
  * Return : float, seconds
  */
@@ -87,27 +102,17 @@ Profiler_getTime (
 );
 
 /*
- * Description :
+ * Description : Snapshot the counter : compute the ticks per second since the last snapshot
  * Profiler *this : An allocated Profiler
  * Return : void
  */
 void
-Profiler_restart (
+Profiler_snapshot (
     Profiler *this
 );
 
 /*
- * Description : Start profiling
- * Profiler *this : An allocated Profiler to initialize.
- * Return : void
- */
-void
-Profiler_start (
-    Profiler * this
-);
-
-/*
- * Description : Update a profiler text
+ * Description : Update a profiler text with the ticks per second of the last snapshot
  * Profiler *this : An allocated Profiler
  * Return : void
  */
@@ -0,0 +1,49 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include <stdint.h>
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+// ---------- Defines -------------
+
+/*
+ *    Monotonic clock of the timestamps compared between threads : key presses, tone changes,
+ *    profiler zones... QueryPerformanceCounter on Windows, CLOCK_MONOTONIC elsewhere.
+ *    sfClock only counts microseconds from its own creation, too coarse for the shortest zones.
+ */
+
+
+// ----------- Functions ------------
+
+/*
+ * Description : Read the monotonic clock
+ * Return : uint64_t nanoseconds since an arbitrary origin, the same for all the threads
+ */
+static inline uint64_t
+ProfilerClock_nanoseconds (void) {
+    #ifdef WIN32
+        LARGE_INTEGER counter, frequency;
+        QueryPerformanceCounter (&counter);
+        QueryPerformanceFrequency (&frequency);
+        return (uint64_t) (counter.QuadPart / frequency.QuadPart) * 1000000000ULL
+             + (uint64_t) (counter.QuadPart % frequency.QuadPart) * 1000000000ULL / frequency.QuadPart;
+    #else
+        struct timespec now;
+        clock_gettime (CLOCK_MONOTONIC, &now);
+        return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+    #endif
+}
+
+/*
+ * Description : Read the monotonic clock
+ * Return : uint64_t microseconds since an arbitrary origin, the same for all the threads
+ */
+static inline uint64_t
+ProfilerClock_microseconds (void) {
+    return ProfilerClock_nanoseconds () / 1000;
+}
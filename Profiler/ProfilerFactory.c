@@ -5,115 +5,147 @@
 #define __DEBUG_OBJECT__ "ProfilerFactory"
 #include "dbg/dbg.h"
 
-// Private structure declaration
-struct _ProfilerFactory
-{
-    BbQueue  *profilersQueue;    // The queue receive all the profilers
-    Profiler **profilersArray;    // The array is created from the queue once all the profilers have been received
-    int profilersArraySize;
+// Registry : slots reserved by profilersCount, published in profilers
+static Profiler *profilers [PROFILER_FACTORY_MAX_PROFILERS];
+static int profilersCount = 0;
+static ProfilerHistogram *histograms [PROFILER_FACTORY_MAX_HISTOGRAMS];
+static int histogramsCount = 0;
 
-    // Singleton
-} * this = NULL;
 
 /*
- * Description     : Allocate and initialize a new ProfilerFactory structure.
- * Return        : bool, true on success, false otherwise
+ * Description : Add a profiler to the registry
+ * char * name : Name of the profiler (optional, can be NULL)
+ * Return : Profiler * a new Profiler, NULL when the registry is full
  */
-bool
-ProfilerFactory_init (void)
-{
-    if ((this = calloc (1, sizeof(ProfilerFactory))) == NULL)
-        return false;
+Profiler *
+ProfilerFactory_getProfiler (
+    char *name
+) {
+    // Get a new Profiler ID
+    ProfilerId id = __atomic_fetch_add (&profilersCount, 1, __ATOMIC_RELAXED);
 
-    this->profilersQueue = bb_queue_new ();
-    this->profilersArray = NULL;
+    if (id >= PROFILER_FACTORY_MAX_PROFILERS) {
+        dbg ("Error : No more than %d profilers can be registered.", PROFILER_FACTORY_MAX_PROFILERS);
+        return NULL;
+    }
+
+    // Instantiate a new profiler, and publish it once it is initialized
+    Profiler *profiler = Profiler_new (id, name);
+    __atomic_store_n (&profilers[id], profiler, __ATOMIC_RELEASE);
 
-    return true;
+    return profiler;
 }
 
 
 /*
- * Description : Add a profiler to the ProfilerFactory
- * Return : Profiler * a new Profiler
+ * Description : Copy the profilers registered so far, sorted by ID
+ * Profiler **snapshot : (out) array of at least PROFILER_FACTORY_MAX_PROFILERS profilers
+ * Return : int the number of profilers copied
  */
-Profiler *
-ProfilerFactory_getProfiler (char *name)
-{
-    if (!this) {
-        ProfilerFactory_init ();
+int
+ProfilerFactory_getSnapshot (
+    Profiler **snapshot
+) {
+    int count = __atomic_load_n (&profilersCount, __ATOMIC_RELAXED);
+    int snapshotCount = 0;
+
+    for (int id = 0; id < count && id < PROFILER_FACTORY_MAX_PROFILERS; id++) {
+        // A slot reserved but not published yet is skipped
+        Profiler *profiler = __atomic_load_n (&profilers[id], __ATOMIC_ACQUIRE);
+        if (profiler != NULL) {
+            snapshot[snapshotCount++] = profiler;
+        }
     }
 
-    // Get a new Profiler ID
-    ProfilerId id = bb_queue_get_length (this->profilersQueue);
+    return snapshotCount;
+}
 
-    // Instantiate a new profiler
-    Profiler *profiler = Profiler_new (id, name);
 
-    // Add it to the queue of profilers
-    bb_queue_add (this->profilersQueue, profiler);
+/*
+ * Description : Add a histogram of durations to the registry
+ * const char *name : Name of the durations measured, a static string
+ * Return : ProfilerHistogram * a new ProfilerHistogram, NULL when the registry is full
+ */
+ProfilerHistogram *
+ProfilerFactory_getHistogram (
+    const char *name
+) {
+    int id = __atomic_fetch_add (&histogramsCount, 1, __ATOMIC_RELAXED);
 
-    return profiler;
+    if (id >= PROFILER_FACTORY_MAX_HISTOGRAMS) {
+        dbg ("Error : No more than %d histograms can be registered.", PROFILER_FACTORY_MAX_HISTOGRAMS);
+        return NULL;
+    }
+
+    ProfilerHistogram *histogram = ProfilerHistogram_new (name);
+    __atomic_store_n (&histograms[id], histogram, __ATOMIC_RELEASE);
+
+    return histogram;
 }
 
 
 /*
- * Description : Get all the profilers as an array. Once it is called, free the queue
- * int *size : (out) size of the profiler array
- * Return : Profiler **profilersArray, array of Profiler *
+ * Description : Copy the histograms registered so far
+ * ProfilerHistogram **snapshot : (out) array of at least PROFILER_FACTORY_MAX_HISTOGRAMS histograms
+ * Return : int the number of histograms copied
  */
-Profiler **
-ProfilerFactory_getArray (
-    int *size
+int
+ProfilerFactory_getHistogramsSnapshot (
+    ProfilerHistogram **snapshot
 ) {
-    if (this->profilersArray == NULL)
-    {
-        // Queue to array so we have a O(1) access to profilers
-        this->profilersArraySize = bb_queue_get_length (this->profilersQueue);
-        this->profilersArray = malloc (sizeof(Profiler *) * this->profilersArraySize);
-
-        while (bb_queue_get_length (this->profilersQueue))
-        {
-            Profiler *profiler = bb_queue_pop (this->profilersQueue);
-            ProfilerId id = profiler->id;
-            this->profilersArray[id] = profiler;
-        }
+    int count = __atomic_load_n (&histogramsCount, __ATOMIC_RELAXED);
+    int snapshotCount = 0;
 
-        // Clean queue memory
-        bb_queue_free (this->profilersQueue);
-        this->profilersQueue = NULL;
+    for (int id = 0; id < count && id < PROFILER_FACTORY_MAX_HISTOGRAMS; id++) {
+        ProfilerHistogram *histogram = __atomic_load_n (&histograms[id], __ATOMIC_ACQUIRE);
+        if (histogram != NULL) {
+            snapshot[snapshotCount++] = histogram;
+        }
     }
 
-    *size = this->profilersArraySize;
-    return this->profilersArray;
+    return snapshotCount;
 }
 
 
-
-
 /*
- * Description : Free an allocated ProfilerFactory structure.
- * ProfilerFactory *this : An allocated ProfilerFactory to free.
+ * Description : Write the percentiles of all the histograms registered, one per line
+ * FILE *output : Where the report is written
+ * Return : void
  */
 void
-ProfilerFactory_free (
-    ProfilerFactory *this
+ProfilerFactory_reportHistograms (
+    FILE *output
 ) {
-    if (this != NULL)
-    {
-        free (this);
+    ProfilerHistogram *snapshot [PROFILER_FACTORY_MAX_HISTOGRAMS];
+    int count = ProfilerFactory_getHistogramsSnapshot (snapshot);
+
+    for (int id = 0; id < count; id++) {
+        char text [PROFILER_HISTOGRAM_TEXT_SIZE];
+        ProfilerHistogram_format (snapshot[id], text);
+        fprintf (output, "%s\n", text);
     }
 }
 
 
 /*
- * Description : Unit tests checking if a ProfilerFactory is coherent
- * ProfilerFactory *this : The instance to test
- * Return : true on success, false on failure
+ * Description : Free the profilers and the histograms registered, and empty the registry.
+ *               Only once no thread uses them anymore, e.g. at shutdown.
+ * Return : void
  */
-bool
-ProfilerFactory_test (
-    ProfilerFactory *this
-) {
+void
+ProfilerFactory_free (void)
+{
+    int count = __atomic_load_n (&profilersCount, __ATOMIC_RELAXED);
+    for (int id = 0; id < count && id < PROFILER_FACTORY_MAX_PROFILERS; id++) {
+        Profiler_free (profilers[id]);
+        profilers[id] = NULL;
+    }
+    __atomic_store_n (&profilersCount, 0, __ATOMIC_RELAXED);
 
-    return true;
+    count = __atomic_load_n (&histogramsCount, __ATOMIC_RELAXED);
+    for (int id = 0; id < count && id < PROFILER_FACTORY_MAX_HISTOGRAMS; id++) {
+        ProfilerHistogram_free (histograms[id]);
+        histograms[id] = NULL;
+    }
+    __atomic_store_n (&histogramsCount, 0, __ATOMIC_RELAXED);
 }
@@ -3,66 +3,79 @@
 
 // ---------- Includes ------------
 #include "Profiler.h"
+#include "ProfilerHistogram.h"
 #include "Utils/Utils.h"
-#include "BbQueue/BbQueue.h"
 
 // ---------- Defines -------------
+#define PROFILER_FACTORY_MAX_PROFILERS 32
+#define PROFILER_FACTORY_MAX_HISTOGRAMS 16
 
-
-// ------ Structure declaration -------
-typedef struct _ProfilerFactory ProfilerFactory;
-
-
-// --------- Allocators ---------
+/*
+ *    Registry of the profilers and of the histograms : fixed arrays, filled from any thread at any time.
+ *    A slot is reserved with an atomic increment, then published with a release store :
+ *    the readers take a snapshot of the slots published so far.
+ *    The registry owns the profilers and the histograms : they live until ProfilerFactory_free,
+ *    so a snapshot never holds a freed one.
+ */
 
 // ----------- Functions ------------
 
 /*
- * Description : Initialize an allocated ProfilerFactory structure.
- * ProfilerFactory *this : An allocated ProfilerFactory to initialize.
+ * Description : Add a profiler to the registry
+ * char * name : Name of the profiler (optional, can be NULL)
+ * Return : Profiler * a new Profiler, NULL when the registry is full
  */
-bool
-ProfilerFactory_init (void);
+Profiler *
+ProfilerFactory_getProfiler (
+    char *name
+);
 
 /*
- * Description : Unit tests checking if a ProfilerFactory is coherent
- * ProfilerFactory *this : The instance to test
- * Return : true on success, false on failure
+ * Description : Copy the profilers registered so far, sorted by ID
+ * Profiler **snapshot : (out) array of at least PROFILER_FACTORY_MAX_PROFILERS profilers
+ * Return : int the number of profilers copied
  */
-bool
-ProfilerFactory_test (
-    ProfilerFactory *this
+int
+ProfilerFactory_getSnapshot (
+    Profiler **snapshot
 );
 
 /*
- * Description : Add a profiler to the ProfilerFactory
- * char * name : Name of the profiler (optional, can be NULL)
- * Return : Profiler * a new Profiler
+ * Description : Add a histogram of durations to the registry
+ * const char *name : Name of the durations measured, a static string
+ * Return : ProfilerHistogram * a new ProfilerHistogram, NULL when the registry is full
  */
-Profiler *
-ProfilerFactory_getProfiler (
-    char *name
+ProfilerHistogram *
+ProfilerFactory_getHistogram (
+    const char *name
 );
 
 /*
- * Description : Get all the profilers as an array. Once it is called, free the queue
- * int *size : (out) size of the profiler array
- * Return : Profiler **profilersArray, array of Profiler *
+ * Description : Copy the histograms registered so far
+ * ProfilerHistogram **snapshot : (out) array of at least PROFILER_FACTORY_MAX_HISTOGRAMS histograms
+ * Return : int the number of histograms copied
  */
-Profiler **
-ProfilerFactory_getArray (
-    int *size
+int
+ProfilerFactory_getHistogramsSnapshot (
+    ProfilerHistogram **snapshot
 );
 
-// --------- Destructors ----------
-
 /*
- * Description : Free an allocated ProfilerFactory structure.
- * ProfilerFactory *this : An allocated ProfilerFactory to free.
+ * Description : Write the percentiles of all the histograms registered, one per line
+ * FILE *output : Where the report is written
+ * Return : void
  */
 void
-ProfilerFactory_free (
-    ProfilerFactory *this
+ProfilerFactory_reportHistograms (
+    FILE *output
 );
 
+// --------- Destructors ----------
 
+/*
+ * Description : Free the profilers and the histograms registered, and empty the registry.
+ *               Only once no thread uses them anymore, e.g. at shutdown.
+ * Return : void
+ */
+void
+ProfilerFactory_free (void);
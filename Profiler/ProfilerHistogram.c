@@ -0,0 +1,161 @@
+#include "ProfilerHistogram.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "ProfilerHistogram"
+#include "dbg/dbg.h"
+
+/*
+ * Description     : Allocate a new ProfilerHistogram structure.
+ * const char *name : Name of the durations measured, a static string
+ * Return        : A pointer to an allocated ProfilerHistogram.
+ */
+ProfilerHistogram *
+ProfilerHistogram_new (
+    const char *name
+) {
+    ProfilerHistogram *this;
+
+    if ((this = calloc (1, sizeof(ProfilerHistogram))) == NULL)
+        return NULL;
+
+    this->name = name;
+
+    return this;
+}
+
+
+/*
+ * Bucket of a value : the values under PROFILER_HISTOGRAM_SUB_BUCKETS have their own bucket,
+ * the others are in one of the PROFILER_HISTOGRAM_SUB_BUCKETS buckets of their power of 2
+ */
+static inline int
+ProfilerHistogram_getBucket (
+    uint64_t value
+) {
+    if (value >= (1ULL << PROFILER_HISTOGRAM_MAX_BITS)) {
+        return PROFILER_HISTOGRAM_BUCKETS - 1;
+    }
+    if (value < PROFILER_HISTOGRAM_SUB_BUCKETS) {
+        return value;
+    }
+
+    int shift = (63 - __builtin_clzll (value)) - PROFILER_HISTOGRAM_SUB_BITS;
+
+    return (shift + 1) * PROFILER_HISTOGRAM_SUB_BUCKETS + (value >> shift) - PROFILER_HISTOGRAM_SUB_BUCKETS;
+}
+
+
+/*
+ * Highest value of a bucket
+ */
+static inline uint64_t
+ProfilerHistogram_getBucketValue (
+    int bucket
+) {
+    if (bucket < PROFILER_HISTOGRAM_SUB_BUCKETS) {
+        return bucket;
+    }
+
+    int shift = bucket / PROFILER_HISTOGRAM_SUB_BUCKETS - 1;
+    uint64_t low = (uint64_t) (bucket % PROFILER_HISTOGRAM_SUB_BUCKETS + PROFILER_HISTOGRAM_SUB_BUCKETS) << shift;
+
+    return low + (1ULL << shift) - 1;
+}
+
+
+/*
+ * Description : Record a duration, from the recording thread
+ * ProfilerHistogram *this : An allocated ProfilerHistogram
+ * uint64_t microseconds : The duration
+ * Return : void
+ */
+void
+ProfilerHistogram_record (
+    ProfilerHistogram *this,
+    uint64_t microseconds
+) {
+    int bucket = ProfilerHistogram_getBucket (microseconds);
+
+    // Single writer : plain increments, only atomic for the readers
+    __atomic_store_n (&this->counts[bucket], this->counts[bucket] + 1, __ATOMIC_RELAXED);
+
+    if (microseconds > this->max) {
+        __atomic_store_n (&this->max, microseconds, __ATOMIC_RELAXED);
+    }
+}
+
+
+/*
+ * Description : Get a percentile of the durations recorded
+ * ProfilerHistogram *this : An allocated ProfilerHistogram
+ * double percentile : Between 0 and 100
+ * Return : uint64_t the duration in microseconds, the highest value of its bucket
+ */
+uint64_t
+ProfilerHistogram_getPercentile (
+    ProfilerHistogram *this,
+    double percentile
+) {
+    uint64_t counts [PROFILER_HISTOGRAM_BUCKETS];
+    uint64_t total = 0;
+
+    // Snapshot : the total is the one of the buckets read, even while durations are recorded
+    for (int bucket = 0; bucket < PROFILER_HISTOGRAM_BUCKETS; bucket++) {
+        counts[bucket] = __atomic_load_n (&this->counts[bucket], __ATOMIC_RELAXED);
+        total += counts[bucket];
+    }
+
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t) (percentile / 100.0 * total + 0.5);
+    rank = (rank < 1) ? 1 : (rank > total) ? total : rank;
+
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < PROFILER_HISTOGRAM_BUCKETS; bucket++) {
+        if ((seen += counts[bucket]) >= rank) {
+            uint64_t value = ProfilerHistogram_getBucketValue (bucket);
+            uint64_t max = __atomic_load_n (&this->max, __ATOMIC_RELAXED);
+            return (value < max) ? value : max;
+        }
+    }
+
+    return __atomic_load_n (&this->max, __ATOMIC_RELAXED);
+}
+
+
+/*
+ * Description : Write the percentiles of the histogram, e.g. "Present : p50 16.6 p95 17.1 p99 33.3 max 50.0 ms"
+ * ProfilerHistogram *this : An allocated ProfilerHistogram
+ * char *buffer : Where the text is written, at least PROFILER_HISTOGRAM_TEXT_SIZE bytes
+ * Return : void
+ */
+void
+ProfilerHistogram_format (
+    ProfilerHistogram *this,
+    char *buffer
+) {
+    snprintf (buffer, PROFILER_HISTOGRAM_TEXT_SIZE, "%s : p50 %.2f p95 %.2f p99 %.2f max %.2f ms",
+        this->name,
+        ProfilerHistogram_getPercentile (this, 50) / 1000.0,
+        ProfilerHistogram_getPercentile (this, 95) / 1000.0,
+        ProfilerHistogram_getPercentile (this, 99) / 1000.0,
+        __atomic_load_n (&this->max, __ATOMIC_RELAXED) / 1000.0);
+}
+
+
+/*
+ * Description : Free an allocated ProfilerHistogram structure.
+ * ProfilerHistogram *this : An allocated ProfilerHistogram to free.
+ */
+void
+ProfilerHistogram_free (
+    ProfilerHistogram *this
+) {
+    if (this != NULL)
+    {
+        free (this);
+    }
+}
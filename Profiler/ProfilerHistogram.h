@@ -0,0 +1,93 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define PROFILER_HISTOGRAM_SUB_BITS     5 // 32 buckets per power of 2 : values are kept within 3%
+#define PROFILER_HISTOGRAM_SUB_BUCKETS  (1 << PROFILER_HISTOGRAM_SUB_BITS)
+#define PROFILER_HISTOGRAM_MAX_BITS     32 // Microseconds : more than an hour
+#define PROFILER_HISTOGRAM_BUCKETS      ((PROFILER_HISTOGRAM_MAX_BITS - PROFILER_HISTOGRAM_SUB_BITS + 1) * PROFILER_HISTOGRAM_SUB_BUCKETS)
+#define PROFILER_HISTOGRAM_TEXT_SIZE    96
+
+// ------ Structure declaration -------
+
+/*
+ *    Distribution of durations in microseconds, HDR style : the buckets are linear inside each
+ *    power of 2, so the relative precision is the same for 10 us and for 100 ms.
+ *    Like a Profiler, it is recorded by one thread and can be read by any other at any time.
+ */
+typedef struct _ProfilerHistogram
+{
+    const char *name;
+
+    // Written by the recording thread only
+    uint64_t counts [PROFILER_HISTOGRAM_BUCKETS];
+    uint64_t max;
+
+}   ProfilerHistogram;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Allocate a new ProfilerHistogram structure.
+ * const char *name : Name of the durations measured, a static string
+ * Return        : A pointer to an allocated ProfilerHistogram.
+ */
+ProfilerHistogram *
+ProfilerHistogram_new (
+    const char *name
+);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Record a duration, from the recording thread
+ * ProfilerHistogram *this : An allocated ProfilerHistogram
+ * uint64_t microseconds : The duration
+ * Return : void
+ */
+void
+ProfilerHistogram_record (
+    ProfilerHistogram *this,
+    uint64_t microseconds
+);
+
+/*
+ * Description : Get a percentile of the durations recorded
+ * ProfilerHistogram *this : An allocated ProfilerHistogram
+ * double percentile : Between 0 and 100
+ * Return : uint64_t the duration in microseconds, the highest value of its bucket
+ */
+uint64_t
+ProfilerHistogram_getPercentile (
+    ProfilerHistogram *this,
+    double percentile
+);
+
+/*
+ * Description : Write the percentiles of the histogram, e.g. "Present : p50 16.6 p95 17.1 p99 33.3 max 50.0 ms"
+ * ProfilerHistogram *this : An allocated ProfilerHistogram
+ * char *buffer : Where the text is written, at least PROFILER_HISTOGRAM_TEXT_SIZE bytes
+ * Return : void
+ */
+void
+ProfilerHistogram_format (
+    ProfilerHistogram *this,
+    char *buffer
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated ProfilerHistogram structure.
+ * ProfilerHistogram *this : An allocated ProfilerHistogram to free.
+ */
+void
+ProfilerHistogram_free (
+    ProfilerHistogram *this
+);
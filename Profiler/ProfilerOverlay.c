@@ -0,0 +1,160 @@
+#include "ProfilerOverlay.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "ProfilerOverlay"
+#include "dbg/dbg.h"
+
+/*
+ * Description     : Allocate a new ProfilerOverlay structure.
+ * char *fontFilename : Font of the text
+ * Return        : A pointer to an allocated ProfilerOverlay.
+ */
+ProfilerOverlay *
+ProfilerOverlay_new (
+    char *fontFilename
+) {
+    ProfilerOverlay *this;
+
+    if ((this = calloc (1, sizeof(ProfilerOverlay))) == NULL)
+        return NULL;
+
+    if (!ProfilerOverlay_init (this, fontFilename)) {
+        ProfilerOverlay_free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+
+/*
+ * Description : Initialize an allocated ProfilerOverlay structure.
+ * ProfilerOverlay *this : An allocated ProfilerOverlay to initialize.
+ * char *fontFilename : Font of the text
+ * Return : true on success, false on failure.
+ */
+bool
+ProfilerOverlay_init (
+    ProfilerOverlay *this,
+    char *fontFilename
+) {
+    if ((this->font = sfFont_createFromFile (fontFilename)) == NULL) {
+        dbg ("Error : Cannot load the font \"%s\".", fontFilename);
+        return false;
+    }
+
+    // Render every glyph now : the atlas is complete, and its texture doesn't change afterwards
+    for (int code = PROFILER_OVERLAY_FIRST_GLYPH; code <= PROFILER_OVERLAY_LAST_GLYPH; code++) {
+        this->glyphs[code - PROFILER_OVERLAY_FIRST_GLYPH] =
+            sfFont_getGlyph (this->font, code, PROFILER_OVERLAY_CHARACTER_SIZE, sfFalse);
+    }
+    this->atlas = sfFont_getTexture (this->font, PROFILER_OVERLAY_CHARACTER_SIZE);
+
+    if ((this->vertices = sfVertexArray_create ()) == NULL) {
+        return false;
+    }
+    sfVertexArray_setPrimitiveType (this->vertices, sfQuads);
+    this->linesCount = 0;
+
+    return true;
+}
+
+
+/*
+ * Description : Remove all the lines of the overlay
+ * ProfilerOverlay *this : An allocated ProfilerOverlay
+ * Return : void
+ */
+void
+ProfilerOverlay_clear (
+    ProfilerOverlay *this
+) {
+    sfVertexArray_clear (this->vertices);
+    this->linesCount = 0;
+}
+
+
+/*
+ * Description : Add a line under the last one
+ * ProfilerOverlay *this : An allocated ProfilerOverlay
+ * const char *text : The text of the line, characters out of the atlas are skipped
+ * sfColor color : Color of the text
+ * Return : void
+ */
+void
+ProfilerOverlay_addLine (
+    ProfilerOverlay *this,
+    const char *text,
+    sfColor color
+) {
+    float x = 0;
+    float baseline = this->linesCount * PROFILER_OVERLAY_LINE_HEIGHT + PROFILER_OVERLAY_CHARACTER_SIZE;
+
+    for (; *text; text++)
+    {
+        if (*text < PROFILER_OVERLAY_FIRST_GLYPH || *text > PROFILER_OVERLAY_LAST_GLYPH) {
+            continue;
+        }
+
+        sfGlyph *glyph = &this->glyphs[*text - PROFILER_OVERLAY_FIRST_GLYPH];
+        float left   = x + glyph->bounds.left;
+        float top    = baseline + glyph->bounds.top;
+        float right  = left + glyph->bounds.width;
+        float bottom = top + glyph->bounds.height;
+        float u1 = glyph->textureRect.left, u2 = u1 + glyph->textureRect.width;
+        float v1 = glyph->textureRect.top,  v2 = v1 + glyph->textureRect.height;
+
+        sfVertexArray_append (this->vertices, (sfVertex) {{left,  top},    color, {u1, v1}});
+        sfVertexArray_append (this->vertices, (sfVertex) {{right, top},    color, {u2, v1}});
+        sfVertexArray_append (this->vertices, (sfVertex) {{right, bottom}, color, {u2, v2}});
+        sfVertexArray_append (this->vertices, (sfVertex) {{left,  bottom}, color, {u1, v2}});
+
+        x += glyph->advance;
+    }
+
+    this->linesCount++;
+}
+
+
+/*
+ * Description : Draw all the lines of the overlay
+ * ProfilerOverlay *this : An allocated ProfilerOverlay
+ * sfRenderWindow *window : Where the overlay is drawn
+ * Return : void
+ */
+void
+ProfilerOverlay_draw (
+    ProfilerOverlay *this,
+    sfRenderWindow *window
+) {
+    sfRenderStates states = {
+        .blendMode = sfBlendAlpha,
+        .transform = sfTransform_Identity,
+        .texture   = this->atlas,
+        .shader    = NULL
+    };
+
+    sfRenderWindow_drawVertexArray (window, this->vertices, &states);
+}
+
+
+/*
+ * Description : Free an allocated ProfilerOverlay structure.
+ * ProfilerOverlay *this : An allocated ProfilerOverlay to free.
+ */
+void
+ProfilerOverlay_free (
+    ProfilerOverlay *this
+) {
+    if (this != NULL)
+    {
+        if (this->vertices) {
+            sfVertexArray_destroy (this->vertices);
+        }
+        if (this->font) {
+            sfFont_destroy (this->font);
+        }
+        free (this);
+    }
+}
@@ -0,0 +1,108 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include <SFML/Graphics.h>
+
+// ---------- Defines -------------
+#define PROFILER_OVERLAY_FONT           "verdana.ttf"
+#define PROFILER_OVERLAY_CHARACTER_SIZE 15
+#define PROFILER_OVERLAY_LINE_HEIGHT    15
+#define PROFILER_OVERLAY_FIRST_GLYPH    ' '
+#define PROFILER_OVERLAY_LAST_GLYPH     '~'
+
+// ------ Structure declaration -------
+
+/*
+ *    Text lines drawn over the screen. The font is loaded once, and its printable ASCII glyphs
+ *    are rendered once in its texture, the atlas : the whole overlay is then a single array
+ *    of textured quads, rebuilt only when its lines change and drawn in one call.
+ *    It must be used by the thread owning the window.
+ */
+typedef struct _ProfilerOverlay
+{
+    sfFont *font;
+    const sfTexture *atlas;
+    sfGlyph glyphs [PROFILER_OVERLAY_LAST_GLYPH - PROFILER_OVERLAY_FIRST_GLYPH + 1];
+
+    // Quads of the characters of the lines
+    sfVertexArray *vertices;
+    int linesCount;
+
+}   ProfilerOverlay;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Allocate a new ProfilerOverlay structure.
+ * char *fontFilename : Font of the text
+ * Return        : A pointer to an allocated ProfilerOverlay.
+ */
+ProfilerOverlay *
+ProfilerOverlay_new (
+    char *fontFilename
+);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Initialize an allocated ProfilerOverlay structure.
+ * ProfilerOverlay *this : An allocated ProfilerOverlay to initialize.
+ * char *fontFilename : Font of the text
+ * Return : true on success, false on failure.
+ */
+bool
+ProfilerOverlay_init (
+    ProfilerOverlay *this,
+    char *fontFilename
+);
+
+/*
+ * Description : Remove all the lines of the overlay
+ * ProfilerOverlay *this : An allocated ProfilerOverlay
+ * Return : void
+ */
+void
+ProfilerOverlay_clear (
+    ProfilerOverlay *this
+);
+
+/*
+ * Description : Add a line under the last one
+ * ProfilerOverlay *this : An allocated ProfilerOverlay
+ * const char *text : The text of the line, characters out of the atlas are skipped
+ * sfColor color : Color of the text
+ * Return : void
+ */
+void
+ProfilerOverlay_addLine (
+    ProfilerOverlay *this,
+    const char *text,
+    sfColor color
+);
+
+/*
+ * Description : Draw all the lines of the overlay
+ * ProfilerOverlay *this : An allocated ProfilerOverlay
+ * sfRenderWindow *window : Where the overlay is drawn
+ * Return : void
+ */
+void
+ProfilerOverlay_draw (
+    ProfilerOverlay *this,
+    sfRenderWindow *window
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated ProfilerOverlay structure.
+ * ProfilerOverlay *this : An allocated ProfilerOverlay to free.
+ */
+void
+ProfilerOverlay_free (
+    ProfilerOverlay *this
+);
@@ -0,0 +1,145 @@
+#include "ProfilerThreads.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "ProfilerThreads"
+#include "dbg/dbg.h"
+
+// Tables of the current thread to fold when it exits
+typedef struct _ProfilerThreadsSlot
+{
+    ProfilerThreads *owner;
+    int id;
+    struct _ProfilerThreadsSlot *next;
+
+}   ProfilerThreadsSlot;
+
+static pthread_key_t exitKey;
+static pthread_once_t exitKeyOnce = PTHREAD_ONCE_INIT;
+
+
+/*
+ * Fold the tables of a thread exiting, and free their slots
+ */
+static void
+ProfilerThreads_exit (
+    void *slots
+) {
+    ProfilerThreadsSlot *slot = slots;
+
+    while (slot != NULL) {
+        ProfilerThreads *this = slot->owner;
+        ProfilerThreadsSlot *next = slot->next;
+
+        pthread_mutex_lock (&this->mutex);
+        this->fold (this->tables[slot->id]);
+        free (this->tables[slot->id]);
+        this->tables[slot->id] = NULL;
+        pthread_mutex_unlock (&this->mutex);
+
+        free (slot);
+        slot = next;
+    }
+}
+
+static void
+ProfilerThreads_createExitKey (void) {
+    if (pthread_key_create (&exitKey, ProfilerThreads_exit) != 0) {
+        dbg ("Error : Cannot watch the threads exiting, their slots won't be reused.");
+    }
+}
+
+
+/*
+ * Description : Give a zeroed table to the current thread. A thread registers only once.
+ * ProfilerThreads *this : The tables of the threads
+ * int *id : (out) The slot of the table, optional
+ * Return : void * the table of the thread, NULL when every slot is taken
+ */
+void *
+ProfilerThreads_register (
+    ProfilerThreads *this,
+    int *id
+) {
+    ProfilerThreadsSlot *slot = NULL;
+    void *table;
+    int slotId = 0;
+
+    if ((table = calloc (1, this->tableSize)) == NULL
+    ||  (this->fold && (slot = malloc (sizeof(ProfilerThreadsSlot))) == NULL)) {
+        dbg ("Error : Cannot allocate the %s of a thread.", this->name);
+        free (table);
+        return NULL;
+    }
+
+    pthread_mutex_lock (&this->mutex);
+
+    // The slots of the threads exited are reused first
+    while (slotId < this->count && this->tables[slotId] != NULL) {
+        slotId++;
+    }
+
+    if (slotId >= this->capacity || slotId >= PROFILER_THREADS_MAX) {
+        if (!this->hasOverflowed) {
+            dbg ("Warning : More than %d threads : the %s of the next ones are dropped.", this->capacity, this->name);
+            this->hasOverflowed = true;
+        }
+        pthread_mutex_unlock (&this->mutex);
+        free (table);
+        free (slot);
+        return NULL;
+    }
+
+    this->tables[slotId] = table;
+    if (slotId == this->count) {
+        this->count++;
+    }
+    if (this->registeredCount++ == 0 && this->start) {
+        this->start ();
+    }
+
+    pthread_mutex_unlock (&this->mutex);
+
+    // Fold the table when the thread exits
+    if (slot != NULL) {
+        pthread_once (&exitKeyOnce, ProfilerThreads_createExitKey);
+        slot->owner = this;
+        slot->id = slotId;
+        slot->next = pthread_getspecific (exitKey);
+        if (pthread_setspecific (exitKey, slot) != 0) {
+            free (slot);
+        }
+    }
+
+    if (id != NULL) {
+        *id = slotId;
+    }
+
+    return table;
+}
+
+
+/*
+ * Description : Keep the tables from being registered or folded while they are read
+ * ProfilerThreads *this : The tables of the threads
+ * Return : void
+ */
+void
+ProfilerThreads_lock (
+    ProfilerThreads *this
+) {
+    pthread_mutex_lock (&this->mutex);
+}
+
+
+/*
+ * Description : Let the threads register or exit again
+ * ProfilerThreads *this : The tables of the threads
+ * Return : void
+ */
+void
+ProfilerThreads_unlock (
+    ProfilerThreads *this
+) {
+    pthread_mutex_unlock (&this->mutex);
+}
@@ -0,0 +1,84 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include <stdint.h>
+#include <pthread.h>
+
+// ---------- Defines -------------
+#define PROFILER_THREADS_MAX 256
+
+/*
+ *    Tables of the threads measuring something (opcodes executed, zones closed...) : each thread
+ *    writes its own table without locks, registered by ProfilerThreads_register the first time it
+ *    measures something. A thread registers once : when every slot is taken, it gets no table,
+ *    the first one is warned and the measures of these threads are dropped.
+ *    With a fold callback, the table of a thread exiting is folded into the totals of the owner
+ *    and its slot is reused by the next threads ; without, the table is kept until the process exits.
+ *    The readers go through the slots between ProfilerThreads_lock and ProfilerThreads_unlock.
+ *
+ *        static ProfilerThreads threads = {
+ *            .name = "zones", .tableSize = sizeof(ZoneTable), .capacity = 64,
+ *            .mutex = PTHREAD_MUTEX_INITIALIZER
+ *        };
+ */
+
+// ------ Structure declaration -------
+typedef struct _ProfilerThreads
+{
+    const char *name;   // What the tables hold, for the warning
+    size_t tableSize;
+    int capacity;       // Slots, up to PROFILER_THREADS_MAX
+
+    // Called by the first thread registered, the lock held (optional)
+    void (*start) (void);
+
+    // Called with the table of a thread exiting, the lock held (optional)
+    void (*fold) (void *table);
+
+    // Tables of the slots, NULL when free ; the readers go through the "count" first ones
+    void *tables [PROFILER_THREADS_MAX];
+    int count;
+
+    // Threads registered since the start
+    int registeredCount;
+    bool hasOverflowed;
+    pthread_mutex_t mutex;
+
+}   ProfilerThreads;
+
+
+// ----------- Functions ------------
+
+/*
+ * Description : Give a zeroed table to the current thread. A thread registers only once.
+ * ProfilerThreads *this : The tables of the threads
+ * int *id : (out) The slot of the table, optional
+ * Return : void * the table of the thread, NULL when every slot is taken
+ */
+void *
+ProfilerThreads_register (
+    ProfilerThreads *this,
+    int *id
+);
+
+/*
+ * Description : Keep the tables from being registered or folded while they are read
+ * ProfilerThreads *this : The tables of the threads
+ * Return : void
+ */
+void
+ProfilerThreads_lock (
+    ProfilerThreads *this
+);
+
+/*
+ * Description : Let the threads register or exit again
+ * ProfilerThreads *this : The tables of the threads
+ * Return : void
+ */
+void
+ProfilerThreads_unlock (
+    ProfilerThreads *this
+);
@@ -0,0 +1,219 @@
+#include "ProfilerZone.h"
+#include "ProfilerClock.h"
+#include "ProfilerThreads.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "ProfilerZone"
+#include "dbg/dbg.h"
+
+// Zones of a thread : only the thread writes them, the exporter reads the "count" first ones
+typedef struct _ProfilerZoneThread
+{
+    const char *name;
+    int id;
+
+    // Zones opened
+    const char *openNames [PROFILER_ZONES_MAX_DEPTH];
+    uint64_t openStarts [PROFILER_ZONES_MAX_DEPTH];
+    int depth;
+
+    // Zones closed
+    ProfilerZoneEvent events [PROFILER_ZONES_PER_THREAD];
+    int count;
+    int dropped;
+
+}   ProfilerZoneThread;
+
+static __thread ProfilerZoneThread *currentThread = NULL;
+static __thread bool isDropped = false; // No slot was left for the thread
+static uint64_t originTime = 0;
+
+
+/*
+ * Write the trace in PROFILER_ZONES_FILENAME when the process exits
+ */
+static void
+ProfilerZone_writeFile (void) {
+    FILE *output;
+
+    if ((output = fopen (PROFILER_ZONES_FILENAME, "w")) == NULL) {
+        dbg ("Error : Cannot write \"%s\".", PROFILER_ZONES_FILENAME);
+        return;
+    }
+
+    ProfilerZone_writeTrace (output);
+    fclose (output);
+    printf ("Profiler zones written in \"%s\".\n", PROFILER_ZONES_FILENAME);
+}
+
+static void
+ProfilerZone_start (void) {
+    __atomic_store_n (&originTime, ProfilerClock_nanoseconds (), __ATOMIC_RELEASE);
+    atexit (ProfilerZone_writeFile);
+}
+
+
+// Zones of the threads : kept after the threads exit, until they are written
+static ProfilerThreads threads = {
+    .name = "zones",
+    .tableSize = sizeof(ProfilerZoneThread),
+    .capacity = PROFILER_ZONES_MAX_THREADS,
+    .start = ProfilerZone_start,
+    .mutex = PTHREAD_MUTEX_INITIALIZER
+};
+
+
+/*
+ * Get the zones of the current thread, registered on its first zone
+ */
+static ProfilerZoneThread *
+ProfilerZone_getThread (void) {
+    ProfilerZoneThread *thread = currentThread;
+
+    if (thread == NULL) {
+        int id;
+        if (isDropped || (thread = ProfilerThreads_register (&threads, &id)) == NULL) {
+            isDropped = true;
+            return NULL;
+        }
+        thread->id = id;
+        currentThread = thread;
+    }
+
+    return thread;
+}
+
+
+/*
+ * Description : Name the current thread in the trace
+ * const char *name : A static string
+ * Return : void
+ */
+void
+ProfilerZone_setThreadName (
+    const char *name
+) {
+    ProfilerZoneThread *thread = ProfilerZone_getThread ();
+
+    if (thread) {
+        thread->name = name;
+    }
+}
+
+
+/*
+ * Description : Open a zone in the current thread
+ * const char *name : A static string
+ * Return : int the depth of the zone
+ */
+int
+ProfilerZone_begin (
+    const char *name
+) {
+    ProfilerZoneThread *thread = ProfilerZone_getThread ();
+
+    if (thread == NULL) {
+        return 0;
+    }
+
+    // Too deep : counted, so the zone is closed by its ProfilerZone_end, but not recorded
+    if (thread->depth < PROFILER_ZONES_MAX_DEPTH) {
+        thread->openNames[thread->depth] = name;
+        thread->openStarts[thread->depth] = ProfilerClock_nanoseconds ();
+    }
+
+    return thread->depth++;
+}
+
+
+/*
+ * Description : Close the last zone opened by the current thread
+ * Return : void
+ */
+void
+ProfilerZone_end (void)
+{
+    ProfilerZoneThread *thread = currentThread;
+
+    if (thread == NULL || thread->depth == 0) {
+        return;
+    }
+
+    if (--thread->depth >= PROFILER_ZONES_MAX_DEPTH) {
+        return;
+    }
+
+    if (thread->count >= PROFILER_ZONES_PER_THREAD) {
+        thread->dropped++;
+        return;
+    }
+
+    ProfilerZoneEvent *event = &thread->events[thread->count];
+    event->name  = thread->openNames[thread->depth];
+    event->start = thread->openStarts[thread->depth];
+    event->end   = ProfilerClock_nanoseconds ();
+
+    // Publish the event to the exporter
+    __atomic_store_n (&thread->count, thread->count + 1, __ATOMIC_RELEASE);
+}
+
+
+/*
+ * Description : Close the zone of PROFILER_ZONE at the end of its block
+ * int *depth : The depth of the zone
+ * Return : void
+ */
+void
+ProfilerZone_endScope (
+    int *depth
+) {
+    ProfilerZone_end ();
+}
+
+
+/*
+ * Description : Write the zones closed by all the threads as Chrome trace events
+ * FILE *output : Where the trace is written
+ * Return : void
+ */
+void
+ProfilerZone_writeTrace (
+    FILE *output
+) {
+    uint64_t origin = __atomic_load_n (&originTime, __ATOMIC_ACQUIRE);
+    char *separator = "";
+
+    fprintf (output, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    ProfilerThreads_lock (&threads);
+    for (int id = 0; id < threads.count; id++)
+    {
+        ProfilerZoneThread *thread = threads.tables[id];
+        if (thread == NULL) {
+            continue;
+        }
+
+        if (thread->name) {
+            fprintf (output, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                separator, id, thread->name);
+            separator = ",";
+        }
+
+        int eventsCount = __atomic_load_n (&thread->count, __ATOMIC_ACQUIRE);
+        for (int index = 0; index < eventsCount; index++) {
+            ProfilerZoneEvent *event = &thread->events[index];
+            fprintf (output, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                separator, event->name, id,
+                (int64_t) (event->start - origin) / 1000.0, (event->end - event->start) / 1000.0);
+            separator = ",";
+        }
+
+        if (thread->dropped) {
+            dbg ("Warning : %d zones of the thread %d were dropped.", thread->dropped, id);
+        }
+    }
+    ProfilerThreads_unlock (&threads);
+
+    fprintf (output, "\n]}\n");
+}
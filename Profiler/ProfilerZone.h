@@ -0,0 +1,99 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+/*
+ *    Scoped timing zones, recorded when the emulator is built with -DPROFILER_ZONES and
+ *    compiled out entirely otherwise. Each thread records the zones it closes in its own buffer,
+ *    without locks ; the zones of all the threads are written as Chrome trace events
+ *    (chrome://tracing, ui.perfetto.dev) in PROFILER_ZONES_FILENAME when the process exits.
+ *
+ *        PROFILER_ZONE_BEGIN ("Present");
+ *        sfRenderWindow_display (window);
+ *        PROFILER_ZONE_END ();
+ *
+ *    or, closed at the end of the enclosing block : PROFILER_ZONE ("Sprite");
+ *    The names must be static strings.
+ */
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define PROFILER_ZONES_FILENAME     "zones.json"
+#define PROFILER_ZONES_MAX_THREADS  64
+#define PROFILER_ZONES_MAX_DEPTH    32
+#define PROFILER_ZONES_PER_THREAD   0x40000 // Zones closed after that are dropped
+
+#ifdef PROFILER_ZONES
+    #define PROFILER_ZONE_BEGIN(name)   ProfilerZone_begin (name)
+    #define PROFILER_ZONE_END()         ProfilerZone_end ()
+    #define PROFILER_ZONE(name)         int profilerZoneScope __attribute__((cleanup(ProfilerZone_endScope))) = ProfilerZone_begin (name)
+    #define PROFILER_THREAD_NAME(name)  ProfilerZone_setThreadName (name)
+#else
+    #define PROFILER_ZONE_BEGIN(name)   ((void) 0)
+    #define PROFILER_ZONE_END()         ((void) 0)
+    #define PROFILER_ZONE(name)         ((void) 0)
+    #define PROFILER_THREAD_NAME(name)  ((void) 0)
+#endif
+
+// ------ Structure declaration -------
+typedef struct _ProfilerZoneEvent
+{
+    const char *name;
+
+    // Nanoseconds since the first zone of the process
+    uint64_t start;
+    uint64_t end;
+
+}   ProfilerZoneEvent;
+
+
+// ----------- Functions ------------
+
+/*
+ * Description : Name the current thread in the trace
+ * const char *name : A static string
+ * Return : void
+ */
+void
+ProfilerZone_setThreadName (
+    const char *name
+);
+
+/*
+ * Description : Open a zone in the current thread
+ * const char *name : A static string
+ * Return : int the depth of the zone
+ */
+int
+ProfilerZone_begin (
+    const char *name
+);
+
+/*
+ * Description : Close the last zone opened by the current thread
+ * Return : void
+ */
+void
+ProfilerZone_end (void);
+
+/*
+ * Description : Close the zone of PROFILER_ZONE at the end of its block
+ * int *depth : The depth of the zone
+ * Return : void
+ */
+void
+ProfilerZone_endScope (
+    int *depth
+);
+
+/*
+ * Description : Write the zones closed by all the threads as Chrome trace events
+ * FILE *output : Where the trace is written
+ * Return : void
+ */
+void
+ProfilerZone_writeTrace (
+    FILE *output
+);
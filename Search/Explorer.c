@@ -0,0 +1,557 @@
+#include "Explorer.h"
+#include "Batch/Batch.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "Explorer"
+#include "dbg/dbg.h"
+
+/*
+ * Description     : Allocate a new Explorer structure.
+ * char *romFilename : ROM explored
+ * int threadsCount : Number of worker threads
+ * uint32_t maxNodes : Maximum number of nodes reached before giving up
+ * Return        : A pointer to an allocated Explorer.
+ */
+Explorer *
+Explorer_new (
+    char *romFilename,
+    int threadsCount,
+    uint32_t maxNodes
+) {
+    Explorer *this;
+
+    if ((this = calloc (1, sizeof(Explorer))) == NULL)
+        return NULL;
+
+    if (!Explorer_init (this, romFilename, threadsCount, maxNodes)) {
+        Explorer_free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+
+/*
+ * Description : Initialize an allocated Explorer structure.
+ * Explorer *this : An allocated Explorer to initialize.
+ * char *romFilename : ROM explored
+ * int threadsCount : Number of worker threads
+ * uint32_t maxNodes : Maximum number of nodes reached before giving up
+ * Return : true on success, false on failure.
+ */
+bool
+Explorer_init (
+    Explorer *this,
+    char *romFilename,
+    int threadsCount,
+    uint32_t maxNodes
+) {
+    if (threadsCount <= 0 || threadsCount > EXPLORER_MAX_THREADS) {
+        dbg ("Error : Invalid threads count %d (max : %d).", threadsCount, EXPLORER_MAX_THREADS);
+        return false;
+    }
+
+    // Default parameters
+    this->mode = EXPLORER_BREADTH_FIRST;
+    this->framesPerStep = DEFAULT_EXPLORER_FRAMES_PER_STEP;
+    this->maxDepth = INT16_MAX;
+    this->beamWidth = 0;
+    this->maxNodes = maxNodes;
+    this->goalNode = EXPLORER_NO_NODE;
+    this->faultNode = EXPLORER_NO_NODE;
+    this->hasFailed = false;
+    this->isVisitedFull = false;
+    Explorer_setKeys (this, 0xFFFF);
+
+    if ((this->nodes = malloc (maxNodes * sizeof(ExplorerNode))) == NULL
+    ||  (this->visited = StateSet_new (maxNodes)) == NULL) {
+        dbg ("Cannot allocate %u nodes.", maxNodes);
+        return false;
+    }
+
+    for (int id = 0; id < threadsCount; id++) {
+        ExplorerWorker *worker = &this->workers[id];
+        worker->explorer = this;
+        worker->id = id;
+
+        if ((worker->cpu = Batch_newMachine (romFilename)) == NULL
+        ||  (worker->deque = WorkDeque_new (maxNodes)) == NULL) {
+            return false;
+        }
+
+        this->workersCount++;
+    }
+
+    Explorer_startFromBoot (this, 0);
+
+    return true;
+}
+
+
+/*
+ * Description : Start the search from the boot of the ROM
+ * Explorer *this : An allocated Explorer
+ * uint32_t seed : Seed of the CXNN random generator
+ * Return : void
+ */
+void
+Explorer_startFromBoot (
+    Explorer *this,
+    uint32_t seed
+) {
+    Cpu *cpu = this->workers[0].cpu;
+
+    Cpu_seed (cpu, seed);
+    Cpu_saveState (cpu, &this->start);
+    this->seed = seed;
+    this->isFromBoot = true;
+}
+
+
+/*
+ * Description : Start the search from a save state file
+ * Explorer *this : An allocated Explorer
+ * char *filename : The save state file
+ * Return : bool, true on success, false otherwise
+ */
+bool
+Explorer_startFromStateFile (
+    Explorer *this,
+    char *filename
+) {
+    Cpu *cpu = this->workers[0].cpu;
+
+    if (!Cpu_loadStateFile (cpu, filename)) {
+        return false;
+    }
+
+    // The random generator is part of the state : the movies need the state, not a seed
+    Cpu_saveState (cpu, &this->start);
+    this->seed = 0;
+    this->isFromBoot = false;
+
+    return true;
+}
+
+
+/*
+ * Description : Write the starting point in a save state file : the movies start from it
+ * Explorer *this : An allocated Explorer
+ * char *filename : The save state file
+ * Return : bool, true on success, false otherwise
+ */
+bool
+Explorer_saveStart (
+    Explorer *this,
+    char *filename
+) {
+    Cpu *cpu = this->workers[0].cpu;
+
+    Cpu_loadState (cpu, &this->start);
+
+    return Cpu_saveStateFile (cpu, filename);
+}
+
+
+/*
+ * Description : Restrict the keys tried from each node. Releasing every key is always tried.
+ * Explorer *this : An allocated Explorer
+ * uint16_t keysMask : Bit N set when the key N can be pressed
+ * Return : void
+ */
+void
+Explorer_setKeys (
+    Explorer *this,
+    uint16_t keysMask
+) {
+    this->actionsCount = 0;
+    this->actions[this->actionsCount++] = 0;
+
+    for (C8KeyCode code = 0; code < keyCodeCount; code++) {
+        if (keysMask & (1 << code)) {
+            this->actions[this->actionsCount++] = 1 << code;
+        }
+    }
+}
+
+
+/*
+ * Description : Keep a reached node for the next depth
+ * ExplorerWorker *worker : The worker which reached it
+ * ExplorerItem *item : The node and its state
+ * Return : bool, false when it cannot be stored
+ */
+static bool
+Explorer_keepItem (
+    ExplorerWorker *worker,
+    ExplorerItem *item
+) {
+    if (worker->nextCount >= worker->nextCapacity) {
+        int capacity = (worker->nextCapacity) ? worker->nextCapacity * 2 : 1024;
+        ExplorerItem **next;
+
+        if ((next = realloc (worker->next, capacity * sizeof(ExplorerItem *))) == NULL) {
+            return false;
+        }
+        worker->next = next;
+        worker->nextCapacity = capacity;
+    }
+
+    worker->next[worker->nextCount++] = item;
+
+    return true;
+}
+
+
+/*
+ * Description : Stop the search : a node reached has been lost
+ * Explorer *this : An allocated Explorer
+ * Return : void
+ */
+static void
+Explorer_fail (
+    Explorer *this
+) {
+    __atomic_store_n (&this->hasFailed, true, __ATOMIC_RELAXED);
+}
+
+
+/*
+ * Description : Try every action from a node
+ * ExplorerWorker *worker : The worker expanding the node
+ * ExplorerItem *item : The node to expand
+ * Return : void
+ */
+static void
+Explorer_expand (
+    ExplorerWorker *worker,
+    ExplorerItem *item
+) {
+    Explorer *this = worker->explorer;
+    Cpu *cpu = worker->cpu;
+    uint16_t depth = this->nodes[item->node].depth + 1;
+
+    for (int action = 0; action < this->actionsCount; action++)
+    {
+        if (__atomic_load_n (&this->goalNode, __ATOMIC_RELAXED) != EXPLORER_NO_NODE
+        ||  __atomic_load_n (&this->hasFailed, __ATOMIC_RELAXED)
+        ||  __atomic_load_n (&this->isVisitedFull, __ATOMIC_RELAXED)) {
+            return;
+        }
+
+        // Hold the keys during a step
+        Cpu_loadState (cpu, &item->state);
+        Cpu_setKeys (cpu, this->actions[action]);
+        for (int frame = 0; frame < this->framesPerStep && cpu->isRunning; frame++) {
+            Cpu_emulateFrame (cpu);
+        }
+
+        // Only new states are kept
+        StateSetStatus status = StateSet_insert (this->visited, Cpu_hashState (cpu));
+        if (status == STATE_SET_FULL) {
+            __atomic_store_n (&this->isVisitedFull, true, __ATOMIC_RELAXED);
+            return;
+        }
+        if (status == STATE_SET_SEEN) {
+            continue;
+        }
+
+        uint32_t node = __atomic_fetch_add (&this->nodesCount, 1, __ATOMIC_RELAXED);
+        if (node >= this->maxNodes) {
+            return;
+        }
+        this->nodes[node] = (ExplorerNode) {.parent = item->node, .keys = this->actions[action], .depth = depth};
+
+        // A crashing input sequence
+        if (cpu->fault != CPU_FAULT_NONE) {
+            uint32_t none = EXPLORER_NO_NODE;
+            __atomic_compare_exchange_n (&this->faultNode, &none, node, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+            if (this->stopOnFault) {
+                none = EXPLORER_NO_NODE;
+                __atomic_compare_exchange_n (&this->goalNode, &none, node, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+            }
+            continue;
+        }
+
+        if (this->goalExpr && WatchExpr_evaluate (this->goalExpr, cpu)) {
+            uint32_t none = EXPLORER_NO_NODE;
+            __atomic_compare_exchange_n (&this->goalNode, &none, node, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+            return;
+        }
+
+        ExplorerItem *child;
+        if ((child = malloc (sizeof(ExplorerItem))) == NULL) {
+            Explorer_fail (this);
+            return;
+        }
+        child->node = node;
+        child->score = (this->scoreExpr) ? WatchExpr_evaluate (this->scoreExpr, cpu) : 0;
+        Cpu_saveState (cpu, &child->state);
+        if (!Explorer_keepItem (worker, child)) {
+            free (child);
+            Explorer_fail (this);
+            return;
+        }
+    }
+}
+
+
+/*
+ * Description : Worker thread : expand its own nodes, then steal the nodes of the other workers
+ * ExplorerWorker *worker : The worker
+ * Return : void
+ */
+static void
+Explorer_workerLoop (
+    ExplorerWorker *worker
+) {
+    Explorer *this = worker->explorer;
+
+    while (true)
+    {
+        ExplorerItem *item = WorkDeque_pop (worker->deque);
+
+        // Nothing left at home : steal from the others until every deque is empty
+        while (item == NULL) {
+            bool hasWork = false;
+
+            for (int offset = 1; offset < this->workersCount && item == NULL; offset++) {
+                WorkDeque *victim = this->workers[(worker->id + offset) % this->workersCount].deque;
+                if (WorkDeque_getSize (victim) > 0) {
+                    hasWork = true;
+                    item = WorkDeque_steal (victim);
+                }
+            }
+
+            if (item == NULL && !hasWork) {
+                return;
+            }
+        }
+
+        Explorer_expand (worker, item);
+        free (item);
+    }
+}
+
+
+/*
+ * Description : Order the items by decreasing score
+ */
+static int
+Explorer_compareScores (
+    const void *a,
+    const void *b
+) {
+    int32_t scoreA = (*(ExplorerItem **) a)->score;
+    int32_t scoreB = (*(ExplorerItem **) b)->score;
+
+    return (scoreA < scoreB) - (scoreA > scoreB);
+}
+
+
+/*
+ * Description : Explore the input sequences depth by depth, across all the workers
+ * Explorer *this : An allocated Explorer
+ * Return : uint32_t the goal node (or the fault node when stopping on faults), EXPLORER_NO_NODE if not found
+ */
+uint32_t
+Explorer_run (
+    Explorer *this
+) {
+    // The root node
+    ExplorerItem **frontier = malloc (sizeof(ExplorerItem *));
+    int frontierCount = 1;
+
+    if (frontier == NULL || (frontier[0] = malloc (sizeof(ExplorerItem))) == NULL) {
+        dbg ("Error : Cannot allocate the root node.");
+        free (frontier);
+        return EXPLORER_NO_NODE;
+    }
+    frontier[0]->node = 0;
+    frontier[0]->score = 0;
+    memcpy (&frontier[0]->state, &this->start, sizeof(CpuState));
+    this->nodes[0] = (ExplorerNode) {.parent = EXPLORER_NO_NODE, .keys = 0, .depth = 0};
+    this->nodesCount = 1;
+
+    Cpu_loadState (this->workers[0].cpu, &this->start);
+    StateSet_insert (this->visited, Cpu_hashState (this->workers[0].cpu));
+
+    sfClock *clock = sfClock_create ();
+
+    for (int depth = 0; depth < this->maxDepth && frontierCount > 0; depth++)
+    {
+        // Best first : only expand the best scored nodes
+        if (this->mode == EXPLORER_BEST_FIRST && this->beamWidth > 0 && frontierCount > this->beamWidth) {
+            qsort (frontier, frontierCount, sizeof(ExplorerItem *), Explorer_compareScores);
+            for (int i = this->beamWidth; i < frontierCount; i++) {
+                free (frontier[i]);
+            }
+            frontierCount = this->beamWidth;
+        }
+
+        // Deal the nodes to the workers, then let them steal from each other.
+        // A full deque passes the node to the next one : a node is never dropped silently.
+        for (int i = 0; i < frontierCount && !this->hasFailed; i++) {
+            int offset = 0;
+            while (offset < this->workersCount
+               && !WorkDeque_push (this->workers[(i + offset) % this->workersCount].deque, frontier[i])) {
+                offset++;
+            }
+
+            if (offset == this->workersCount) {
+                // The nodes not dealt are freed here, the ones dealt with the pending nodes below
+                for (int j = i; j < frontierCount; j++) {
+                    free (frontier[j]);
+                }
+                Explorer_fail (this);
+            }
+        }
+        if (this->hasFailed) {
+            frontierCount = 0;
+            break;
+        }
+
+        for (int id = 0; id < this->workersCount; id++) {
+            ExplorerWorker *worker = &this->workers[id];
+            worker->nextCount = 0;
+            worker->thread = sfThread_create ((void (*)(void *)) Explorer_workerLoop, worker);
+            sfThread_launch (worker->thread);
+        }
+
+        frontierCount = 0;
+        for (int id = 0; id < this->workersCount; id++) {
+            ExplorerWorker *worker = &this->workers[id];
+            sfThread_wait (worker->thread);
+            sfThread_destroy (worker->thread);
+            worker->thread = NULL;
+            frontierCount += worker->nextCount;
+        }
+
+        // Gather the nodes reached for the next depth
+        ExplorerItem **gathered;
+        if ((gathered = realloc (frontier, (frontierCount + 1) * sizeof(ExplorerItem *))) == NULL) {
+            for (int id = 0; id < this->workersCount; id++) {
+                ExplorerWorker *worker = &this->workers[id];
+                for (int i = 0; i < worker->nextCount; i++) {
+                    free (worker->next[i]);
+                }
+            }
+            frontierCount = 0;
+            Explorer_fail (this);
+            break;
+        }
+        frontier = gathered;
+        for (int id = 0, pos = 0; id < this->workersCount; id++) {
+            ExplorerWorker *worker = &this->workers[id];
+            memcpy (&frontier[pos], worker->next, worker->nextCount * sizeof(ExplorerItem *));
+            pos += worker->nextCount;
+        }
+
+        printf ("Depth %3d : %8d new states | %10u nodes | %.2fs\n",
+            depth + 1, frontierCount, (this->nodesCount < this->maxNodes) ? this->nodesCount : this->maxNodes,
+            sfTime_asSeconds (sfClock_getElapsedTime (clock)));
+
+        if (this->goalNode != EXPLORER_NO_NODE || this->hasFailed) {
+            break;
+        }
+
+        if (this->nodesCount >= this->maxNodes) {
+            printf ("Nodes limit reached (%u).\n", this->maxNodes);
+            break;
+        }
+
+        if (this->isVisitedFull) {
+            printf ("Visited states table full (%lld states).\n", (long long) this->visited->count);
+            break;
+        }
+    }
+
+    // Pending nodes are not needed anymore
+    for (int id = 0; id < this->workersCount; id++) {
+        ExplorerItem *item;
+        while ((item = WorkDeque_pop (this->workers[id].deque)) != NULL) {
+            free (item);
+        }
+    }
+    for (int i = 0; i < frontierCount; i++) {
+        free (frontier[i]);
+    }
+    free (frontier);
+    sfClock_destroy (clock);
+
+    if (this->hasFailed) {
+        printf ("Error : Out of memory, nodes reached have been lost and the search stopped.\n");
+    }
+
+    return this->goalNode;
+}
+
+
+/*
+ * Description : Build the input movie reaching a node from the starting point
+ * Explorer *this : An allocated Explorer
+ * uint32_t node : The node reached
+ * Return : Movie * an allocated Movie, NULL on failure
+ */
+Movie *
+Explorer_getMovie (
+    Explorer *this,
+    uint32_t node
+) {
+    Movie *movie;
+    int depth = this->nodes[node].depth;
+    uint16_t *path = malloc ((depth + 1) * sizeof(uint16_t));
+
+    if ((movie = Movie_new (this->seed)) == NULL || path == NULL) {
+        dbg ("Error : Cannot allocate the movie.");
+        free (path);
+        Movie_free (movie);
+        return NULL;
+    }
+
+    // Walk up to the root
+    for (int step = depth - 1; node != 0 && step >= 0; node = this->nodes[node].parent, step--) {
+        path[step] = this->nodes[node].keys;
+    }
+
+    for (int step = 0; step < depth; step++) {
+        for (int frame = 0; frame < this->framesPerStep; frame++) {
+            if (!Movie_addFrame (movie, path[step])) {
+                dbg ("Error : Cannot allocate the frames of the movie.");
+                free (path);
+                Movie_free (movie);
+                return NULL;
+            }
+        }
+    }
+
+    free (path);
+
+    return movie;
+}
+
+
+/*
+ * Description : Free an allocated Explorer structure.
+ * Explorer *this : An allocated Explorer to free.
+ */
+void
+Explorer_free (
+    Explorer *this
+) {
+    if (this != NULL)
+    {
+        for (int id = 0; id < EXPLORER_MAX_THREADS; id++) {
+            ExplorerWorker *worker = &this->workers[id];
+            Cpu_free (worker->cpu);
+            WorkDeque_free (worker->deque);
+            free (worker->next);
+        }
+
+        StateSet_free (this->visited);
+        free (this->nodes);
+        free (this);
+    }
+}
@@ -0,0 +1,236 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Chip8/CPU.h"
+#include "Chip8/Movie.h"
+#include "Batch/WatchExpr.h"
+#include "WorkDeque.h"
+#include "StateSet.h"
+#include "Utils/Utils.h"
+#include <SFML/System.h>
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define EXPLORER_MAX_THREADS 64
+#define EXPLORER_NO_NODE UINT32_MAX
+#define DEFAULT_EXPLORER_MAX_NODES 100000
+#define DEFAULT_EXPLORER_FRAMES_PER_STEP 4
+
+
+// ------ Structure declaration -------
+typedef enum {
+    EXPLORER_BREADTH_FIRST,
+    EXPLORER_BEST_FIRST,    // Beam search : only the best scored nodes of each depth are expanded
+
+} ExplorerMode;
+
+/*
+ *    A reached state : how it was reached from its parent
+ */
+typedef struct _ExplorerNode
+{
+    uint32_t parent;
+    uint16_t keys;
+    uint16_t depth;
+
+}   ExplorerNode;
+
+/*
+ *    A node waiting to be expanded, with the machine state it reached
+ */
+typedef struct _ExplorerItem
+{
+    uint32_t node;
+    int32_t score;
+    CpuState state;
+
+}   ExplorerItem;
+
+typedef struct _ExplorerWorker
+{
+    struct _Explorer *explorer;
+    int id;
+
+    // Machine used to expand nodes
+    Cpu *cpu;
+
+    // Nodes of the current depth to expand
+    WorkDeque *deque;
+
+    // Nodes reached for the next depth
+    ExplorerItem **next;
+    int nextCount;
+    int nextCapacity;
+
+    // Thread object pointer
+    sfThread *thread;
+
+}   ExplorerWorker;
+
+typedef struct _Explorer
+{
+    // Search parameters
+    ExplorerMode mode;
+    int framesPerStep;
+    int maxDepth;
+    int beamWidth;
+    uint32_t maxNodes;
+
+    // Keys masks tried from each node
+    uint16_t actions [KEYS_COUNT + 1];
+    int actionsCount;
+
+    // The search stops when the goal expression is not zero. The score orders the best first search.
+    WatchExpr *goalExpr;
+    WatchExpr *scoreExpr;
+
+    // Stop on the first CPU fault reached
+    bool stopOnFault;
+
+    // Starting point of the search : the boot with a seed, or a save state
+    CpuState start;
+    uint32_t seed;
+    bool isFromBoot;
+
+    // Reached nodes, the root is the node 0
+    ExplorerNode *nodes;
+    uint32_t nodesCount;
+
+    // Hashes of the states already reached
+    StateSet *visited;
+
+    // Workers, one thread each
+    ExplorerWorker workers [EXPLORER_MAX_THREADS];
+    int workersCount;
+
+    // Nodes found (EXPLORER_NO_NODE otherwise)
+    uint32_t goalNode;
+    uint32_t faultNode;
+
+    // A node reached couldn't be stored (out of memory, or a full deque) : the search stops
+    bool hasFailed;
+
+    // The visited states table is full : the new states aren't told apart anymore, the search stops
+    bool isVisitedFull;
+
+}   Explorer;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Allocate a new Explorer structure.
+ * char *romFilename : ROM explored
+ * int threadsCount : Number of worker threads
+ * uint32_t maxNodes : Maximum number of nodes reached before giving up
+ * Return        : A pointer to an allocated Explorer.
+ */
+Explorer *
+Explorer_new (
+    char *romFilename,
+    int threadsCount,
+    uint32_t maxNodes
+);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Initialize an allocated Explorer structure.
+ * Explorer *this : An allocated Explorer to initialize.
+ * char *romFilename : ROM explored
+ * int threadsCount : Number of worker threads
+ * uint32_t maxNodes : Maximum number of nodes reached before giving up
+ * Return : true on success, false on failure.
+ */
+bool
+Explorer_init (
+    Explorer *this,
+    char *romFilename,
+    int threadsCount,
+    uint32_t maxNodes
+);
+
+/*
+ * Description : Start the search from the boot of the ROM
+ * Explorer *this : An allocated Explorer
+ * uint32_t seed : Seed of the CXNN random generator
+ * Return : void
+ */
+void
+Explorer_startFromBoot (
+    Explorer *this,
+    uint32_t seed
+);
+
+/*
+ * Description : Start the search from a save state file
+ * Explorer *this : An allocated Explorer
+ * char *filename : The save state file
+ * Return : bool, true on success, false otherwise
+ */
+bool
+Explorer_startFromStateFile (
+    Explorer *this,
+    char *filename
+);
+
+/*
+ * Description : Restrict the keys tried from each node. Releasing every key is always tried.
+ * Explorer *this : An allocated Explorer
+ * uint16_t keysMask : Bit N set when the key N can be pressed
+ * Return : void
+ */
+void
+Explorer_setKeys (
+    Explorer *this,
+    uint16_t keysMask
+);
+
+/*
+ * Description : Explore the input sequences depth by depth, across all the workers
+ * Explorer *this : An allocated Explorer
+ * Return : uint32_t the goal node (or the fault node when stopping on faults), EXPLORER_NO_NODE if not found
+ */
+uint32_t
+Explorer_run (
+    Explorer *this
+);
+
+/*
+ * Description : Write the starting point in a save state file : the movies start from it
+ * Explorer *this : An allocated Explorer
+ * char *filename : The save state file
+ * Return : bool, true on success, false otherwise
+ */
+bool
+Explorer_saveStart (
+    Explorer *this,
+    char *filename
+);
+
+/*
+ * Description : Build the input movie reaching a node from the starting point
+ * Explorer *this : An allocated Explorer
+ * uint32_t node : The node reached
+ * Return : Movie * an allocated Movie, NULL on failure
+ */
+Movie *
+Explorer_getMovie (
+    Explorer *this,
+    uint32_t node
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated Explorer structure.
+ * Explorer *this : An allocated Explorer to free.
+ */
+void
+Explorer_free (
+    Explorer *this
+);
+
+
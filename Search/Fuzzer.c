@@ -0,0 +1,396 @@
+#include "Fuzzer.h"
+#include "Batch/Batch.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "Fuzzer"
+#include "dbg/dbg.h"
+
+#define FUZZER_MAX_STACKED_MUTATIONS 4
+#define FUZZER_MAX_BLOCK_SIZE 64
+
+/*
+ * Description     : Allocate a new Fuzzer structure.
+ * char *romFilename : ROM fuzzed
+ * uint32_t seed : Seed of the CXNN random generator and of the mutations
+ * char *outputPrefix : Prefix of the movies written (corpus and faults)
+ * Return        : A pointer to an allocated Fuzzer.
+ */
+Fuzzer *
+Fuzzer_new (
+    char *romFilename,
+    uint32_t seed,
+    char *outputPrefix
+) {
+    Fuzzer *this;
+
+    if ((this = calloc (1, sizeof(Fuzzer))) == NULL)
+        return NULL;
+
+    if (!Fuzzer_init (this, romFilename, seed, outputPrefix)) {
+        Fuzzer_free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+
+/*
+ * Description : Initialize an allocated Fuzzer structure.
+ * Fuzzer *this : An allocated Fuzzer to initialize.
+ * char *romFilename : ROM fuzzed
+ * uint32_t seed : Seed of the CXNN random generator and of the mutations
+ * char *outputPrefix : Prefix of the movies written (corpus and faults)
+ * Return : true on success, false on failure.
+ */
+bool
+Fuzzer_init (
+    Fuzzer *this,
+    char *romFilename,
+    uint32_t seed,
+    char *outputPrefix
+) {
+    if ((this->cpu = Batch_newMachine (romFilename)) == NULL) {
+        return false;
+    }
+
+    Cpu_seed (this->cpu, seed);
+    Cpu_saveState (this->cpu, &this->boot);
+    this->cpu->coverageMap = this->coverage;
+
+    this->seed = seed;
+    this->rngState = ((uint64_t) seed << 32) | 0x2545F491;
+    this->maxFrames = DEFAULT_FUZZER_MAX_FRAMES;
+    this->outputPrefix = outputPrefix;
+    memset (this->virgin, 0xFF, sizeof(this->virgin));
+
+    return true;
+}
+
+
+/*
+ * Description : Get the next number of the mutations random generator
+ * Fuzzer *this : An allocated Fuzzer
+ * uint32_t range : Upper bound (excluded)
+ * Return : uint32_t a pseudo random number in [0, range[
+ */
+static uint32_t
+Fuzzer_random (
+    Fuzzer *this,
+    uint32_t range
+) {
+    uint64_t x = this->rngState;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    this->rngState = x;
+
+    return (range) ? (uint32_t) ((x >> 32) % range) : 0;
+}
+
+
+/*
+ * Description : Bucket a hit count (AFL style), so loops only count when their magnitude changes
+ * uint8_t count : Hits of an edge
+ * Return : uint8_t one bit per bucket
+ */
+static inline uint8_t
+Fuzzer_bucket (
+    uint8_t count
+) {
+    if (count <= 3)   return (count == 3) ? 0x04 : count;
+    if (count <= 7)   return 0x08;
+    if (count <= 15)  return 0x10;
+    if (count <= 31)  return 0x20;
+    if (count <= 127) return 0x40;
+    return 0x80;
+}
+
+
+/*
+ * Description : Merge the coverage of the last run in the virgin map
+ * Fuzzer *this : An allocated Fuzzer
+ * Return : bool, true if an edge or a hit count bucket has never been seen before
+ */
+static bool
+Fuzzer_mergeCoverage (
+    Fuzzer *this
+) {
+    uint64_t *words = (uint64_t *) this->coverage;
+    bool hasNewBits = false;
+
+    for (int word = 0; word < CPU_COVERAGE_MAP_SIZE / 8; word++)
+    {
+        // Most of the map is never hit
+        if (words[word] == 0) {
+            continue;
+        }
+
+        for (int index = word * 8; index < word * 8 + 8; index++) {
+            if (this->coverage[index] == 0) {
+                continue;
+            }
+
+            uint8_t bucket = Fuzzer_bucket (this->coverage[index]);
+            if (bucket & this->virgin[index]) {
+                if (this->virgin[index] == 0xFF) {
+                    this->edgesCount++;
+                }
+                this->virgin[index] &= ~bucket;
+                hasNewBits = true;
+            }
+        }
+    }
+
+    return hasNewBits;
+}
+
+
+/*
+ * Description : Run a movie from the boot until its end or a fault
+ * Fuzzer *this : An allocated Fuzzer
+ * Movie *movie : The input movie
+ * Return : int the number of frames emulated
+ */
+static int
+Fuzzer_run (
+    Fuzzer *this,
+    Movie *movie
+) {
+    Cpu *cpu = this->cpu;
+    CycleDetector cycle;
+    int frame;
+
+    // The keys don't change anymore from this frame to the end of the movie
+    int steadyFrame = movie->framesCount - 1;
+    while (steadyFrame > 0 && movie->frames[steadyFrame - 1] == movie->frames[movie->framesCount - 1]) {
+        steadyFrame--;
+    }
+
+    memset (this->coverage, 0, sizeof(this->coverage));
+    Cpu_loadState (cpu, &this->boot);
+    cpu->coveragePrevious = 0;
+
+    for (frame = 0; frame < movie->framesCount && cpu->isRunning; frame++) {
+        Cpu_setKeys (cpu, movie->frames[frame]);
+        Cpu_emulateFrame (cpu);
+
+        // Stop a machine running in circles until the end of the movie : it won't hit anything new
+        if (frame == steadyFrame) {
+            CycleDetector_reset (&cycle, Cpu_hashState (cpu));
+        }
+        else if (frame > steadyFrame
+             &&  CycleDetector_isDue (&cycle)
+             &&  CycleDetector_update (&cycle, Cpu_hashState (cpu))) {
+            frame++;
+            break;
+        }
+    }
+
+    this->executionsCount++;
+    this->framesCount += frame;
+
+    return frame;
+}
+
+
+/*
+ * Description : Run a movie and keep it if it hits new edges or a new fault
+ * Fuzzer *this : An allocated Fuzzer
+ * Movie *movie : The input movie, owned by the fuzzer afterward
+ * Return : bool, true if the movie has been kept
+ */
+bool
+Fuzzer_tryMovie (
+    Fuzzer *this,
+    Movie *movie
+) {
+    char filename [1024];
+    int frames = Fuzzer_run (this, movie);
+    bool hasNewBits = Fuzzer_mergeCoverage (this);
+
+    // Save the movie reproducing a new fault
+    if (this->cpu->fault != CPU_FAULT_NONE) {
+        uint32_t signature = (this->cpu->fault << 16) | this->cpu->ip;
+        bool isNew = true;
+
+        for (int i = 0; i < this->faultsCount && isNew; i++) {
+            isNew = (this->faults[i] != signature);
+        }
+
+        if (isNew && this->faultsCount < FUZZER_MAX_FAULTS) {
+            this->faults[this->faultsCount] = signature;
+            movie->framesCount = frames;
+            sprintf (filename, "%sfault-%d.c8m", this->outputPrefix, this->faultsCount);
+            Movie_save (movie, filename);
+            printf ("New fault : %s at IP = %04X (opcode %04X) after %d frames -> %s\n",
+                Cpu_getFaultName (this->cpu->fault), this->cpu->ip, this->cpu->opcode, frames, filename);
+            this->faultsCount++;
+        }
+    }
+
+    if (!hasNewBits || this->corpusCount >= FUZZER_MAX_CORPUS) {
+        Movie_free (movie);
+        return false;
+    }
+
+    sprintf (filename, "%squeue-%d.c8m", this->outputPrefix, this->corpusCount);
+    Movie_save (movie, filename);
+    this->corpus[this->corpusCount++] = movie;
+
+    return true;
+}
+
+
+/*
+ * Description : Build a movie from the keys of its frames
+ * Fuzzer *this : An allocated Fuzzer
+ * uint16_t *frames : The keys pressed at each frame, NULL to release every key
+ * int count : Number of frames
+ * Return : Movie *, a new movie or NULL on failure
+ */
+static Movie *
+Fuzzer_newMovie (
+    Fuzzer *this,
+    uint16_t *frames,
+    int count
+) {
+    Movie *movie;
+
+    if ((movie = Movie_new (this->seed)) == NULL) {
+        dbg ("Error : Cannot allocate a movie.");
+        return NULL;
+    }
+
+    for (int frame = 0; frame < count; frame++) {
+        if (!Movie_addFrame (movie, (frames) ? frames[frame] : 0)) {
+            dbg ("Error : Cannot allocate %d frames.", count);
+            Movie_free (movie);
+            return NULL;
+        }
+    }
+
+    return movie;
+}
+
+
+/*
+ * Description : Mutate a movie of the corpus and try it
+ * Fuzzer *this : An allocated Fuzzer
+ * Return : bool, true if the mutated movie has been kept, false otherwise or on failure
+ */
+bool
+Fuzzer_step (
+    Fuzzer *this
+) {
+    Movie *movie;
+
+    // Start from scratch : every key released
+    if (this->corpusCount == 0) {
+        if ((movie = Fuzzer_newMovie (this, NULL, this->maxFrames)) == NULL) {
+            return false;
+        }
+        return Fuzzer_tryMovie (this, movie);
+    }
+
+    Movie *parent = this->corpus[Fuzzer_random (this, this->corpusCount)];
+    uint16_t *frames;
+    int count = parent->framesCount;
+
+    if ((frames = malloc ((this->maxFrames + FUZZER_MAX_BLOCK_SIZE) * sizeof(uint16_t))) == NULL) {
+        dbg ("Error : Cannot allocate %d frames.", this->maxFrames + FUZZER_MAX_BLOCK_SIZE);
+        return false;
+    }
+
+    memcpy (frames, parent->frames, count * sizeof(uint16_t));
+
+    for (int mutation = Fuzzer_random (this, FUZZER_MAX_STACKED_MUTATIONS) + 1; mutation > 0; mutation--)
+    {
+        int size  = Fuzzer_random (this, FUZZER_MAX_BLOCK_SIZE) + 1;
+        int start = Fuzzer_random (this, count + 1);
+        int end   = (start + size < count) ? start + size : count;
+        uint16_t key = (Fuzzer_random (this, KEYS_COUNT + 1) < KEYS_COUNT) ? 1 << Fuzzer_random (this, KEYS_COUNT) : 0;
+
+        switch (Fuzzer_random (this, 6))
+        {
+            case 0:
+            // Toggle a key during a block
+                for (int frame = start; frame < end; frame++) {
+                    frames[frame] ^= key;
+                }
+            break;
+
+            case 1:
+            // Hold a single key (or none) during a block
+                for (int frame = start; frame < end; frame++) {
+                    frames[frame] = key;
+                }
+            break;
+
+            case 2:
+            // Insert a block
+                if (count + size <= this->maxFrames) {
+                    memmove (&frames[start + size], &frames[start], (count - start) * sizeof(uint16_t));
+                    for (int frame = start; frame < start + size; frame++) {
+                        frames[frame] = key;
+                    }
+                    count += size;
+                }
+            break;
+
+            case 3:
+            // Delete a block
+                memmove (&frames[start], &frames[end], (count - end) * sizeof(uint16_t));
+                count -= end - start;
+            break;
+
+            case 4: {
+            // Splice : continue with the end of another movie
+                Movie *other = this->corpus[Fuzzer_random (this, this->corpusCount)];
+                if (start < other->framesCount) {
+                    memcpy (&frames[start], &other->frames[start], (other->framesCount - start) * sizeof(uint16_t));
+                    count = other->framesCount;
+                }
+            }
+            break;
+
+            case 5:
+            // Random keys during a block
+                for (int frame = start; frame < end; frame++) {
+                    frames[frame] = 1 << Fuzzer_random (this, KEYS_COUNT);
+                }
+            break;
+        }
+    }
+
+    movie = Fuzzer_newMovie (this, frames, count);
+    free (frames);
+
+    if (movie == NULL) {
+        return false;
+    }
+
+    return Fuzzer_tryMovie (this, movie);
+}
+
+
+/*
+ * Description : Free an allocated Fuzzer structure.
+ * Fuzzer *this : An allocated Fuzzer to free.
+ */
+void
+Fuzzer_free (
+    Fuzzer *this
+) {
+    if (this != NULL)
+    {
+        for (int i = 0; i < this->corpusCount; i++) {
+            Movie_free (this->corpus[i]);
+        }
+
+        Cpu_free (this->cpu);
+        free (this);
+    }
+}
@@ -0,0 +1,122 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Chip8/CPU.h"
+#include "Chip8/Movie.h"
+#include "Chip8/CycleDetector.h"
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+#define FUZZER_MAX_CORPUS 4096
+#define FUZZER_MAX_FAULTS 256
+#define DEFAULT_FUZZER_MAX_FRAMES 3000
+
+
+// ------ Structure declaration -------
+typedef struct _Fuzzer
+{
+    // Machine running the input movies, and its state at boot
+    Cpu *cpu;
+    CpuState boot;
+    uint32_t seed;
+
+    // Longest movie tried
+    int maxFrames;
+
+    // Edges hit by the last run, and bucketed hit counts never seen so far
+    uint8_t coverage [CPU_COVERAGE_MAP_SIZE] __attribute__ ((aligned (8)));
+    uint8_t virgin [CPU_COVERAGE_MAP_SIZE];
+    int edgesCount;
+
+    // Movies which found new coverage
+    Movie *corpus [FUZZER_MAX_CORPUS];
+    int corpusCount;
+
+    // Distinct faults found : (fault, ip) signatures
+    uint32_t faults [FUZZER_MAX_FAULTS];
+    int faultsCount;
+
+    // Where interesting movies are written (prefix of the file names)
+    char *outputPrefix;
+
+    // Random generator of the mutations (xorshift64)
+    uint64_t rngState;
+
+    // Statistics
+    uint64_t executionsCount;
+    uint64_t framesCount;
+
+}   Fuzzer;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Allocate a new Fuzzer structure.
+ * char *romFilename : ROM fuzzed
+ * uint32_t seed : Seed of the CXNN random generator and of the mutations
+ * char *outputPrefix : Prefix of the movies written (corpus and faults)
+ * Return        : A pointer to an allocated Fuzzer.
+ */
+Fuzzer *
+Fuzzer_new (
+    char *romFilename,
+    uint32_t seed,
+    char *outputPrefix
+);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Initialize an allocated Fuzzer structure.
+ * Fuzzer *this : An allocated Fuzzer to initialize.
+ * char *romFilename : ROM fuzzed
+ * uint32_t seed : Seed of the CXNN random generator and of the mutations
+ * char *outputPrefix : Prefix of the movies written (corpus and faults)
+ * Return : true on success, false on failure.
+ */
+bool
+Fuzzer_init (
+    Fuzzer *this,
+    char *romFilename,
+    uint32_t seed,
+    char *outputPrefix
+);
+
+/*
+ * Description : Run a movie and keep it if it hits new edges or a new fault
+ * Fuzzer *this : An allocated Fuzzer
+ * Movie *movie : The input movie, owned by the fuzzer afterward
+ * Return : bool, true if the movie has been kept
+ */
+bool
+Fuzzer_tryMovie (
+    Fuzzer *this,
+    Movie *movie
+);
+
+/*
+ * Description : Mutate a movie of the corpus and try it
+ * Fuzzer *this : An allocated Fuzzer
+ * Return : bool, true if the mutated movie has been kept, false otherwise or on failure
+ */
+bool
+Fuzzer_step (
+    Fuzzer *this
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated Fuzzer structure.
+ * Fuzzer *this : An allocated Fuzzer to free.
+ */
+void
+Fuzzer_free (
+    Fuzzer *this
+);
+
+
@@ -0,0 +1,151 @@
+#include "StateSet.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "StateSet"
+#include "dbg/dbg.h"
+
+// Zero marks an empty slot, so the zero hash is stored as another value
+#define STATE_SET_EMPTY 0
+#define STATE_SET_ZERO_HASH 0x9E3779B97F4A7C15ULL
+
+/*
+ * Description     : Allocate a new StateSet structure.
+ * int64_t capacity : Maximum number of hashes, the table is twice as large
+ * Return        : A pointer to an allocated StateSet.
+ */
+StateSet *
+StateSet_new (
+    int64_t capacity
+) {
+    StateSet *this;
+
+    if ((this = calloc (1, sizeof(StateSet))) == NULL)
+        return NULL;
+
+    if (!StateSet_init (this, capacity)) {
+        StateSet_free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+
+/*
+ * Description : Initialize an allocated StateSet structure.
+ * StateSet *this : An allocated StateSet to initialize.
+ * int64_t capacity : Maximum number of hashes, the table is twice as large
+ * Return : true on success, false on failure.
+ */
+bool
+StateSet_init (
+    StateSet *this,
+    int64_t capacity
+) {
+    uint64_t size = 16;
+
+    while (size < capacity * 2) {
+        size <<= 1;
+    }
+
+    if ((this->slots = calloc (size, sizeof(uint64_t))) == NULL) {
+        dbg ("Cannot allocate %llu slots.", (unsigned long long) size);
+        return false;
+    }
+
+    this->mask = size - 1;
+    this->count = 0;
+
+    return true;
+}
+
+
+/*
+ * Description : Insert a hash in the set
+ * StateSet *this : An allocated StateSet
+ * uint64_t hash : The hash of a state
+ * Return : StateSetStatus, STATE_SET_INSERTED if the hash was not in the set yet,
+ *          STATE_SET_SEEN if it was, STATE_SET_FULL if it couldn't be inserted
+ */
+StateSetStatus
+StateSet_insert (
+    StateSet *this,
+    uint64_t hash
+) {
+    if (hash == STATE_SET_EMPTY) {
+        hash = STATE_SET_ZERO_HASH;
+    }
+
+    for (uint64_t index = hash & this->mask; ; index = (index + 1) & this->mask)
+    {
+        uint64_t slot = __atomic_load_n (&this->slots[index], __ATOMIC_ACQUIRE);
+
+        if (slot == hash) {
+            return STATE_SET_SEEN;
+        }
+
+        if (slot == STATE_SET_EMPTY) {
+            // Keep the load factor under 1/2 so probing sequences stay short
+            if (__atomic_load_n (&this->count, __ATOMIC_RELAXED) > (int64_t) (this->mask / 2)) {
+                return STATE_SET_FULL;
+            }
+
+            if (__atomic_compare_exchange_n (&this->slots[index], &slot, hash, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                __atomic_add_fetch (&this->count, 1, __ATOMIC_RELAXED);
+                return STATE_SET_INSERTED;
+            }
+
+            // Another thread took the slot first : maybe with the same hash
+            if (slot == hash) {
+                return STATE_SET_SEEN;
+            }
+        }
+    }
+}
+
+
+/*
+ * Description : Check if a hash is in the set
+ * StateSet *this : An allocated StateSet
+ * uint64_t hash : The hash of a state
+ * Return : bool, true if the hash is in the set
+ */
+bool
+StateSet_contains (
+    StateSet *this,
+    uint64_t hash
+) {
+    if (hash == STATE_SET_EMPTY) {
+        hash = STATE_SET_ZERO_HASH;
+    }
+
+    for (uint64_t index = hash & this->mask; ; index = (index + 1) & this->mask)
+    {
+        uint64_t slot = __atomic_load_n (&this->slots[index], __ATOMIC_ACQUIRE);
+
+        if (slot == hash) {
+            return true;
+        }
+
+        if (slot == STATE_SET_EMPTY) {
+            return false;
+        }
+    }
+}
+
+
+/*
+ * Description : Free an allocated StateSet structure.
+ * StateSet *this : An allocated StateSet to free.
+ */
+void
+StateSet_free (
+    StateSet *this
+) {
+    if (this != NULL)
+    {
+        free (this->slots);
+        free (this);
+    }
+}
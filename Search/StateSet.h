@@ -0,0 +1,97 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+
+
+// ------ Structure declaration -------
+
+typedef enum {
+    STATE_SET_INSERTED,
+    STATE_SET_SEEN,
+    STATE_SET_FULL,
+}   StateSetStatus;
+
+/*
+ *    Lock-free set of 64 bits state hashes (open addressing, linear probing).
+ *    Hashes can be inserted from any thread, they are never removed.
+ */
+typedef struct _StateSet
+{
+    uint64_t *slots;
+    uint64_t mask;
+
+    // Number of hashes inserted
+    int64_t count;
+
+}   StateSet;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Allocate a new StateSet structure.
+ * int64_t capacity : Maximum number of hashes, the table is twice as large
+ * Return        : A pointer to an allocated StateSet.
+ */
+StateSet *
+StateSet_new (
+    int64_t capacity
+);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Initialize an allocated StateSet structure.
+ * StateSet *this : An allocated StateSet to initialize.
+ * int64_t capacity : Maximum number of hashes, the table is twice as large
+ * Return : true on success, false on failure.
+ */
+bool
+StateSet_init (
+    StateSet *this,
+    int64_t capacity
+);
+
+/*
+ * Description : Insert a hash in the set
+ * StateSet *this : An allocated StateSet
+ * uint64_t hash : The hash of a state
+ * Return : StateSetStatus, STATE_SET_INSERTED if the hash was not in the set yet,
+ *          STATE_SET_SEEN if it was, STATE_SET_FULL if it couldn't be inserted
+ */
+StateSetStatus
+StateSet_insert (
+    StateSet *this,
+    uint64_t hash
+);
+
+/*
+ * Description : Check if a hash is in the set
+ * StateSet *this : An allocated StateSet
+ * uint64_t hash : The hash of a state
+ * Return : bool, true if the hash is in the set
+ */
+bool
+StateSet_contains (
+    StateSet *this,
+    uint64_t hash
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated StateSet structure.
+ * StateSet *this : An allocated StateSet to free.
+ */
+void
+StateSet_free (
+    StateSet *this
+);
+
+
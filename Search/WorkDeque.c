@@ -0,0 +1,175 @@
+#include "WorkDeque.h"
+#include <stdlib.h>
+
+// ---------- Debugging -------------
+#define __DEBUG_OBJECT__ "WorkDeque"
+#include "dbg/dbg.h"
+
+/*
+ * Description     : Allocate a new WorkDeque structure.
+ * int capacity : Maximum number of items, rounded up to a power of two
+ * Return        : A pointer to an allocated WorkDeque.
+ */
+WorkDeque *
+WorkDeque_new (
+    int capacity
+) {
+    WorkDeque *this;
+
+    if ((this = calloc (1, sizeof(WorkDeque))) == NULL)
+        return NULL;
+
+    if (!WorkDeque_init (this, capacity)) {
+        WorkDeque_free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+
+/*
+ * Description : Initialize an allocated WorkDeque structure.
+ * WorkDeque *this : An allocated WorkDeque to initialize.
+ * int capacity : Maximum number of items, rounded up to a power of two
+ * Return : true on success, false on failure.
+ */
+bool
+WorkDeque_init (
+    WorkDeque *this,
+    int capacity
+) {
+    int64_t size = 1;
+
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    if ((this->items = calloc (size, sizeof(void *))) == NULL) {
+        return false;
+    }
+
+    this->mask = size - 1;
+    this->top = 0;
+    this->bottom = 0;
+
+    return true;
+}
+
+
+/*
+ * Description : (Owner) Push an item at the bottom of the deque
+ * WorkDeque *this : An allocated WorkDeque
+ * void *item : The item to push
+ * Return : bool, false if the deque is full
+ */
+bool
+WorkDeque_push (
+    WorkDeque *this,
+    void *item
+) {
+    int64_t bottom = __atomic_load_n (&this->bottom, __ATOMIC_RELAXED);
+    int64_t top    = __atomic_load_n (&this->top, __ATOMIC_ACQUIRE);
+
+    if (bottom - top > this->mask) {
+        return false;
+    }
+
+    __atomic_store_n (&this->items[bottom & this->mask], item, __ATOMIC_RELAXED);
+    __atomic_store_n (&this->bottom, bottom + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+
+/*
+ * Description : (Owner) Pop the item at the bottom of the deque
+ * WorkDeque *this : An allocated WorkDeque
+ * Return : void * the item, NULL if the deque is empty
+ */
+void *
+WorkDeque_pop (
+    WorkDeque *this
+) {
+    int64_t bottom = __atomic_load_n (&this->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n (&this->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    int64_t top = __atomic_load_n (&this->top, __ATOMIC_RELAXED);
+
+    if (top > bottom) {
+        // Empty deque
+        __atomic_store_n (&this->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    void *item = __atomic_load_n (&this->items[bottom & this->mask], __ATOMIC_RELAXED);
+
+    if (top == bottom) {
+        // Last item : race against the thieves
+        if (!__atomic_compare_exchange_n (&this->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            item = NULL;
+        }
+        __atomic_store_n (&this->bottom, bottom + 1, __ATOMIC_RELAXED);
+    }
+
+    return item;
+}
+
+
+/*
+ * Description : (Thief) Steal the item at the top of the deque
+ * WorkDeque *this : An allocated WorkDeque
+ * Return : void * the item, NULL if the deque is empty or another thread won the race
+ */
+void *
+WorkDeque_steal (
+    WorkDeque *this
+) {
+    int64_t top = __atomic_load_n (&this->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    int64_t bottom = __atomic_load_n (&this->bottom, __ATOMIC_ACQUIRE);
+
+    if (top >= bottom) {
+        return NULL;
+    }
+
+    void *item = __atomic_load_n (&this->items[top & this->mask], __ATOMIC_RELAXED);
+
+    if (!__atomic_compare_exchange_n (&this->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        return NULL;
+    }
+
+    return item;
+}
+
+
+/*
+ * Description : Get an estimation of the number of items in the deque
+ * WorkDeque *this : An allocated WorkDeque
+ * Return : int64_t the number of items
+ */
+int64_t
+WorkDeque_getSize (
+    WorkDeque *this
+) {
+    int64_t size = __atomic_load_n (&this->bottom, __ATOMIC_RELAXED)
+                 - __atomic_load_n (&this->top, __ATOMIC_RELAXED);
+
+    return (size > 0) ? size : 0;
+}
+
+
+/*
+ * Description : Free an allocated WorkDeque structure.
+ * WorkDeque *this : An allocated WorkDeque to free.
+ */
+void
+WorkDeque_free (
+    WorkDeque *this
+) {
+    if (this != NULL)
+    {
+        free (this->items);
+        free (this);
+    }
+}
@@ -0,0 +1,108 @@
+// --- Author : Moreau Cyril - Spl3en
+#pragma once
+
+// ---------- Includes ------------
+#include "Utils/Utils.h"
+#include <stdint.h>
+
+// ---------- Defines -------------
+
+
+// ------ Structure declaration -------
+
+/*
+ *    Chase-Lev work-stealing deque with a fixed capacity.
+ *    The owner thread pushes and pops at the bottom, any other thread steals at the top.
+ */
+typedef struct _WorkDeque
+{
+    int64_t top    __attribute__ ((aligned (64)));
+    int64_t bottom __attribute__ ((aligned (64)));
+
+    void **items;
+    int64_t mask;
+
+}   WorkDeque;
+
+
+
+// --------- Allocators ---------
+
+/*
+ * Description     : Allocate a new WorkDeque structure.
+ * int capacity : Maximum number of items, rounded up to a power of two
+ * Return        : A pointer to an allocated WorkDeque.
+ */
+WorkDeque *
+WorkDeque_new (
+    int capacity
+);
+
+// ----------- Functions ------------
+
+/*
+ * Description : Initialize an allocated WorkDeque structure.
+ * WorkDeque *this : An allocated WorkDeque to initialize.
+ * int capacity : Maximum number of items, rounded up to a power of two
+ * Return : true on success, false on failure.
+ */
+bool
+WorkDeque_init (
+    WorkDeque *this,
+    int capacity
+);
+
+/*
+ * Description : (Owner) Push an item at the bottom of the deque
+ * WorkDeque *this : An allocated WorkDeque
+ * void *item : The item to push
+ * Return : bool, false if the deque is full
+ */
+bool
+WorkDeque_push (
+    WorkDeque *this,
+    void *item
+);
+
+/*
+ * Description : (Owner) Pop the item at the bottom of the deque
+ * WorkDeque *this : An allocated WorkDeque
+ * Return : void * the item, NULL if the deque is empty
+ */
+void *
+WorkDeque_pop (
+    WorkDeque *this
+);
+
+/*
+ * Description : (Thief) Steal the item at the top of the deque
+ * WorkDeque *this : An allocated WorkDeque
+ * Return : void * the item, NULL if the deque is empty or another thread won the race
+ */
+void *
+WorkDeque_steal (
+    WorkDeque *this
+);
+
+/*
+ * Description : Get an estimation of the number of items in the deque
+ * WorkDeque *this : An allocated WorkDeque
+ * Return : int64_t the number of items
+ */
+int64_t
+WorkDeque_getSize (
+    WorkDeque *this
+);
+
+// --------- Destructors ----------
+
+/*
+ * Description : Free an allocated WorkDeque structure.
+ * WorkDeque *this : An allocated WorkDeque to free.
+ */
+void
+WorkDeque_free (
+    WorkDeque *this
+);
+
+
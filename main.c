@@ -1,15 +1,130 @@
 #include "Chip8/CPU.h"
+#include "Chip8/RunAhead.h"
+#include <errno.h>
+
+static void
+usage (char *program) {
+    printf ("Usage : %s <game> [options]\n"
+            "  --latency                : measure the input to photon latency\n"
+            "  --single-thread          : run the window, the CPU and the screen on one thread\n"
+            "  --run-ahead <frames>     : show the frames 1 to %d frames ahead (single thread)\n"
+            "  --audio-buffer <samples> : samples per audio buffer, %d to %d (default : %d)\n",
+        program, RUN_AHEAD_MAX_FRAMES, AUDIO_MIN_BUFFER, AUDIO_MAX_BUFFER, AUDIO_DEFAULT_BUFFER);
+}
+
+/*
+ * Parse a decimal count of an option, rejecting anything else than a number between min and max
+ */
+static bool
+parseCount (
+    char *text,
+    int min,
+    int max,
+    int *count
+) {
+    char *end;
+    errno = 0;
+    long value = strtol (text, &end, 10);
+
+    if (end == text || *end != '\0' || errno != 0 || value < min || value > max) {
+        printf ("Error : \"%s\" is not a number between %d and %d.\n", text, min, max);
+        return false;
+    }
+
+    *count = value;
+    return true;
+}
+
+/*
+ * Run the window, the CPU and the screen on the main thread, in the same order each 60 Hz frame :
+ * poll the events, run a CPU slice, then render and present (the frame run ahead, if any)
+ */
+static void
+runSingleThread (
+    Window *window,
+    Cpu *cpu,
+    RunAhead *runAhead
+) {
+    sfClock *clock = sfClock_create ();
+    sfInt64 deadline = 0;
+
+    PROFILER_THREAD_NAME ("Main");
+
+    while (window->isRunning && cpu->isRunning)
+    {
+        Window_pollEvents (window);
+        Cpu_runSlice (cpu);
+
+        // Present the future frame, then go back to the real machine
+        if (runAhead) {
+            RunAhead_start (runAhead, cpu);
+            Screen_render (cpu->screen);
+            RunAhead_restore (runAhead, cpu);
+        } else {
+            Screen_render (cpu->screen);
+        }
+
+        // Sleep until the next frame, unless it is more than a frame late
+        sfInt64 now = sfTime_asMicroseconds (sfClock_getElapsedTime (clock));
+        deadline += SCREEN_FRAME_PERIOD;
+        if (deadline < now - SCREEN_FRAME_PERIOD) {
+            deadline = now;
+        }
+        else if (deadline > now) {
+            sfSleep (sfMicroseconds (deadline - now));
+        }
+    }
+
+    sfClock_destroy (clock);
+    Cpu_exitOnFault (cpu);
+    sfRenderWindow_close (window->sfmlWindow);
+}
+
 
 int main (int argc, char **argv)
 {
     Window *window;
     Cpu *cpu;
+    InputLatency *latency = NULL;
+    RunAhead *runAhead = NULL;
+    int runAheadFrames = 0;
+    int audioBuffer = AUDIO_DEFAULT_BUFFER;
+    bool isLatencyMeasured = false;
+    bool isSingleThread = false;
 
     if (argc < 2) {
-        printf ("Usage : %s <game>\n", file_get_filename (argv[0]));
+        usage (file_get_filename (argv[0]));
         return 0;
     }
 
+    for (int i = 2; i < argc; i++) {
+        if (strcmp (argv[i], "--latency") == 0) {
+            isLatencyMeasured = true;
+        }
+        else if (strcmp (argv[i], "--single-thread") == 0) {
+            isSingleThread = true;
+        }
+        else if (strcmp (argv[i], "--run-ahead") == 0 && i + 1 < argc) {
+            // The frames ahead are emulated between the slices : only without threads
+            if (!parseCount (argv[++i], 1, RUN_AHEAD_MAX_FRAMES, &runAheadFrames)) {
+                usage (file_get_filename (argv[0]));
+                return -1;
+            }
+            isSingleThread = true;
+        }
+        else if (strcmp (argv[i], "--audio-buffer") == 0 && i + 1 < argc) {
+            if (!parseCount (argv[++i], AUDIO_MIN_BUFFER, AUDIO_MAX_BUFFER, &audioBuffer)) {
+                usage (file_get_filename (argv[0]));
+                return -1;
+            }
+        }
+        else {
+            printf ("Error : Unknown option \"%s\".\n", argv[i]);
+            usage (file_get_filename (argv[0]));
+            return -1;
+        }
+    }
+
     // Open a new SFML Window
     if ((window = Window_new ()) == NULL) {
         printf ("Error : Cannot open a SFML window.\n");
@@ -28,22 +143,69 @@ int main (int argc, char **argv)
         return -1;
     }
 
+    // Always keep the last instructions, saved when the CPU faults
+    cpu->trace = CpuTrace_new ();
+
     // Load screen component
     cpu->screen = Screen_new (window->sfmlWindow);
 
-    // Start separate threads (CPU & Rendering)
-    Cpu_startThread (cpu);
-    Screen_startThread (cpu->screen);
+    // The CPU consumes the key events of the window
+    cpu->keyQueue = window->keyQueue;
 
-    // Start the event listener window
-    Window_loop (window);
+    // Measure the input to photon latency on demand : each thread tags its stage
+    if (isLatencyMeasured) {
+        if ((latency = InputLatency_new ()) == NULL) {
+            printf ("Error : Cannot measure the latency.\n");
+            return -1;
+        }
+        window->latency = cpu->latency = cpu->screen->latency = latency;
+    }
+
+    // Play the buzzer, or beep without sound card
+    if ((cpu->audio = Audio_new (audioBuffer)) != NULL) {
+        printf ("Audio : %d samples per buffer, %.1f ms buffered.\n", audioBuffer, Audio_getBufferLatency (cpu->audio));
+    }
 
-    // Request threads to exit gracefully
-    Screen_stopThread (cpu->screen);
-    Cpu_stopThread (cpu);
+    // Emulate frames ahead with the fast interpreter
+    if (runAheadFrames) {
+        if ((runAhead = RunAhead_new (runAheadFrames)) == NULL
+        ||  !Cpu_setEngine (cpu, CPU_ENGINE_FAST)) {
+            printf ("Error : Cannot run %d frames ahead.\n", runAheadFrames);
+            return -1;
+        }
+    }
+
+    if (isSingleThread) {
+        // Deterministic order, no thread
+        if (!Cpu_initProfilers (cpu)) {
+            return -1;
+        }
+        runSingleThread (window, cpu, runAhead);
+    }
+    else {
+        // Start separate threads (CPU & Rendering)
+        Cpu_startThread (cpu);
+        Screen_startThread (cpu->screen);
+
+        // Start the event listener window
+        Window_loop (window);
+
+        // Request threads to exit gracefully
+        Screen_stopThread (cpu->screen);
+        Cpu_stopThread (cpu);
+    }
+
+    if (latency) {
+        ProfilerFactory_reportHistograms (stdout);
+        InputLatency_free (latency);
+    }
 
     // Clean memory gracefully
+    Audio_free (cpu->audio);
+    RunAhead_free (runAhead);
+    CpuTrace_free (cpu->trace);
     Cpu_free (cpu);
+    ProfilerFactory_free ();
 
     return 0;
 }
@@ -0,0 +1,333 @@
+// --- Author : Moreau Cyril - Spl3en
+// Golden tests : replays a movie on each ROM headless and compares the framebuffer hashes to the recorded ones.
+#include "Batch/Batch.h"
+#include "Chip8/Movie.h"
+#include <dirent.h>
+#include <unistd.h>
+
+// ---------- Defines -------------
+#define GOLDEN_MAX_ROMS 256
+#define GOLDEN_FRAMES 1800
+#define GOLDEN_CHECKPOINT_FRAMES 300
+#define GOLDEN_CHECKPOINTS (GOLDEN_FRAMES / GOLDEN_CHECKPOINT_FRAMES)
+#define GOLDEN_KEY_HOLD_FRAMES 12
+#define GOLDEN_MAX_THREADS 64
+
+typedef struct {
+    char name [256];
+    char romFilename [1024];
+    char movieFilename [1024];
+
+    // Framebuffer hashes at each checkpoint : expected (from the golden file) and computed
+    uint64_t expected [GOLDEN_CHECKPOINTS];
+    uint64_t hashes [GOLDEN_CHECKPOINTS];
+    bool hasExpected;
+    bool hasRun;
+} GoldenRom;
+
+typedef struct {
+    GoldenRom roms [GOLDEN_MAX_ROMS];
+    int romsCount;
+    int nextRom;
+    bool update;
+    CpuEngine engine;
+    char *wavDirectory;
+} GoldenTests;
+
+static void
+usage (char *program) {
+    printf ("Usage : %s [options]\n"
+            "  -g directory : ROMs tested (default : \"games\")\n"
+            "  -m directory : input movies, one <ROM>.c8m per ROM (default : \"tests/movies\")\n"
+            "  -f file      : golden hashes (default : \"tests/golden.txt\")\n"
+            "  -t threads   : ROMs tested in parallel (default : 4)\n"
+            "  -e engine    : CPU interpreter, \"reference\" or \"fast\" (default : reference)\n"
+            "  -w directory : write the buzzer output of each movie in <ROM>.wav (default : none)\n"
+            "  -u           : record the golden hashes again, and the missing movies\n",
+        program);
+}
+
+/*
+ * FNV-1a of the framebuffer : it only depends on the pixels, not on the emulator internals
+ */
+static uint64_t
+hashFramebuffer (Screen *screen) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    for (int pos = 0; pos < RESOLUTION_W * RESOLUTION_H; pos++) {
+        hash = (hash ^ screen->framebuffer[pos]) * 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+/*
+ * Input of the movies recorded when missing : a random key, or none, held for a few frames
+ */
+static Movie *
+recordMovie (uint32_t seed) {
+    Movie *movie = Movie_new (seed);
+    uint32_t x = seed | 1;
+    uint16_t keys = 0;
+
+    for (int frame = 0; frame < GOLDEN_FRAMES; frame++) {
+        if (frame % GOLDEN_KEY_HOLD_FRAMES == 0) {
+            x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+            keys = (x & 0x10) ? 0 : (1 << (x & 0xF));
+        }
+        Movie_addFrame (movie, keys);
+    }
+
+    return movie;
+}
+
+/*
+ * Replay the movie of a ROM and hash the framebuffer at each checkpoint
+ */
+static bool
+runRom (GoldenRom *rom, CpuEngine engine, char *wavDirectory) {
+    Movie *movie;
+    Cpu *cpu;
+    AudioCapture *capture = NULL;
+
+    if ((movie = Movie_load (rom->movieFilename)) == NULL) {
+        return false;
+    }
+
+    if ((cpu = Batch_newMachine (rom->romFilename)) == NULL || !Cpu_setEngine (cpu, engine)) {
+        Cpu_free (cpu);
+        Movie_free (movie);
+        return false;
+    }
+
+    // The buzzer is synthesized from the sound timer, no audio device is needed
+    if (wavDirectory && (cpu->capture = capture = AudioCapture_new (AUDIO_SAMPLE_RATE)) == NULL) {
+        Cpu_free (cpu);
+        Movie_free (movie);
+        return false;
+    }
+
+    Cpu_seed (cpu, movie->seed);
+
+    for (int frame = 0; frame < GOLDEN_FRAMES; frame++) {
+        Cpu_setKeys (cpu, Movie_getKeys (movie, frame));
+        Cpu_emulateFrame (cpu);
+
+        if ((frame + 1) % GOLDEN_CHECKPOINT_FRAMES == 0) {
+            rom->hashes[frame / GOLDEN_CHECKPOINT_FRAMES] = hashFramebuffer (cpu->screen);
+        }
+    }
+
+    bool isSaved = true;
+    if (capture) {
+        char wavFilename [1024];
+        snprintf (wavFilename, sizeof(wavFilename), "%s/%s.wav", wavDirectory, rom->name);
+        isSaved = AudioCapture_saveWav (capture, wavFilename);
+        AudioCapture_free (capture);
+    }
+
+    Cpu_free (cpu);
+    Movie_free (movie);
+
+    return isSaved;
+}
+
+/*
+ * Worker thread : takes the next ROM to test until there is none left
+ */
+static void
+runWorker (GoldenTests *tests) {
+    int id;
+
+    while ((id = __atomic_fetch_add (&tests->nextRom, 1, __ATOMIC_RELAXED)) < tests->romsCount) {
+        tests->roms[id].hasRun = runRom (&tests->roms[id], tests->engine, tests->wavDirectory);
+    }
+}
+
+/*
+ * List the ROMs of a directory, sorted by name
+ */
+static bool
+listRoms (GoldenTests *tests, char *gamesDirectory, char *moviesDirectory) {
+    struct dirent **entries;
+    int entriesCount;
+
+    if ((entriesCount = scandir (gamesDirectory, &entries, NULL, alphasort)) < 0) {
+        printf ("Error : Cannot list the ROMs of \"%s\".\n", gamesDirectory);
+        return false;
+    }
+
+    for (int i = 0; i < entriesCount; i++) {
+        if (entries[i]->d_name[0] != '.' && tests->romsCount < GOLDEN_MAX_ROMS) {
+            GoldenRom *rom = &tests->roms[tests->romsCount++];
+            snprintf (rom->name, sizeof(rom->name), "%s", entries[i]->d_name);
+            snprintf (rom->romFilename, sizeof(rom->romFilename), "%s/%s", gamesDirectory, entries[i]->d_name);
+            snprintf (rom->movieFilename, sizeof(rom->movieFilename), "%s/%s.c8m", moviesDirectory, entries[i]->d_name);
+        }
+        free (entries[i]);
+    }
+    free (entries);
+
+    return true;
+}
+
+/*
+ * Golden file : one line per ROM, its name followed by the framebuffer hash at each checkpoint
+ */
+static void
+readGolden (GoldenTests *tests, char *filename) {
+    FILE *file;
+    char line [1024];
+
+    if ((file = fopen (filename, "r")) == NULL) {
+        return;
+    }
+
+    while (fgets (line, sizeof(line), file)) {
+        char name [256];
+        int offset;
+
+        if (line[0] == '#' || sscanf (line, "%255s%n", name, &offset) != 1) {
+            continue;
+        }
+
+        for (int id = 0; id < tests->romsCount; id++) {
+            GoldenRom *rom = &tests->roms[id];
+            if (strcmp (rom->name, name) != 0) {
+                continue;
+            }
+
+            char *cursor = line + offset;
+            rom->hasExpected = true;
+            for (int checkpoint = 0; checkpoint < GOLDEN_CHECKPOINTS; checkpoint++) {
+                char *end;
+                rom->expected[checkpoint] = strtoull (cursor, &end, 16);
+                rom->hasExpected &= (end != cursor);
+                cursor = end;
+            }
+        }
+    }
+
+    fclose (file);
+}
+
+static bool
+writeGolden (GoldenTests *tests, char *filename) {
+    FILE *file;
+
+    if ((file = fopen (filename, "w")) == NULL) {
+        printf ("Error : Cannot write \"%s\".\n", filename);
+        return false;
+    }
+
+    fprintf (file, "# ROM, then the framebuffer hash (FNV-1a) every %d frames of its movie\n", GOLDEN_CHECKPOINT_FRAMES);
+    for (int id = 0; id < tests->romsCount; id++) {
+        GoldenRom *rom = &tests->roms[id];
+        if (!rom->hasRun) {
+            continue;
+        }
+        fprintf (file, "%s", rom->name);
+        for (int checkpoint = 0; checkpoint < GOLDEN_CHECKPOINTS; checkpoint++) {
+            fprintf (file, " %016llx", (unsigned long long) rom->hashes[checkpoint]);
+        }
+        fprintf (file, "\n");
+    }
+
+    fclose (file);
+    return true;
+}
+
+int main (int argc, char **argv)
+{
+    static GoldenTests tests;
+    char *gamesDirectory = "games";
+    char *moviesDirectory = "tests/movies";
+    char *goldenFilename = "tests/golden.txt";
+    int threadsCount = 4;
+    int option;
+
+    while ((option = getopt (argc, argv, "g:m:f:t:e:w:u")) != -1) {
+        switch (option) {
+            case 'g': gamesDirectory = optarg; break;
+            case 'm': moviesDirectory = optarg; break;
+            case 'f': goldenFilename = optarg; break;
+            case 't': threadsCount = atoi (optarg); break;
+            case 'u': tests.update = true; break;
+            case 'w': tests.wavDirectory = optarg; break;
+            case 'e':
+                for (tests.engine = 0; tests.engine < cpuEngineCount
+                    && strcmp (optarg, Cpu_getEngineName (tests.engine)) != 0; tests.engine++);
+            break;
+            default : usage (file_get_filename (argv[0])); return 0;
+        }
+    }
+
+    if (threadsCount <= 0 || threadsCount > GOLDEN_MAX_THREADS || tests.engine >= cpuEngineCount) {
+        usage (file_get_filename (argv[0]));
+        return 0;
+    }
+
+    if (!listRoms (&tests, gamesDirectory, moviesDirectory)) {
+        return -1;
+    }
+    readGolden (&tests, goldenFilename);
+
+    // Record the movies missing, seeded from the ROM index
+    if (tests.update) {
+        for (int id = 0; id < tests.romsCount; id++) {
+            if (access (tests.roms[id].movieFilename, F_OK) != 0) {
+                Movie *movie = recordMovie (id + 1);
+                Movie_save (movie, tests.roms[id].movieFilename);
+                Movie_free (movie);
+            }
+        }
+    }
+
+    sfClock *clock = sfClock_create ();
+    sfThread *threads [GOLDEN_MAX_THREADS];
+    for (int thread = 0; thread < threadsCount; thread++) {
+        threads[thread] = sfThread_create ((void *) runWorker, &tests);
+        sfThread_launch (threads[thread]);
+    }
+    for (int thread = 0; thread < threadsCount; thread++) {
+        sfThread_wait (threads[thread]);
+        sfThread_destroy (threads[thread]);
+    }
+    float seconds = sfTime_asSeconds (sfClock_getElapsedTime (clock));
+    sfClock_destroy (clock);
+
+    if (tests.update) {
+        if (!writeGolden (&tests, goldenFilename)) {
+            return -1;
+        }
+        printf ("%d ROMs recorded in \"%s\" (%.2fs).\n", tests.romsCount, goldenFilename, seconds);
+        return 0;
+    }
+
+    int failuresCount = 0;
+    for (int id = 0; id < tests.romsCount; id++) {
+        GoldenRom *rom = &tests.roms[id];
+        bool isPassed = rom->hasRun && rom->hasExpected;
+
+        for (int checkpoint = 0; checkpoint < GOLDEN_CHECKPOINTS && isPassed; checkpoint++) {
+            if (rom->hashes[checkpoint] != rom->expected[checkpoint]) {
+                printf ("FAIL %-12s framebuffer differs at the frame %d\n",
+                    rom->name, (checkpoint + 1) * GOLDEN_CHECKPOINT_FRAMES);
+                isPassed = false;
+            }
+        }
+
+        if (!rom->hasRun) {
+            printf ("FAIL %-12s cannot load the ROM or \"%s\", or write its WAV file\n", rom->name, rom->movieFilename);
+        }
+        else if (!rom->hasExpected) {
+            printf ("FAIL %-12s has no golden hashes (record them with -u)\n", rom->name);
+        }
+
+        failuresCount += !isPassed;
+    }
+
+    printf ("%d/%d ROMs passed (%.2fs).\n", tests.romsCount - failuresCount, tests.romsCount, seconds);
+
+    return (failuresCount == 0) ? 0 : 1;
+}
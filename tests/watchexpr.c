@@ -0,0 +1,68 @@
+// --- Author : Moreau Cyril - Spl3en
+// Watch expression tests : evaluates expressions with known results, folded at parse time or computed on a machine.
+#include "Batch/WatchExpr.h"
+
+typedef struct {
+    char *source;
+    int32_t expected;
+} WatchTest;
+
+// V0 = 0, V1 = 0, V2 = 10, mem[0x300] = 0x42
+static WatchTest tests [] = {
+    // Precedence and signed arithmetic
+    {"1 + 2 * 3",                           7},
+    {"(1 + 2) * 3",                         9},
+    {"-7 / 2",                              -3},
+    {"-7 % 2",                              -1},
+    {"V2 / 3 + mem[0x300]",                 3 + 0x42},
+    {"V2 > 5 && V0 == 0",                   1},
+
+    // Division by zero gives 0
+    {"7 / 0",                               0},
+    {"V2 % V0",                             0},
+
+    // INT32_MIN / -1 overflows : folded at parse time, then computed from the registers
+    {"0x80000000 / -1",                     INT32_MIN},
+    {"0x80000000 % -1",                     0},
+    {"(V0 - 0x7FFFFFFF - 1) / (V1 - 1)",    INT32_MIN},
+    {"(V0 - 0x7FFFFFFF - 1) % (V1 - 1)",    0},
+};
+
+int main (int argc, char **argv)
+{
+    Cpu *cpu;
+    int failuresCount = 0;
+    int testsCount = sizeof_array (tests);
+
+    if ((cpu = Cpu_new ()) == NULL) {
+        printf ("Error : Cannot instantiate the machine.\n");
+        return -1;
+    }
+
+    cpu->V[2] = 10;
+    cpu->memory[0x300] = 0x42;
+
+    for (int id = 0; id < testsCount; id++) {
+        WatchTest *test = &tests[id];
+        WatchExpr *expr;
+
+        if ((expr = WatchExpr_new (test->source)) == NULL) {
+            printf ("FAIL \"%s\" cannot be parsed\n", test->source);
+            failuresCount++;
+            continue;
+        }
+
+        int32_t value = WatchExpr_evaluate (expr, cpu);
+        if (value != test->expected) {
+            printf ("FAIL \"%s\" = %d, expected %d\n", test->source, value, test->expected);
+            failuresCount++;
+        }
+
+        WatchExpr_free (expr);
+    }
+
+    printf ("%d/%d expressions passed.\n", testsCount - failuresCount, testsCount);
+    Cpu_free (cpu);
+
+    return (failuresCount == 0) ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+// --- Author : Moreau Cyril - Spl3en
+// Runs many window-free machines and exposes them to a trainer process through a shared memory ring.
+#define _GNU_SOURCE
+#include "Batch/Batch.h"
+#include "Batch/ObservationRing.h"
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+
+// ---------- Defines -------------
+#define DEFAULT_MACHINES_COUNT 1
+#define DEFAULT_SLOTS_COUNT 4
+
+static volatile sig_atomic_t isInterrupted = false;
+static ObservationRing *ring = NULL;
+
+static void
+onInterrupt (int signal) {
+    isInterrupted = true;
+
+    // Wake up the waits for the trainer : closing only stores a flag and wakes the futexes
+    if (ring) {
+        ObservationRing_close (ring);
+    }
+}
+
+static void
+usage (char *program) {
+    printf ("Usage : %s [-n machines] [-s slots] [-c core] [-m frames] [-f] [-l] [-r expr] [-d expr] [-a] [-o] <shm name> <game>\n"
+            "  -n : number of machines (default %d)\n"
+            "  -s : frames held by the ring (default %d)\n"
+            "  -c : pin the emulator to a CPU core\n"
+            "  -m : stop after a number of frames (default : never)\n"
+            "  -f : free run, don't wait for the trainer actions before each frame\n"
+            "  -l : freeze the machines looping with the same keys until their keys change\n"
+            "  -r : reward expression evaluated after each frame, e.g. \"mem[0x2F0] + 10*mem[0x2F1]\"\n"
+            "  -d : done expression stopping a machine when not zero, e.g. \"V3 == 0\"\n"
+            "  -a : publish the buzzer output of each frame, %d samples at %d Hz\n"
+            "  -o : replace the shared memory of the same name, left by an emulator which crashed\n",
+        program, DEFAULT_MACHINES_COUNT, DEFAULT_SLOTS_COUNT,
+        OBSERVATION_RING_AUDIO_SAMPLES, OBSERVATION_RING_AUDIO_RATE);
+}
+
+int main (int argc, char **argv)
+{
+    int machinesCount = DEFAULT_MACHINES_COUNT;
+    int slotsCount = DEFAULT_SLOTS_COUNT;
+    int core = -1;
+    long maxFrames = 0;
+    uint32_t flags = OBSERVATION_RING_LOCKSTEP;
+    bool detectCycles = false;
+    WatchExpr *rewardExpr = NULL;
+    WatchExpr *doneExpr = NULL;
+    int option;
+
+    while ((option = getopt (argc, argv, "n:s:c:m:flr:d:ao")) != -1) {
+        switch (option) {
+            case 'n': machinesCount = atoi (optarg); break;
+            case 's': slotsCount = atoi (optarg); break;
+            case 'c': core = atoi (optarg); break;
+            case 'm': maxFrames = atol (optarg); break;
+            case 'f': flags &= ~OBSERVATION_RING_LOCKSTEP; break;
+            case 'l': detectCycles = true; break;
+            case 'a': flags |= OBSERVATION_RING_AUDIO; break;
+            case 'o': flags |= OBSERVATION_RING_REPLACE; break;
+            case 'r': if (!(rewardExpr = WatchExpr_new (optarg))) return -1; break;
+            case 'd': if (!(doneExpr = WatchExpr_new (optarg))) return -1; break;
+            default : usage (file_get_filename (argv[0])); return 0;
+        }
+    }
+
+    if (argc - optind < 2 || slotsCount <= 0) {
+        usage (file_get_filename (argv[0]));
+        return 0;
+    }
+
+    // Keep the emulator on its own core
+    if (core >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO (&cpus);
+        CPU_SET (core, &cpus);
+        if (sched_setaffinity (0, sizeof(cpus), &cpus) != 0) {
+            printf ("Warning : Cannot pin the emulator to the core %d.\n", core);
+        }
+    }
+
+    Batch *batch;
+    if ((batch = Batch_new (machinesCount, argv[optind + 1])) == NULL) {
+        printf ("Error : Cannot instantiate the machines.\n");
+        return -1;
+    }
+    Batch_setWatches (batch, rewardExpr, doneExpr);
+    Batch_setCycleDetection (batch, detectCycles);
+
+    if ((flags & OBSERVATION_RING_AUDIO) && !Batch_setAudioCapture (batch, OBSERVATION_RING_AUDIO_RATE)) {
+        printf ("Error : Cannot capture the audio of the machines.\n");
+        Batch_free (batch);
+        return -1;
+    }
+
+    if ((ring = ObservationRing_new (argv[optind], machinesCount, slotsCount, flags)) == NULL) {
+        printf ("Error : Cannot create the observation ring.\n");
+        Batch_free (batch);
+        return -1;
+    }
+
+    signal (SIGINT, onInterrupt);
+    signal (SIGTERM, onInterrupt);
+
+    while (!isInterrupted && (maxFrames == 0 || batch->frame < maxFrames))
+    {
+        uint16_t *actions;
+        ObservationSlot *slots;
+
+        // Apply the keys pushed by the trainer
+        if ((actions = ObservationRing_waitActions (ring)) == NULL) {
+            break;
+        }
+        for (int id = 0; id < machinesCount; id++) {
+            Batch_setKeys (batch, id, actions[id]);
+        }
+
+        Batch_emulateFrame (batch);
+
+        // Publish the observations
+        if ((slots = ObservationRing_acquireFrame (ring)) == NULL) {
+            break;
+        }
+        for (int id = 0; id < machinesCount; id++) {
+            ObservationSlot *slot = &slots[id];
+            slot->frame  = batch->frame;
+            slot->keys   = Batch_getKeys (batch, id);
+            slot->status = Batch_getStatus (batch, id);
+            slot->reward = batch->rewards[id];
+            memcpy (slot->framebuffer, batch->machines[id]->screen->framebuffer, sizeof(slot->framebuffer));
+
+            if (flags & OBSERVATION_RING_AUDIO) {
+                Batch_getAudio (batch, id, ObservationRing_getAudio (ring, slots, id), OBSERVATION_RING_AUDIO_SAMPLES);
+            }
+        }
+        ObservationRing_publishFrame (ring);
+    }
+
+    signal (SIGINT, SIG_DFL);
+    signal (SIGTERM, SIG_DFL);
+    ObservationRing_close (ring);
+    ObservationRing_free (ring);
+    Batch_free (batch);
+    WatchExpr_free (rewardExpr);
+    WatchExpr_free (doneExpr);
+
+    return 0;
+}
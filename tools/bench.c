@@ -0,0 +1,212 @@
+// --- Author : Moreau Cyril - Spl3en
+// Runs ROMs headless with a scripted input and reports the emulation speed of each one.
+#include "Batch/Batch.h"
+#include "Chip8/Movie.h"
+#include <dirent.h>
+#include <math.h>
+#include <unistd.h>
+
+// ---------- Defines -------------
+#define DEFAULT_BENCH_FRAMES 20000
+#define DEFAULT_BENCH_REPETITIONS 5
+#define DEFAULT_BENCH_MIN_SAMPLE_MS 100 // A sample repeats its run until then, short runs are mostly noise
+#define BENCH_MAX_REPETITIONS 100
+
+typedef struct {
+    uint64_t instructions;
+    uint64_t draws;
+    uint32_t frames;
+    double seconds [BENCH_MAX_REPETITIONS];
+} BenchResult;
+
+static CpuEngine engine = CPU_ENGINE_REFERENCE;
+
+static void
+usage (char *program) {
+    printf ("Usage : %s [options] [games or directories...]\n"
+            "  -f frames : guest frames emulated by each run (default : %d)\n"
+            "  -n runs   : repetitions of each ROM (default : %d, max : %d)\n"
+            "  -t ms     : minimum time of each repetition, the run is repeated until then (default : %d)\n"
+            "  -r seed   : seed of the CXNN random generator and of the input script (default : 0)\n"
+            "  -c speed  : CPU cycles per frame (default : %d)\n"
+            "  -e engine : CPU interpreter, \"reference\" or \"fast\" (default : reference)\n"
+            "The ROMs of the \"games\" directory are run when none is given.\n",
+        program, DEFAULT_BENCH_FRAMES, DEFAULT_BENCH_REPETITIONS, BENCH_MAX_REPETITIONS, DEFAULT_BENCH_MIN_SAMPLE_MS,
+        DEFAULT_CPU_SPEED);
+}
+
+static int
+compareDoubles (const void *a, const void *b) {
+    double x = *(double *) a, y = *(double *) b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Run a ROM from the same boot state for each repetition, as many times as needed to last minSampleMs
+ */
+static bool
+benchRom (char *filename, int frames, int repetitions, int minSampleMs, uint32_t seed, int speed, BenchResult *result) {
+    Cpu *cpu;
+    CpuState *boot;
+
+    if ((cpu = Batch_newMachine (filename)) == NULL) {
+        return false;
+    }
+
+    if ((boot = malloc (sizeof(CpuState))) == NULL || !Cpu_setEngine (cpu, engine)) {
+        free (boot);
+        Cpu_free (cpu);
+        return false;
+    }
+
+    cpu->speed = speed;
+    Cpu_seed (cpu, seed);
+    Cpu_saveState (cpu, boot);
+    memset (result, 0, sizeof(BenchResult));
+
+    // Counting run, out of the measures : the runs are deterministic
+    for (int frame = 0; frame < frames && cpu->isRunning; frame++, result->frames++) {
+        Cpu_setKeys (cpu, Movie_getScriptedKeys (seed, frame));
+        for (int cycle = 0; cycle < cpu->speed && cpu->isRunning; cycle++) {
+            Cpu_emulateCycle (cpu);
+            result->instructions++;
+            if ((cpu->opcode & 0xF000) == 0xD000) {
+                result->draws++;
+            }
+        }
+        Cpu_updateTimers (cpu);
+    }
+
+    // Measured runs : each sample is the mean of the passes lasting minSampleMs
+    for (int run = 0; run < repetitions; run++) {
+        sfClock *clock = sfClock_create ();
+        sfInt64 elapsed;
+        int passes = 0;
+
+        do {
+            Cpu_loadState (cpu, boot);
+            for (int frame = 0; frame < frames && cpu->isRunning; frame++) {
+                Cpu_setKeys (cpu, Movie_getScriptedKeys (seed, frame));
+                Cpu_emulateFrame (cpu);
+            }
+            passes++;
+            elapsed = sfTime_asMicroseconds (sfClock_getElapsedTime (clock));
+        } while (elapsed < minSampleMs * 1000LL);
+
+        result->seconds[run] = elapsed / 1000000.0 / passes;
+        sfClock_destroy (clock);
+    }
+
+    free (boot);
+    Cpu_free (cpu);
+
+    return true;
+}
+
+/*
+ * Print the statistics of a ROM : rates are given for the median run
+ */
+static void
+printResult (char *name, BenchResult *result, int repetitions) {
+    double sorted [BENCH_MAX_REPETITIONS];
+    double mean = 0, variance = 0;
+
+    memcpy (sorted, result->seconds, repetitions * sizeof(double));
+    qsort (sorted, repetitions, sizeof(double), compareDoubles);
+
+    for (int run = 0; run < repetitions; run++) {
+        mean += sorted[run] / repetitions;
+    }
+    for (int run = 0; run < repetitions; run++) {
+        variance += (sorted[run] - mean) * (sorted[run] - mean) / repetitions;
+    }
+
+    double median = (repetitions % 2) ? sorted[repetitions / 2]
+                                      : (sorted[repetitions / 2 - 1] + sorted[repetitions / 2]) / 2;
+
+    printf ("%-12s %8u %10llu %8llu %9.2f %11.0f %7.2f %8.3f %6.2f%%\n",
+        name, result->frames,
+        (unsigned long long) result->instructions, (unsigned long long) result->draws,
+        result->instructions / median / 1000000.0, result->frames / median,
+        median * 1000000000.0 / result->instructions,
+        median * 1000.0, (mean > 0) ? sqrt (variance) * 100.0 / mean : 0.0);
+}
+
+/*
+ * Bench a ROM, or every ROM of a directory
+ */
+static void
+benchPath (char *path, int frames, int repetitions, int minSampleMs, uint32_t seed, int speed) {
+    DIR *directory;
+    BenchResult result;
+
+    if ((directory = opendir (path)) == NULL) {
+        if (benchRom (path, frames, repetitions, minSampleMs, seed, speed, &result)) {
+            printResult (file_get_filename (path), &result, repetitions);
+        } else {
+            printf ("%-12s cannot be loaded\n", file_get_filename (path));
+        }
+        return;
+    }
+
+    // Sorted, so the reports can be compared line by line
+    struct dirent **entries;
+    int entriesCount = scandir (path, &entries, NULL, alphasort);
+
+    for (int i = 0; i < entriesCount; i++) {
+        char filename [1024];
+
+        if (entries[i]->d_name[0] != '.') {
+            snprintf (filename, sizeof(filename), "%s/%s", path, entries[i]->d_name);
+            if (benchRom (filename, frames, repetitions, minSampleMs, seed, speed, &result)) {
+                printResult (entries[i]->d_name, &result, repetitions);
+            }
+        }
+        free (entries[i]);
+    }
+
+    free (entries);
+    closedir (directory);
+}
+
+int main (int argc, char **argv)
+{
+    int frames = DEFAULT_BENCH_FRAMES;
+    int repetitions = DEFAULT_BENCH_REPETITIONS;
+    int minSampleMs = DEFAULT_BENCH_MIN_SAMPLE_MS;
+    int speed = DEFAULT_CPU_SPEED;
+    uint32_t seed = 0;
+    int option;
+
+    while ((option = getopt (argc, argv, "f:n:t:r:c:e:")) != -1) {
+        switch (option) {
+            case 'f': frames = atoi (optarg); break;
+            case 'n': repetitions = atoi (optarg); break;
+            case 't': minSampleMs = atoi (optarg); break;
+            case 'r': seed = strtoul (optarg, NULL, 0); break;
+            case 'c': speed = atoi (optarg); break;
+            case 'e':
+                for (engine = 0; engine < cpuEngineCount && strcmp (optarg, Cpu_getEngineName (engine)) != 0; engine++);
+            break;
+            default : usage (file_get_filename (argv[0])); return 0;
+        }
+    }
+
+    if (frames <= 0 || speed <= 0 || minSampleMs < 0 || repetitions <= 0 || repetitions > BENCH_MAX_REPETITIONS || engine >= cpuEngineCount) {
+        usage (file_get_filename (argv[0]));
+        return 0;
+    }
+
+    printf ("%-12s %8s %10s %8s %9s %11s %7s %8s %7s\n",
+        "ROM", "frames", "insns", "DXYN", "MIPS", "frames/s", "ns/insn", "ms", "stddev");
+
+    if (optind >= argc) {
+        benchPath ("games", frames, repetitions, minSampleMs, seed, speed);
+    }
+
+    for (int arg = optind; arg < argc; arg++) {
+        benchPath (argv[arg], frames, repetitions, minSampleMs, seed, speed);
+    }
+
+    return 0;
+}
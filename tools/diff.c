@@ -0,0 +1,217 @@
+// --- Author : Moreau Cyril - Spl3en
+// Differential execution : runs the reference and the fast engines side by side and reports the first divergence.
+#include "Batch/Batch.h"
+#include "Chip8/FastCpu.h"
+#include "Chip8/Movie.h"
+#include <unistd.h>
+
+// ---------- Defines -------------
+#define DEFAULT_DIFF_FRAMES 36000
+
+static void
+usage (char *program) {
+    printf ("Usage : %s [options] <game>\n"
+            "  -m frames : frames emulated (default : %d)\n"
+            "  -i movie  : input movie (default : a random key held every %d frames)\n"
+            "  -r seed   : seed of the CXNN random generator and of the input (default : 0)\n"
+            "  -c speed  : CPU cycles per frame (default : %d)\n"
+            "  -b        : compare the states after each frame instead of each instruction\n",
+        program, DEFAULT_DIFF_FRAMES, MOVIE_SCRIPT_HOLD_FRAMES, DEFAULT_CPU_SPEED);
+}
+
+/*
+ * Compare the whole architectural state of two machines.
+ * Return the name of the first part which differs, NULL when the states are the same.
+ */
+static char *
+compareStates (Cpu *reference, Cpu *fast, char *part, size_t partSize) {
+    #define DIFF_CHECK(name, field) \
+        if (reference->field != fast->field) { \
+            snprintf (part, partSize, "%s : %X (reference) != %X (fast)", name, reference->field, fast->field); \
+            return part; \
+        }
+
+    DIFF_CHECK ("ip", ip);
+    DIFF_CHECK ("opcode", opcode);
+    DIFF_CHECK ("I", I);
+    DIFF_CHECK ("sp", sp);
+    DIFF_CHECK ("delay timer", delayTimer);
+    DIFF_CHECK ("sound timer", soundTimer);
+    DIFF_CHECK ("fault", fault);
+    DIFF_CHECK ("running state", isRunning);
+    DIFF_CHECK ("random generator", rngState);
+    #undef DIFF_CHECK
+
+    for (int id = 0; id < REGISTERS_COUNT; id++) {
+        if (reference->V[id] != fast->V[id]) {
+            snprintf (part, partSize, "V%X : %02X (reference) != %02X (fast)", id, reference->V[id], fast->V[id]);
+            return part;
+        }
+    }
+
+    for (int level = 0; level < reference->sp && level < STACK_SIZE; level++) {
+        if (reference->stack[level] != fast->stack[level]) {
+            snprintf (part, partSize, "stack[%d] : %04X (reference) != %04X (fast)",
+                level, reference->stack[level], fast->stack[level]);
+            return part;
+        }
+    }
+
+    for (int code = 0; code < KEYS_COUNT; code++) {
+        if (reference->keys[code] != fast->keys[code]) {
+            snprintf (part, partSize, "key %X : %d (reference) != %d (fast)",
+                code, reference->keys[code], fast->keys[code]);
+            return part;
+        }
+    }
+
+    // The hashes are compared first, the buffers only to locate the difference
+    if (reference->memoryHash != fast->memoryHash
+    ||  memcmp (reference->memory, fast->memory, MEMORY_SIZE) != 0) {
+        int address = 0;
+        while (address < MEMORY_SIZE - 1 && reference->memory[address] == fast->memory[address]) {
+            address++;
+        }
+        snprintf (part, partSize, "memory[%03X] : %02X (reference) != %02X (fast)",
+            address, reference->memory[address], fast->memory[address]);
+        return part;
+    }
+
+    Screen *referenceScreen = reference->screen, *fastScreen = fast->screen;
+    if (referenceScreen->framebufferHash != fastScreen->framebufferHash
+    ||  memcmp (referenceScreen->framebuffer, fastScreen->framebuffer, sizeof(fastScreen->framebuffer)) != 0) {
+        int pos = 0;
+        while (pos < RESOLUTION_W * RESOLUTION_H - 1 && referenceScreen->framebuffer[pos] == fastScreen->framebuffer[pos]) {
+            pos++;
+        }
+        snprintf (part, partSize, "pixel (%d, %d) : %d (reference) != %d (fast)",
+            pos % RESOLUTION_W, pos / RESOLUTION_W, referenceScreen->framebuffer[pos], fastScreen->framebuffer[pos]);
+        return part;
+    }
+
+    return NULL;
+}
+
+/*
+ * Print the instruction which made the engines diverge, and both states
+ */
+static void
+reportDivergence (Cpu *reference, Cpu *fast, char *part, int frame, uint64_t instructions, uint16_t ip, uint16_t opcode) {
+    printf ("Divergence at the frame %d, after %llu instructions : %s\n",
+        frame, (unsigned long long) instructions, part);
+
+    if (instructions > 0) {
+        // Cpu_disass shows the current opcode and IP
+        uint16_t currentIp = reference->ip, currentOpcode = reference->opcode;
+        reference->ip = ip;
+        reference->opcode = opcode;
+        printf ("Last instruction : ");
+        Cpu_disass (reference);
+        reference->ip = currentIp;
+        reference->opcode = currentOpcode;
+    }
+
+    printf ("\nReference :\n");
+    Cpu_debug (reference);
+    printf ("Fast :\n");
+    Cpu_debug (fast);
+}
+
+int main (int argc, char **argv)
+{
+    int frames = DEFAULT_DIFF_FRAMES;
+    int speed = DEFAULT_CPU_SPEED;
+    uint32_t seed = 0;
+    bool compareFrames = false;
+    Movie *movie = NULL;
+    int option;
+
+    while ((option = getopt (argc, argv, "m:i:r:c:b")) != -1) {
+        switch (option) {
+            case 'm': frames = atoi (optarg); break;
+            case 'r': seed = strtoul (optarg, NULL, 0); break;
+            case 'c': speed = atoi (optarg); break;
+            case 'b': compareFrames = true; break;
+            case 'i':
+                if ((movie = Movie_load (optarg)) == NULL) {
+                    return -1;
+                }
+            break;
+            default : usage (file_get_filename (argv[0])); return 0;
+        }
+    }
+
+    if (optind >= argc || speed <= 0) {
+        usage (file_get_filename (argv[0]));
+        return 0;
+    }
+
+    Cpu *reference, *fast;
+    if ((reference = Batch_newMachine (argv[optind])) == NULL
+    ||  (fast = Batch_newMachine (argv[optind])) == NULL
+    ||  !Cpu_setEngine (fast, CPU_ENGINE_FAST)) {
+        printf ("Error : Cannot instantiate the machines.\n");
+        return -1;
+    }
+
+    if (movie) {
+        seed = movie->seed;
+        frames = movie->framesCount;
+    }
+
+    Cpu *machines [] = {reference, fast};
+    for (int id = 0; id < 2; id++) {
+        machines[id]->speed = speed;
+        Cpu_seed (machines[id], seed);
+    }
+
+    char part [256];
+    uint64_t instructions = 0;
+    int frame;
+
+    for (frame = 0; frame < frames && (reference->isRunning || fast->isRunning); frame++)
+    {
+        uint16_t keys = (movie) ? Movie_getKeys (movie, frame) : Movie_getScriptedKeys (seed, frame);
+        Cpu_setKeys (reference, keys);
+        Cpu_setKeys (fast, keys);
+
+        if (compareFrames) {
+            Cpu_emulateFrame (reference);
+            FastCpu_emulateFrame (fast);
+            instructions += speed;
+            if (compareStates (reference, fast, part, sizeof(part))) {
+                reportDivergence (reference, fast, part, frame, 0, 0, 0);
+                return 1;
+            }
+            continue;
+        }
+
+        for (int cycle = 0; cycle < speed && (reference->isRunning || fast->isRunning); cycle++) {
+            uint16_t ip = reference->ip;
+            Cpu_emulateCycle (reference);
+            FastCpu_emulateCycle (fast);
+            instructions++;
+            if (compareStates (reference, fast, part, sizeof(part))) {
+                reportDivergence (reference, fast, part, frame, instructions, ip, reference->opcode);
+                return 1;
+            }
+        }
+
+        Cpu_updateTimers (reference);
+        Cpu_updateTimers (fast);
+        if (compareStates (reference, fast, part, sizeof(part))) {
+            reportDivergence (reference, fast, part, frame, 0, 0, 0);
+            return 1;
+        }
+    }
+
+    printf ("No divergence after %d frames and %llu instructions%s.\n",
+        frame, (unsigned long long) instructions,
+        (reference->fault) ? ", both stopped by the same fault" : "");
+
+    Movie_free (movie);
+    Cpu_free (reference);
+    Cpu_free (fast);
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+// --- Author : Moreau Cyril - Spl3en
+// Static disassembler : separates the code from the data of whole ROMs by recursive descent, and prints them with labels.
+#include "Chip8/CPU.h"
+#include "Chip8/Cfg.h"
+#include "Chip8/Disassembler.h"
+#include <dirent.h>
+#include <unistd.h>
+
+typedef struct {
+    int roms;
+    int instructions;
+    int blocks;
+    int subroutines;
+    int dataBytes;
+} DisasmTotals;
+
+static bool summaryOnly = false;
+
+static void
+usage (char *program) {
+    printf ("Usage : %s [options] [games or directories...]\n"
+            "  -s : print a summary of each ROM instead of its listing\n"
+            "The ROMs of the \"games\" directory are disassembled when none is given.\n",
+        program);
+}
+
+/*
+ * Print the ROM : instructions with their block and labels, data bytes with their pixels
+ */
+static void
+printListing (Cfg *cfg, uint8_t *memory) {
+    char label [16];
+
+    for (int address = cfg->start; address < cfg->end; )
+    {
+        if (Cfg_getLabel (cfg, address, label)) {
+            printf ("\n%s:\n", label);
+        }
+
+        if (cfg->flags[address] & CFG_INSN) {
+            char text [DISASSEMBLER_TEXT_SIZE];
+            uint16_t opcode = (memory[address] << 8) | memory[address + 1];
+            Disassembler_format (opcode, text);
+            printf ("    %03X  %04X    %s\n", address, opcode, text);
+            address += INSN_SIZE;
+            continue;
+        }
+
+        char pixels [9];
+        for (int bit = 0; bit < 8; bit++) {
+            pixels[bit] = (memory[address] & (0x80 >> bit)) ? '#' : '.';
+        }
+        pixels[8] = '\0';
+        printf ("    %03X  %02X      db   %02X         ; %s\n", address, memory[address], memory[address], pixels);
+        address++;
+    }
+}
+
+/*
+ * Disassemble a ROM file
+ */
+static bool
+disassembleRom (char *filename, DisasmTotals *totals) {
+    static uint8_t memory [MEMORY_SIZE];
+    FILE *file;
+    Cfg *cfg;
+
+    if ((file = fopen (filename, "rb")) == NULL) {
+        return false;
+    }
+    memset (memory, 0, sizeof(memory));
+    size_t size = fread (&memory[USER_SPACE_START_ADDRESS], 1, USER_PROGRAM_SPACE_SIZE, file);
+    fclose (file);
+
+    if ((cfg = Cfg_new (memory, USER_SPACE_START_ADDRESS, size)) == NULL) {
+        return false;
+    }
+
+    int instructions = 0, subroutines = 0, dataBytes = 0;
+    for (int address = cfg->start; address < cfg->end; address++) {
+        instructions += (cfg->flags[address] & CFG_INSN) != 0;
+        subroutines  += (cfg->flags[address] & CFG_SUBROUTINE) != 0;
+        dataBytes    += (cfg->flags[address] & CFG_CODE) == 0;
+    }
+
+    if (summaryOnly) {
+        printf ("%-12s %6zu %8d %8d %8d %8d\n",
+            file_get_filename (filename), size, instructions, cfg->blocksCount, subroutines, dataBytes);
+    } else {
+        printf ("; %s : %zu bytes, %d instructions in %d blocks, %d subroutines, %d data bytes\n",
+            file_get_filename (filename), size, instructions, cfg->blocksCount, subroutines, dataBytes);
+        printListing (cfg, memory);
+        printf ("\n");
+    }
+
+    totals->roms++;
+    totals->instructions += instructions;
+    totals->blocks += cfg->blocksCount;
+    totals->subroutines += subroutines;
+    totals->dataBytes += dataBytes;
+
+    Cfg_free (cfg);
+
+    return true;
+}
+
+/*
+ * Disassemble a ROM, or every ROM of a directory
+ */
+static void
+disassemblePath (char *path, DisasmTotals *totals) {
+    DIR *directory;
+
+    if ((directory = opendir (path)) == NULL) {
+        if (!disassembleRom (path, totals)) {
+            printf ("%-12s cannot be loaded\n", file_get_filename (path));
+        }
+        return;
+    }
+
+    struct dirent **entries;
+    int entriesCount = scandir (path, &entries, NULL, alphasort);
+
+    for (int i = 0; i < entriesCount; i++) {
+        char filename [1024];
+
+        if (entries[i]->d_name[0] != '.') {
+            snprintf (filename, sizeof(filename), "%s/%s", path, entries[i]->d_name);
+            disassembleRom (filename, totals);
+        }
+        free (entries[i]);
+    }
+
+    free (entries);
+    closedir (directory);
+}
+
+int main (int argc, char **argv)
+{
+    DisasmTotals totals = {0};
+    int option;
+
+    while ((option = getopt (argc, argv, "s")) != -1) {
+        switch (option) {
+            case 's': summaryOnly = true; break;
+            default : usage (file_get_filename (argv[0])); return 0;
+        }
+    }
+
+    if (summaryOnly) {
+        printf ("%-12s %6s %8s %8s %8s %8s\n", "ROM", "bytes", "insns", "blocks", "subs", "data");
+    }
+
+    sfClock *clock = sfClock_create ();
+
+    if (optind >= argc) {
+        disassemblePath ("games", &totals);
+    }
+
+    for (int arg = optind; arg < argc; arg++) {
+        disassemblePath (argv[arg], &totals);
+    }
+
+    double milliseconds = sfTime_asMicroseconds (sfClock_getElapsedTime (clock)) / 1000.0;
+    sfClock_destroy (clock);
+
+    printf ("%d ROMs : %d instructions in %d blocks, %d subroutines, %d data bytes (%.2f ms)\n",
+        totals.roms, totals.instructions, totals.blocks, totals.subroutines, totals.dataBytes, milliseconds);
+
+    return 0;
+}
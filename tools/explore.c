@@ -0,0 +1,139 @@
+// --- Author : Moreau Cyril - Spl3en
+// Explores the input sequences of a ROM across all cores to reach a goal or a crash.
+#include "Search/Explorer.h"
+#include <unistd.h>
+
+static void
+usage (char *program) {
+    printf ("Usage : %s [options] <game>\n"
+            "  -t threads : worker threads (default : 4)\n"
+            "  -f frames  : frames each input is held (default : %d)\n"
+            "  -d depth   : maximum number of inputs (default : unlimited)\n"
+            "  -n nodes   : maximum number of states reached (default : %d)\n"
+            "  -k keys    : keys tried, as hexadecimal digits (default : 0123456789ABCDEF)\n"
+            "  -g expr    : goal watch expression, e.g. \"mem[0x2F0] == 15\"\n"
+            "  -s expr    : score watch expression, enables the best first search\n"
+            "  -b width   : states kept at each depth by the best first search (default : 1000)\n"
+            "  -l state   : start from a save state instead of the boot\n"
+            "  -r seed    : seed of the CXNN random generator (default : 0)\n"
+            "  -x         : stop on the first CPU fault reached\n"
+            "  -o movie   : write the input movie reaching the goal (default : explore.c8m),\n"
+            "               and with -l, the state it starts from in <movie>.state\n",
+        program, DEFAULT_EXPLORER_FRAMES_PER_STEP, DEFAULT_EXPLORER_MAX_NODES);
+}
+
+int main (int argc, char **argv)
+{
+    int threadsCount = 4;
+    uint32_t maxNodes = DEFAULT_EXPLORER_MAX_NODES;
+    int framesPerStep = DEFAULT_EXPLORER_FRAMES_PER_STEP;
+    int maxDepth = INT16_MAX;
+    int beamWidth = 1000;
+    uint16_t keysMask = 0xFFFF;
+    char *goal = NULL, *score = NULL, *stateFilename = NULL;
+    char *movieFilename = "explore.c8m";
+    uint32_t seed = 0;
+    bool stopOnFault = false;
+    int option;
+
+    while ((option = getopt (argc, argv, "t:f:d:n:k:g:s:b:l:r:xo:")) != -1) {
+        switch (option) {
+            case 't': threadsCount = atoi (optarg); break;
+            case 'f': framesPerStep = atoi (optarg); break;
+            case 'd': maxDepth = atoi (optarg); break;
+            case 'n': maxNodes = strtoul (optarg, NULL, 10); break;
+            case 'g': goal = optarg; break;
+            case 's': score = optarg; break;
+            case 'b': beamWidth = atoi (optarg); break;
+            case 'l': stateFilename = optarg; break;
+            case 'r': seed = strtoul (optarg, NULL, 0); break;
+            case 'x': stopOnFault = true; break;
+            case 'o': movieFilename = optarg; break;
+            case 'k':
+                keysMask = 0;
+                for (char *digit = optarg; *digit; digit++) {
+                    char hex [] = {*digit, '\0'};
+                    keysMask |= 1 << (strtol (hex, NULL, 16) & 0xF);
+                }
+            break;
+            default : usage (file_get_filename (argv[0])); return 0;
+        }
+    }
+
+    if (optind >= argc || maxNodes < 1) {
+        usage (file_get_filename (argv[0]));
+        return 0;
+    }
+
+    Explorer *explorer;
+    if ((explorer = Explorer_new (argv[optind], threadsCount, maxNodes)) == NULL) {
+        printf ("Error : Cannot initialize the explorer.\n");
+        return -1;
+    }
+
+    explorer->framesPerStep = framesPerStep;
+    explorer->maxDepth = maxDepth;
+    explorer->stopOnFault = stopOnFault;
+    Explorer_setKeys (explorer, keysMask);
+
+    if ((goal  && !(explorer->goalExpr  = WatchExpr_new (goal)))
+    ||  (score && !(explorer->scoreExpr = WatchExpr_new (score)))) {
+        Explorer_free (explorer);
+        return -1;
+    }
+
+    if (explorer->scoreExpr) {
+        explorer->mode = EXPLORER_BEST_FIRST;
+        explorer->beamWidth = beamWidth;
+    }
+
+    if (stateFilename) {
+        if (!Explorer_startFromStateFile (explorer, stateFilename)) {
+            Explorer_free (explorer);
+            return -1;
+        }
+    } else {
+        Explorer_startFromBoot (explorer, seed);
+    }
+
+    uint32_t node = Explorer_run (explorer);
+    bool isSaved = false;
+
+    if (explorer->faultNode != EXPLORER_NO_NODE) {
+        printf ("A CPU fault is reachable in %d inputs.\n", explorer->nodes[explorer->faultNode].depth);
+    }
+
+    if (node != EXPLORER_NO_NODE) {
+        Movie *movie;
+        printf ("%s reached in %d inputs.\n", (node == explorer->faultNode) ? "Fault" : "Goal", explorer->nodes[node].depth);
+
+        if ((movie = Explorer_getMovie (explorer, node)) == NULL) {
+            printf ("Error : Cannot build the movie reaching it.\n");
+        } else if (!Movie_save (movie, movieFilename)) {
+            printf ("Error : Cannot write the movie in \"%s\".\n", movieFilename);
+        } else {
+            printf ("Movie of %d frames written to \"%s\".\n", movie->framesCount, movieFilename);
+            isSaved = true;
+        }
+        Movie_free (movie);
+
+        // A search started from a save state : the movie only replays from that state
+        if (isSaved && !explorer->isFromBoot) {
+            char startFilename [1024];
+            snprintf (startFilename, sizeof(startFilename), "%s.state", movieFilename);
+            if (!Explorer_saveStart (explorer, startFilename)) {
+                printf ("Error : Cannot write the starting state of the movie in \"%s\".\n", startFilename);
+            } else {
+                printf ("The movie starts from the save state written to \"%s\", not from the boot.\n", startFilename);
+            }
+        }
+    } else {
+        printf ("Goal not reached%s.\n", (explorer->hasFailed || explorer->isVisitedFull) ? " : the search stopped before its end" : "");
+    }
+
+    WatchExpr_free (explorer->goalExpr);
+    WatchExpr_free (explorer->scoreExpr);
+    Explorer_free (explorer);
+
+    return (isSaved) ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+// --- Author : Moreau Cyril - Spl3en
+// Coverage-guided fuzzer : mutates input movies and keeps those hitting new guest edges.
+#include "Search/Fuzzer.h"
+#include <signal.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t isInterrupted = false;
+
+static void
+onInterrupt (int signal) {
+    isInterrupted = true;
+}
+
+static void
+usage (char *program) {
+    printf ("Usage : %s [options] <game> [seed movies...]\n"
+            "  -r seed    : seed of the CXNN random generator and of the mutations (default : 0)\n"
+            "  -n count   : stop after a number of executions (default : unlimited)\n"
+            "  -t seconds : stop after a duration (default : unlimited)\n"
+            "  -m frames  : longest movie tried (default : %d)\n"
+            "  -o prefix  : prefix of the movies written (default : \"fuzz-\")\n"
+            "  -p         : measure the throughput with and without coverage on the final corpus\n",
+        program, DEFAULT_FUZZER_MAX_FRAMES);
+}
+
+/*
+ * Replay the whole corpus and return the frames emulated per second
+ */
+static double
+measureCorpus (Fuzzer *fuzzer, bool withCoverage) {
+    Cpu *cpu = fuzzer->cpu;
+    uint64_t frames = 0;
+    sfClock *clock = sfClock_create ();
+
+    cpu->coverageMap = (withCoverage) ? fuzzer->coverage : NULL;
+
+    for (int i = 0; i < fuzzer->corpusCount; i++) {
+        Movie *movie = fuzzer->corpus[i];
+        if (withCoverage) {
+            memset (fuzzer->coverage, 0, sizeof(fuzzer->coverage));
+        }
+        Cpu_loadState (cpu, &fuzzer->boot);
+        for (int frame = 0; frame < movie->framesCount && cpu->isRunning; frame++, frames++) {
+            Cpu_setKeys (cpu, movie->frames[frame]);
+            Cpu_emulateFrame (cpu);
+        }
+    }
+
+    double seconds = sfTime_asSeconds (sfClock_getElapsedTime (clock));
+    sfClock_destroy (clock);
+    cpu->coverageMap = fuzzer->coverage;
+
+    return frames / seconds;
+}
+
+int main (int argc, char **argv)
+{
+    uint32_t seed = 0;
+    uint64_t maxExecutions = 0;
+    float maxSeconds = 0;
+    int maxFrames = DEFAULT_FUZZER_MAX_FRAMES;
+    char *outputPrefix = "fuzz-";
+    bool measure = false;
+    int option;
+
+    while ((option = getopt (argc, argv, "r:n:t:m:o:p")) != -1) {
+        switch (option) {
+            case 'r': seed = strtoul (optarg, NULL, 0); break;
+            case 'n': maxExecutions = strtoull (optarg, NULL, 10); break;
+            case 't': maxSeconds = atof (optarg); break;
+            case 'm': maxFrames = atoi (optarg); break;
+            case 'o': outputPrefix = optarg; break;
+            case 'p': measure = true; break;
+            default : usage (file_get_filename (argv[0])); return 0;
+        }
+    }
+
+    if (optind >= argc || maxFrames <= 0) {
+        usage (file_get_filename (argv[0]));
+        return 0;
+    }
+
+    Fuzzer *fuzzer;
+    if ((fuzzer = Fuzzer_new (argv[optind], seed, outputPrefix)) == NULL) {
+        printf ("Error : Cannot initialize the fuzzer.\n");
+        return -1;
+    }
+    fuzzer->maxFrames = maxFrames;
+
+    // Seed movies
+    for (int arg = optind + 1; arg < argc; arg++) {
+        Movie *movie;
+        if ((movie = Movie_load (argv[arg])) != NULL) {
+            if (movie->framesCount > maxFrames) {
+                movie->framesCount = maxFrames;
+            }
+            Fuzzer_tryMovie (fuzzer, movie);
+        }
+    }
+
+    signal (SIGINT, onInterrupt);
+    sfClock *clock = sfClock_create ();
+    float lastReport = 0;
+
+    while (!isInterrupted
+       && (maxExecutions == 0 || fuzzer->executionsCount < maxExecutions)
+       && (maxSeconds == 0 || sfTime_asSeconds (sfClock_getElapsedTime (clock)) < maxSeconds))
+    {
+        Fuzzer_step (fuzzer);
+
+        float seconds = sfTime_asSeconds (sfClock_getElapsedTime (clock));
+        if (seconds - lastReport >= 1.0f) {
+            printf ("%6.0fs | %8llu execs (%6.0f/s) | %6.0f frames/s | %5d edges | %4d corpus | %3d faults\n",
+                seconds, (unsigned long long) fuzzer->executionsCount, fuzzer->executionsCount / seconds,
+                fuzzer->framesCount / seconds, fuzzer->edgesCount, fuzzer->corpusCount, fuzzer->faultsCount);
+            lastReport = seconds;
+        }
+    }
+
+    printf ("%llu executions, %d edges, %d movies in the corpus, %d faults.\n",
+        (unsigned long long) fuzzer->executionsCount, fuzzer->edgesCount, fuzzer->corpusCount, fuzzer->faultsCount);
+
+    if (measure && fuzzer->corpusCount > 0) {
+        double plain = measureCorpus (fuzzer, false);
+        double covered = measureCorpus (fuzzer, true);
+        printf ("Throughput : %.0f frames/s plain, %.0f frames/s with coverage (x%.2f)\n",
+            plain, covered, plain / covered);
+    }
+
+    sfClock_destroy (clock);
+    Fuzzer_free (fuzzer);
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+// --- Author : Moreau Cyril - Spl3en
+// Guest profiler : runs a ROM headless and reports where its instructions are spent, per address and per subroutine.
+#include "Batch/Batch.h"
+#include "Chip8/Movie.h"
+#include <unistd.h>
+
+// ---------- Defines -------------
+#define DEFAULT_PROFILE_FRAMES 3600
+#define DEFAULT_PROFILE_TOP 20
+#define DEFAULT_PROFILE_FILENAME "profile.folded"
+
+static void
+usage (char *program) {
+    printf ("Usage : %s [options] <game>\n"
+            "  -m frames : frames emulated (default : %d)\n"
+            "  -i movie  : input movie (default : a random key held every %d frames)\n"
+            "  -r seed   : seed of the CXNN random generator and of the input (default : 0)\n"
+            "  -c speed  : CPU cycles per frame (default : %d)\n"
+            "  -t count  : addresses and subroutines shown (default : %d)\n"
+            "  -o file   : folded call stacks, for flamegraph.pl (default : %s)\n",
+        program, DEFAULT_PROFILE_FRAMES, MOVIE_SCRIPT_HOLD_FRAMES, DEFAULT_CPU_SPEED,
+        DEFAULT_PROFILE_TOP, DEFAULT_PROFILE_FILENAME);
+}
+
+int main (int argc, char **argv)
+{
+    int frames = DEFAULT_PROFILE_FRAMES;
+    int speed = DEFAULT_CPU_SPEED;
+    int top = DEFAULT_PROFILE_TOP;
+    char *filename = DEFAULT_PROFILE_FILENAME;
+    uint32_t seed = 0;
+    Movie *movie = NULL;
+    int option;
+
+    while ((option = getopt (argc, argv, "m:i:r:c:t:o:")) != -1) {
+        switch (option) {
+            case 'm': frames = atoi (optarg); break;
+            case 'r': seed = strtoul (optarg, NULL, 0); break;
+            case 'c': speed = atoi (optarg); break;
+            case 't': top = atoi (optarg); break;
+            case 'o': filename = optarg; break;
+            case 'i':
+                if ((movie = Movie_load (optarg)) == NULL) {
+                    return -1;
+                }
+            break;
+            default : usage (file_get_filename (argv[0])); return 0;
+        }
+    }
+
+    if (optind >= argc || speed <= 0) {
+        usage (file_get_filename (argv[0]));
+        return 0;
+    }
+
+    Cpu *cpu;
+    GuestProfiler *profiler;
+    if ((cpu = Batch_newMachine (argv[optind])) == NULL
+    ||  (profiler = GuestProfiler_new ()) == NULL) {
+        printf ("Error : Cannot instantiate the machine.\n");
+        return -1;
+    }
+
+    if (movie) {
+        seed = movie->seed;
+        frames = movie->framesCount;
+    }
+
+    cpu->speed = speed;
+    cpu->guestProfiler = profiler;
+    Cpu_seed (cpu, seed);
+
+    int frame;
+    for (frame = 0; frame < frames && cpu->isRunning; frame++) {
+        Cpu_setKeys (cpu, (movie) ? Movie_getKeys (movie, frame) : Movie_getScriptedKeys (seed, frame));
+        Cpu_emulateFrame (cpu);
+    }
+
+    printf ("%s : %d frames at %d instructions per frame%s\n",
+        file_get_filename (argv[optind]), frame, speed, (cpu->fault) ? ", stopped by a fault" : "");
+    GuestProfiler_report (profiler, cpu->memory, top);
+
+    FILE *output;
+    if ((output = fopen (filename, "w")) == NULL) {
+        printf ("Error : Cannot write \"%s\".\n", filename);
+        return -1;
+    }
+    GuestProfiler_writeFolded (profiler, output);
+    fclose (output);
+    printf ("\nFolded call stacks written in \"%s\".\n", filename);
+
+    cpu->guestProfiler = NULL;
+    GuestProfiler_free (profiler);
+    Movie_free (movie);
+    Cpu_free (cpu);
+
+    return 0;
+}
@@ -0,0 +1,224 @@
+// --- Author : Moreau Cyril - Spl3en
+// Generates CHIP-8 ROMs running forever in a single hot path of the emulator, to bench them one by one.
+#include "Chip8/CPU.h"
+#include <unistd.h>
+
+// ---------- Defines -------------
+#define STRESS_BUFFER_ADDRESS 0x800
+#define STRESS_JUMP_TARGETS 8
+
+typedef struct {
+    uint8_t code [USER_PROGRAM_SPACE_SIZE];
+    int size;
+} Rom;
+
+static void
+usage (char *program) {
+    printf ("Usage : %s [-o directory]\n"
+            "  -o : existing directory where the ROMs are written (default : \"stress\")\n"
+            "Writes the ROMs STRESS_ALU, STRESS_CALL, STRESS_DRAW, STRESS_MEMORY and STRESS_JUMP.\n",
+        program);
+}
+
+/*
+ * Address of the next opcode emitted
+ */
+static uint16_t
+here (Rom *rom) {
+    return USER_SPACE_START_ADDRESS + rom->size;
+}
+
+static uint16_t
+emit (Rom *rom, uint16_t opcode) {
+    uint16_t address = here (rom);
+    rom->code[rom->size++] = opcode >> 8;
+    rom->code[rom->size++] = opcode;
+    return address;
+}
+
+static void
+emitByte (Rom *rom, uint8_t value) {
+    rom->code[rom->size++] = value;
+}
+
+/*
+ * Replace an opcode emitted before its target was known
+ */
+static void
+patch (Rom *rom, uint16_t address, uint16_t opcode) {
+    rom->code[address - USER_SPACE_START_ADDRESS]     = opcode >> 8;
+    rom->code[address - USER_SPACE_START_ADDRESS + 1] = opcode;
+}
+
+/*
+ * 8XY* arithmetic and 7XNN additions, with VF written by the carries and shifts
+ */
+static void
+generateAlu (Rom *rom) {
+    emit (rom, 0x6001);                  // V0 = 1
+    emit (rom, 0x6103);                  // V1 = 3
+    emit (rom, 0x62F0);                  // V2 = 0xF0
+    uint16_t loop = emit (rom, 0x8014);  // V0 += V1, VF = carry
+    emit (rom, 0x8125);                  // V1 -= V2, VF = not borrow
+    emit (rom, 0x8201);                  // V2 |= V0
+    emit (rom, 0x8312);                  // V3 &= V1
+    emit (rom, 0x8423);                  // V4 ^= V2
+    emit (rom, 0x8506);                  // V5 >>= 1, VF = lsb
+    emit (rom, 0x8617);                  // V6 = V1 - V6, VF = not borrow
+    emit (rom, 0x872E);                  // V7 <<= 1, VF = msb
+    emit (rom, 0x8830);                  // V8 = V3
+    emit (rom, 0x8F44);                  // VF += V4 then VF = carry
+    emit (rom, 0x7905);                  // V9 += 5
+    emit (rom, 0x8A94);                  // VA += V9
+    emit (rom, 0x1000 | loop);
+}
+
+/*
+ * CALL / RET recursion filling the whole stack
+ */
+static void
+generateCall (Rom *rom) {
+    uint16_t start = emit (rom, 0x6000); // V0 = depth = 0
+    uint16_t call  = emit (rom, 0x0000); // CALL sub
+    emit (rom, 0x1000 | start);
+
+    uint16_t sub = emit (rom, 0x7001);   // depth++, the stack holds "depth" return addresses
+    emit (rom, 0x3000 | STACK_SIZE);     // Don't call deeper when the stack is full
+    emit (rom, 0x2000 | sub);
+    emit (rom, 0x00EE);
+
+    patch (rom, call, 0x2000 | sub);
+}
+
+/*
+ * Full screen redraws with 16 rows sprites (DXY0), then with 5 rows font sprites
+ */
+static void
+generateDraw (Rom *rom) {
+    uint16_t start = emit (rom, 0x00E0);
+    uint16_t sprite = emit (rom, 0xA000); // I = sprite
+    emit (rom, 0x6100);                   // V1 = y = 0
+    uint16_t row = emit (rom, 0x6000);    // V0 = x = 0
+    uint16_t column = emit (rom, 0xD010); // 8x16 sprite
+    emit (rom, 0x7008);
+    emit (rom, 0x3000 | RESOLUTION_W);
+    emit (rom, 0x1000 | column);
+    emit (rom, 0x7110);
+    emit (rom, 0x3100 | RESOLUTION_H);
+    emit (rom, 0x1000 | row);
+
+    // Hexadecimal digits all over the screen
+    emit (rom, 0x6100);                   // V1 = y = 0
+    emit (rom, 0x6200);                   // V2 = digit = 0
+    row = emit (rom, 0x6000);             // V0 = x = 0
+    column = emit (rom, 0xF229);          // I = font (V2)
+    emit (rom, 0xD015);
+    emit (rom, 0x7201);
+    emit (rom, 0x7005);
+    emit (rom, 0x303C);                   // 12 digits per row
+    emit (rom, 0x1000 | column);
+    emit (rom, 0x7106);
+    emit (rom, 0x311E);                   // 5 rows
+    emit (rom, 0x1000 | row);
+    emit (rom, 0x1000 | start);
+
+    patch (rom, sprite, 0xA000 | here (rom));
+    for (int line = 0; line < 16; line++) {
+        emitByte (rom, (line & 1) ? 0x55 : 0xAA);
+    }
+}
+
+/*
+ * FX65 / FX55 of 14 registers over the 2KB buffer at the end of the memory, FX33 on each block.
+ * VE and VF hold the stride and the blocks count.
+ */
+static void
+generateMemory (Rom *rom) {
+    uint16_t start = emit (rom, 0xA000 | STRESS_BUFFER_ADDRESS);
+    emit (rom, 0x6E10);                  // VE = 16, stride
+    emit (rom, 0x6F00);                  // VF = blocks count
+    uint16_t loop = emit (rom, 0xFD65);  // V0-VD = mem[I]
+    emit (rom, 0x7001);
+    emit (rom, 0xFD55);                  // mem[I] = V0-VD
+    emit (rom, 0xF033);                  // mem[I] = BCD (V0)
+    emit (rom, 0xFE1E);                  // I += 16
+    emit (rom, 0x7F01);
+    emit (rom, 0x3F00 | ((MEMORY_SIZE - STRESS_BUFFER_ADDRESS) / 16));
+    emit (rom, 0x1000 | loop);
+    emit (rom, 0x1000 | start);
+}
+
+/*
+ * BNNN jumps through a table indexed by V0
+ */
+static void
+generateJump (Rom *rom) {
+    uint16_t targets [STRESS_JUMP_TARGETS];
+    uint16_t next [STRESS_JUMP_TARGETS];
+
+    uint16_t start = emit (rom, 0x6000); // V0 = 0
+    uint16_t loop  = emit (rom, 0x0000); // BNNN table
+    uint16_t table = here (rom);
+    for (int target = 0; target < STRESS_JUMP_TARGETS; target++) {
+        targets[target] = emit (rom, 0x0000);
+    }
+
+    for (int target = 0; target < STRESS_JUMP_TARGETS; target++) {
+        patch (rom, targets[target], 0x1000 | here (rom));
+        emit (rom, 0x7002);                 // Next entry of the table
+        emit (rom, 0x8100 | (target << 4)); // V1 = VN, so the targets differ
+        next[target] = emit (rom, 0x0000);
+    }
+
+    // Back to the first entry after the last one
+    uint16_t end = emit (rom, 0x4000 | (STRESS_JUMP_TARGETS * INSN_SIZE));
+    emit (rom, 0x1000 | start);
+    emit (rom, 0x1000 | loop);
+
+    patch (rom, loop, 0xB000 | table);
+    for (int target = 0; target < STRESS_JUMP_TARGETS; target++) {
+        patch (rom, next[target], 0x1000 | end);
+    }
+}
+
+static bool
+writeRom (char *directory, char *name, void (*generate) (Rom *rom)) {
+    char filename [1024];
+    Rom rom = {.size = 0};
+    FILE *file;
+
+    generate (&rom);
+
+    snprintf (filename, sizeof(filename), "%s/%s", directory, name);
+    if ((file = fopen (filename, "wb")) == NULL) {
+        printf ("Error : Cannot write \"%s\".\n", filename);
+        return false;
+    }
+
+    fwrite (rom.code, 1, rom.size, file);
+    fclose (file);
+    printf ("%s : %d bytes\n", filename, rom.size);
+
+    return true;
+}
+
+int main (int argc, char **argv)
+{
+    char *directory = "stress";
+    int option;
+
+    while ((option = getopt (argc, argv, "o:")) != -1) {
+        switch (option) {
+            case 'o': directory = optarg; break;
+            default : usage (file_get_filename (argv[0])); return 0;
+        }
+    }
+
+    bool result = writeRom (directory, "STRESS_ALU",    generateAlu)
+               && writeRom (directory, "STRESS_CALL",   generateCall)
+               && writeRom (directory, "STRESS_DRAW",   generateDraw)
+               && writeRom (directory, "STRESS_MEMORY", generateMemory)
+               && writeRom (directory, "STRESS_JUMP",   generateJump);
+
+    return (result) ? 0 : -1;
+}
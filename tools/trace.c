@@ -0,0 +1,63 @@
+// --- Author : Moreau Cyril - Spl3en
+// Trace decoder : disassembles the last instructions recorded by a CpuTrace, e.g. the "fault.c8t" left by a crash.
+#include "Chip8/CPU.h"
+#include <unistd.h>
+
+// ---------- Defines -------------
+#define DEFAULT_TRACE_RECORDS 64
+
+static void
+usage (char *program) {
+    printf ("Usage : %s [options] [trace]\n"
+            "  -n count : last instructions shown, 0 for all of them (default : %d)\n"
+            "The trace is \"%s\" when none is given.\n",
+        program, DEFAULT_TRACE_RECORDS, CPU_TRACE_FILENAME);
+}
+
+int main (int argc, char **argv)
+{
+    int count = DEFAULT_TRACE_RECORDS;
+    char *filename = CPU_TRACE_FILENAME;
+    int option;
+
+    while ((option = getopt (argc, argv, "n:")) != -1) {
+        switch (option) {
+            case 'n': count = atoi (optarg); break;
+            default : usage (file_get_filename (argv[0])); return 0;
+        }
+    }
+
+    if (optind < argc) {
+        filename = argv[optind];
+    }
+
+    CpuTrace *trace;
+    if ((trace = CpuTrace_load (filename)) == NULL) {
+        return -1;
+    }
+
+    int recordsCount = CpuTrace_getRecordsCount (trace);
+    if (count <= 0 || count > recordsCount) {
+        count = recordsCount;
+    }
+
+    // Cpu_disass reads the instruction from a CPU : only the registers recorded are set
+    static Cpu cpu;
+
+    for (int index = recordsCount - count; index < recordsCount; index++) {
+        CpuTraceRecord *record = CpuTrace_getRecord (trace, index);
+        cpu.ip = record->ip;
+        cpu.opcode = record->opcode;
+        cpu.V[(record->opcode & 0x0F00) >> 8] = record->vx;
+        cpu.V[(record->opcode & 0x00F0) >> 4] = record->vy;
+
+        printf ("%6d  I = %03X  ", index - recordsCount + 1, record->I);
+        Cpu_disass (&cpu);
+    }
+
+    printf ("%s\n", Cpu_getFaultName (trace->fault));
+
+    CpuTrace_free (trace);
+
+    return 0;
+}